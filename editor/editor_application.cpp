@@ -9,6 +9,7 @@
 #include "rootex/framework/systems/script_system.h"
 #include "rootex/framework/systems/physics_system.h"
 #include "rootex/framework/systems/audio_system.h"
+#include "rootex/framework/systems/audio_stream_system.h"
 #include "rootex/framework/systems/input_system.h"
 
 EditorApplication* EditorApplication::s_Instance = nullptr;
@@ -43,6 +44,7 @@ EditorApplication::EditorApplication()
 	RenderSystem::GetSingleton()->setIsEditorRenderPass(true);
 	PhysicsSystem::GetSingleton()->setActive(false);
 	AudioSystem::GetSingleton()->setActive(false);
+	AudioStreamSystem::GetSingleton()->setActive(false);
 	ScriptSystem::GetSingleton()->setActive(false);
 
 	InputSystem::GetSingleton()->loadSchemes(m_ApplicationSettings->getJSON()["systems"]["InputSystem"]["inputSchemes"]);
@@ -369,12 +369,26 @@ void EditorSystem::drawDefaultUI(float deltaMilliseconds)
 				}
 				if (ImGui::BeginMenu("Resources"))
 				{
-					for (auto& [data, file] : ResourceLoader::GetResources())
+					for (ResourceFile* file : ResourceLoader::GetResources())
 					{
 						ImGui::MenuItem(file->getPath().generic_string().c_str());
 					}
 					ImGui::EndMenu();
 				}
+				if (ImGui::BeginMenu("Resident Memory"))
+				{
+					for (auto& [typeName, type] : ResourceTypeNames)
+					{
+						size_t budget = ResourceLoader::GetBudget(type);
+						String usage = std::to_string(ResourceLoader::GetResidentBytes(type) / 1024) + " KB";
+						if (budget)
+						{
+							usage += " / " + std::to_string(budget / 1024) + " KB";
+						}
+						ImGui::MenuItem((typeName + ": " + usage).c_str());
+					}
+					ImGui::EndMenu();
+				}
 				ImGui::EndMenu();
 			}
 			if (ImGui::BeginMenu("View"))
@@ -593,7 +607,7 @@ void EditorSystem::drawDefaultUI(float deltaMilliseconds)
 			{
 				ImGui::Text(String("Rootex Engine and Rootex Editor developed by SDSLabs. Built on " + OS::GetBuildDate() + " at " + OS::GetBuildTime() + "\n" + "Source available at https://www.github.com/sdslabs/rootex").c_str());
 
-				static TextResourceFile* license = ResourceLoader::CreateLuaTextResourceFile("LICENSE");
+				static ResourceHandle<LuaTextResourceFile> license = ResourceLoader::CreateLuaTextResourceFile("LICENSE");
 				ImGui::Text(license->getData()->getRawData()->data());
 				ImGui::Separator();
 				m_MenuAction = "";
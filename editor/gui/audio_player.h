@@ -9,7 +9,7 @@
 class AudioPlayer
 {
 	float m_FractionProgress;
-	AudioResourceFile* m_OpenFile = nullptr;
+	ResourceHandle<AudioResourceFile> m_OpenFile;
 	Ref<StaticAudioBuffer> m_Buffer;
 	Ref<StaticAudioSource> m_Source;
 	bool m_Looping = false;
@@ -8,7 +8,7 @@
 class ImageViewer
 {
 	Ref<Texture> m_Texture;
-	ImageResourceFile* m_ImageResourceFile;
+	ResourceHandle<ImageResourceFile> m_ImageResourceFile;
 	const float m_ZoomSliderWidth = 40.0f;
 	const float m_ZoomSliderHeight = 500.0f;
 	const float m_MaxZoom = 3.0f;
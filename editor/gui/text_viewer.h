@@ -6,7 +6,7 @@
 
 class TextViewer
 {
-	TextResourceFile* m_TextResourceFile;
+	ResourceHandle<TextResourceFile> m_TextResourceFile;
 
 	void drawFileInfo();
 
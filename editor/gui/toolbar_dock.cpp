@@ -60,6 +60,9 @@ void ToolbarDock::draw(float deltaMilliseconds)
 				averageFPS /= m_FPSRecords.size();
 
 				ImGui::PlotLines("FPS", m_FPSRecords.data(), m_FPSRecords.size(), 0, std::to_string(averageFPS).c_str(), 0, 200.0f, ImVec2(ImGui::GetContentRegionAvailWidth(), 100));
+
+				const SystemScheduler& scheduler = EditorApplication::GetSingleton()->getSystemScheduler();
+				ImGui::Text("Parallel Systems: %d at most, %d overlapped", scheduler.getPeakParallelSystems(), scheduler.getOverlappedSystems());
 			}
 
 			if (ImGui::TreeNodeEx("Events", ImGuiTreeNodeFlags_CollapsingHeader))
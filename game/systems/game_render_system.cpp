@@ -5,6 +5,7 @@
 GameRenderSystem::GameRenderSystem()
     : System("GameRenderSystem", System::UpdateOrder::PostRender, true)
 {
+	setLevelIndependent(true);
 }
 
 GameRenderSystem* GameRenderSystem::GetSingleton()
@@ -0,0 +1,67 @@
+#include "common/common.h"
+
+#include "core/pak_archive.h"
+#include "core/resource_loader.h"
+
+/// Packs files and directories, relative to Rootex root, into an archive that ResourceLoader can mount.
+/// Usage: Packer [--no-compression] <archive> <file or directory>...
+int main(int argc, char* argv[])
+{
+	if (!OS::Initialize())
+	{
+		return 1;
+	}
+
+	bool isCompressed = true;
+	Vector<String> arguments;
+	for (int i = 1; i < argc; i++)
+	{
+		if (String(argv[i]) == "--no-compression")
+		{
+			isCompressed = false;
+		}
+		else
+		{
+			arguments.push_back(argv[i]);
+		}
+	}
+
+	if (arguments.size() < 2)
+	{
+		OS::Print("Usage: Packer [--no-compression] <archive> <file or directory>...");
+		return 1;
+	}
+
+	PakWriter writer;
+	for (int i = 1; i < arguments.size(); i++)
+	{
+		Vector<FilePath> files;
+		if (std::filesystem::is_directory(OS::GetAbsolutePath(arguments[i])))
+		{
+			files = OS::GetAllFilesInDirectory(arguments[i]);
+		}
+		else if (OS::IsExists(arguments[i]))
+		{
+			files.push_back(OS::GetRootRelativePath(OS::GetAbsolutePath(arguments[i]).generic_string()));
+		}
+		else
+		{
+			ERR("Not found: " + arguments[i]);
+			return 1;
+		}
+
+		for (auto& file : files)
+		{
+			writer.add(ResourceLoader::NormalizePath(file.generic_string()), file.generic_string(), isCompressed);
+		}
+	}
+
+	if (!writer.save(arguments[0]))
+	{
+		ERR("Could not write archive: " + arguments[0]);
+		return 1;
+	}
+
+	PRINT("Packed " + std::to_string(writer.getFileCount()) + " files into " + arguments[0]);
+	return 0;
+}
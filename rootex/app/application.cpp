@@ -2,7 +2,9 @@
 
 #include "level_manager.h"
 #include "framework/systems/audio_system.h"
+#include "framework/systems/audio_stream_system.h"
 #include "core/resource_loader.h"
+#include "core/pak_archive.h"
 #include "core/input/input_manager.h"
 #include "core/renderer/shader_library.h"
 #include "core/renderer/material_library.h"
@@ -24,6 +26,7 @@ Application* Application::GetSingleton()
 }
 
 Application::Application(const String& settingsFile)
+    : m_SystemScheduler(m_ThreadPool)
 {
 	if (!s_Singleton)
 	{
@@ -33,14 +36,38 @@ Application::Application(const String& settingsFile)
 	{
 		ERR("More than one Rootex applications are active");
 	}
+	m_ThreadPool.setErrorHandler([](const String& error) { ERR(error); });
 
 	if (!OS::Initialize())
 	{
 		ERR("Application OS was not initialized");
 	}
 
+#ifndef ROOTEX_EDITOR
+	// Packed assets are looked up before loose files, the editor always works on loose files
+	if (OS::IsExists(PAK_GAME_ARCHIVE))
+	{
+		ResourceLoader::MountArchive(PAK_GAME_ARCHIVE);
+	}
+#endif // ROOTEX_EDITOR
+
 	m_ApplicationSettings.reset(new ApplicationSettings(ResourceLoader::CreateTextResourceFile(settingsFile)));
 
+	auto&& resourceBudgets = m_ApplicationSettings->find("resourceBudgets");
+	if (resourceBudgets != m_ApplicationSettings->end())
+	{
+		for (auto& [typeName, megabytes] : resourceBudgets->items())
+		{
+			auto findIt = ResourceTypeNames.find(typeName);
+			if (findIt == ResourceTypeNames.end())
+			{
+				WARN("Unknown resource type in budgets: " + typeName);
+				continue;
+			}
+			ResourceLoader::SetBudget(findIt->second, (size_t)((float)megabytes * MB_TO_B));
+		}
+	}
+
 	JSON::json& systemsSettings = m_ApplicationSettings->getJSON()["systems"];
 	if (!AudioSystem::GetSingleton()->initialize(systemsSettings["AudioSystem"]))
 	{
@@ -78,6 +105,7 @@ Application::Application(const String& settingsFile)
 	RenderSystem::GetSingleton();
 	ScriptSystem::GetSingleton();
 	TransformAnimationSystem::GetSingleton();
+	AudioStreamSystem::GetSingleton();
 
 	auto&& postInitialize = m_ApplicationSettings->find("postInitialize");
 	if (postInitialize != m_ApplicationSettings->end())
@@ -101,16 +129,15 @@ void Application::run()
 	{
 		m_FrameTimer.reset();
 
-		for (auto& [order, systems] : System::GetSystems())
+		LevelManager::GetSingleton()->update();
+		// Entities of a level being entered have not been set up and systems have not begun, so nothing may update or draw them.
+		// Input and UI keep running over a cleared frame meanwhile, so a loading screen stays responsive
+		bool isEnteringLevel = LevelManager::GetSingleton()->isEnteringLevel();
+		if (isEnteringLevel)
 		{
-			for (auto& system : systems)
-			{
-				if (system->isActive())
-				{
-					system->update(m_FrameTimer.getLastFrameTime());
-				}
-			}
+			RenderSystem::GetSingleton()->clearFrame();
 		}
+		m_SystemScheduler.update(m_FrameTimer.getLastFrameTime(), isEnteringLevel);
 
 		process(m_FrameTimer.getLastFrameTime());
 
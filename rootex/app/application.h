@@ -4,6 +4,7 @@
 #include "core/event_manager.h"
 #include "os/timer.h"
 #include "os/thread.h"
+#include "framework/system_scheduler.h"
 #include "entity_factory.h"
 #include "application_settings.h"
 
@@ -17,6 +18,7 @@ protected:
 	Timer m_ApplicationTimer;
 	FrameTimer m_FrameTimer;
 	ThreadPool m_ThreadPool;
+	SystemScheduler m_SystemScheduler;
 
 	Ptr<Window> m_Window;
 	Ptr<ApplicationSettings> m_ApplicationSettings;
@@ -35,6 +37,7 @@ public:
 	virtual String getAppTitle() const { return "Rootex Application"; }
 	const Timer& getAppTimer() const { return m_ApplicationTimer; };
 	ThreadPool& getThreadPool() { return m_ThreadPool; };
+	SystemScheduler& getSystemScheduler() { return m_SystemScheduler; }
 	const FrameTimer& getAppFrameTimer() const { return m_FrameTimer; }
 	Window* getWindow() { return m_Window.get(); };
 	ApplicationSettings* getSettings() { return m_ApplicationSettings.get(); }
@@ -7,7 +7,7 @@
 class ApplicationSettings
 {
 	static ApplicationSettings* s_Instance;
-	TextResourceFile* m_TextSettingsFile;
+	ResourceHandle<TextResourceFile> m_TextSettingsFile;
 	JSON::json m_Settings;
 
 public:
@@ -1,11 +1,93 @@
 #include "level_manager.h"
 
+#include "app/application.h"
 #include "core/input/input_manager.h"
 #include "framework/entity_factory.h"
 #include "framework/systems/hierarchy_system.h"
 #include "framework/systems/render_system.h"
 #include "systems/audio_system.h"
 #include "systems/serialization_system.h"
+#include "os/thread.h"
+#include "os/timer.h"
+
+/// State of a level being streamed in by LevelManager::openLevelAsync(). Shared with the worker tasks reading its files.
+struct LevelLoad
+{
+	struct EntityFile
+	{
+		String m_Path;
+		/// Null if the file could not be parsed.
+		JSON::json m_JSON;
+	};
+
+	String m_LevelPath;
+	Vector<String> m_Arguments;
+	LevelLoadCallback m_OnProgress;
+	bool m_OpenInEditor = false;
+	float m_FrameBudget = LEVEL_LOAD_FRAME_BUDGET_MS;
+	LevelLoadPhase m_Phase = LevelLoadPhase::Streaming;
+	Atomic<bool> m_IsCancelled { false };
+
+	Atomic<int> m_Preloaded { 0 };
+	int m_PreloadTotal = 0;
+	Vector<EntityFile> m_EntityFiles;
+	Atomic<int> m_Parsed { 0 };
+	TaskHandle m_ParseHandle;
+
+	/// Index of the next entity file to create in the Creating phase, or of the next entity to set up in the Setup phase.
+	int m_Next = 0;
+	Vector<Ref<Entity>> m_SetupEntities;
+
+	bool isStreamed() const { return m_Preloaded.load() == m_PreloadTotal && m_ParseHandle.isReady(); }
+
+	float getProgress() const
+	{
+		// Every preload counts as one step, every entity as one step each for reading, creation and setup
+		float total = m_PreloadTotal + 3.0f * m_EntityFiles.size();
+		if (total == 0.0f)
+		{
+			return m_Phase == LevelLoadPhase::Done ? 1.0f : 0.0f;
+		}
+
+		float done = m_Preloaded.load() + m_Parsed.load();
+		if (m_Phase == LevelLoadPhase::Creating)
+		{
+			done += m_Next;
+		}
+		else if (m_Phase == LevelLoadPhase::Setup)
+		{
+			done += m_EntityFiles.size();
+			if (!m_SetupEntities.empty())
+			{
+				done += (float)m_EntityFiles.size() * m_Next / m_SetupEntities.size();
+			}
+		}
+		else if (m_Phase == LevelLoadPhase::Done)
+		{
+			return 1.0f;
+		}
+		return done / total;
+	}
+};
+
+static String GetLevelLoadPhaseName(LevelLoadPhase phase)
+{
+	switch (phase)
+	{
+	case LevelLoadPhase::Streaming:
+		return "Streaming";
+	case LevelLoadPhase::Creating:
+		return "Creating";
+	case LevelLoadPhase::Setup:
+		return "Setup";
+	case LevelLoadPhase::Done:
+		return "Done";
+	case LevelLoadPhase::Cancelled:
+		return "Cancelled";
+	default:
+		return "None";
+	}
+}
 
 LevelDescription::LevelDescription()
     : m_LevelName("")
@@ -40,6 +122,24 @@ void LevelManager::RegisterAPI(sol::table& rootex)
 	levelManager["openLevel"] = [](LevelManager* l, const String& p, const sol::table& arguments) { return l->openLevel(p, arguments.as<Vector<String>>()); };
 	levelManager["preloadLevel"] = [](LevelManager* l, const String& p, Atomic<int>& a) { return l->preloadLevel(p, a); };
 	levelManager["openPreloadedLevel"] = [](LevelManager* l, const String& p, const sol::nested<Vector<String>>& arguments) { return l->openPreloadedLevel(p, arguments.value(), false); };
+	levelManager["openLevelAsync"] = [](LevelManager* l, const String& p, const sol::nested<Vector<String>>& arguments, sol::protected_function onProgress) {
+		LevelLoadCallback callback;
+		if (onProgress.valid())
+		{
+			callback = [onProgress](const String& phase, float progress) {
+				sol::protected_function_result result = onProgress(phase, progress);
+				if (!result.valid())
+				{
+					sol::error e = result;
+					ERR("Level load progress callback failed: " + String(e.what()));
+				}
+			};
+		}
+		l->openLevelAsync(p, arguments.value(), callback);
+	};
+	levelManager["cancelLevelLoad"] = &LevelManager::cancelLevelLoad;
+	levelManager["isLoadingLevel"] = &LevelManager::isLoadingLevel;
+	levelManager["getLevelLoadProgress"] = &LevelManager::getLevelLoadProgress;
 	levelManager["getCurrentLevelArguments"] = [](LevelManager* l) { return l->getCurrentLevel().getArguments(); };
 }
 
@@ -68,6 +168,8 @@ int LevelManager::preloadLevel(const String& levelPath, Atomic<int>& progress, b
 
 void LevelManager::openLevel(const String& levelPath, const Vector<String>& arguments, bool openInEditor)
 {
+	cancelLevelLoad();
+
 	if (isAnyLevelOpen())
 	{
 		endLevel();
@@ -76,9 +178,14 @@ void LevelManager::openLevel(const String& levelPath, const Vector<String>& argu
 	Atomic<int> progress;
 	int totalPreloads = preloadLevel(levelPath, progress, openInEditor);
 
+	ThreadPool& threadPool = Application::GetSingleton()->getThreadPool();
 	while (progress.load() != totalPreloads)
 	{
-		;
+		// Preloads run in the background on workers, so this thread may find nothing to help with
+		if (ResourceLoader::RunPendingUploads() == 0 && !threadPool.help())
+		{
+			std::this_thread::yield();
+		}
 	}
 
 	PRINT("Preloaded " + std::to_string(totalPreloads) + " new resources");
@@ -88,56 +195,215 @@ void LevelManager::openLevel(const String& levelPath, const Vector<String>& argu
 
 void LevelManager::openPreloadedLevel(const String& levelPath, const Vector<String>& arguments, bool openInEditor)
 {
-	endLevel();
+	cancelLevelLoad();
+	enterLevel(levelPath, arguments);
 
-	m_CurrentLevel = LevelDescription(levelPath, arguments);
+	for (auto&& entityFile : ResourceLoader::GetFilesInDirectory(levelPath + "/entities/"))
+	{
+		TextResourceFile* textResource = ResourceLoader::CreateTextResourceFile(entityFile.string());
+		if (textResource->isDirty())
+		{
+			ResourceLoader::Reload(textResource);
+		}
 
-	ResourceLoader::Unload(m_ToUnload);
+		EntityFactory::GetSingleton()->createEntity(textResource);
+	}
 
-	if (!OS::IsExists(levelPath))
+	configureSystems(openInEditor);
+	EntityFactory::GetSingleton()->setupLiveEntities();
+	beginSystems(levelPath);
+}
+
+void LevelManager::openLevelAsync(const String& levelPath, const Vector<String>& arguments, const LevelLoadCallback& onProgress, bool openInEditor, float frameBudgetMilliseconds)
+{
+	cancelLevelLoad();
+
+	Ref<LevelLoad> load(new LevelLoad());
+	load->m_LevelPath = levelPath;
+	load->m_Arguments = arguments;
+	load->m_OnProgress = onProgress;
+	load->m_OpenInEditor = openInEditor;
+	load->m_FrameBudget = frameBudgetMilliseconds;
+	load->m_PreloadTotal = preloadLevel(levelPath, load->m_Preloaded, openInEditor);
+
+	for (auto&& entityFile : ResourceLoader::GetFilesInDirectory(levelPath + "/entities/"))
 	{
-		OS::CreateDirectoryName(levelPath);
+		load->m_EntityFiles.push_back({ entityFile.string(), nullptr });
 	}
-	if (!OS::IsExists(levelPath + "/entities/"))
+
+	// Each task owns one slot of m_EntityFiles, so they can read and parse without synchronising
+	Vector<Ref<Task>> parseTasks;
+	for (int i = 0; i < load->m_EntityFiles.size(); i++)
 	{
-		OS::CreateDirectoryName(levelPath + "/entities/");
+		parseTasks.emplace_back(new Task([load, i]() {
+			LevelLoad::EntityFile& entityFile = load->m_EntityFiles[i];
+			if (!load->m_IsCancelled)
+			{
+				ResourceHandle<TextResourceFile> textResource = ResourceLoader::CreateTextResourceFile(entityFile.m_Path);
+				if (textResource && textResource->isDirty())
+				{
+					ResourceLoader::Reload(textResource);
+				}
+				if (textResource)
+				{
+					entityFile.m_JSON = JSON::json::parse(textResource->getString(), nullptr, false);
+				}
+				if (entityFile.m_JSON.is_discarded())
+				{
+					ERR("Could not parse entity file: " + entityFile.m_Path);
+					entityFile.m_JSON = nullptr;
+				}
+			}
+			load->m_Parsed++;
+		}));
+		parseTasks.back()->m_IsBackground = true;
+	}
+	if (!parseTasks.empty())
+	{
+		load->m_ParseHandle = Application::GetSingleton()->getThreadPool().submit(parseTasks);
 	}
 
-	for (auto&& entityFile : OS::GetFilesInDirectory(levelPath + "/entities/"))
+	m_LevelLoad = load;
+	PRINT("Streaming level: " + levelPath);
+}
+
+void LevelManager::cancelLevelLoad()
+{
+	if (!m_LevelLoad)
 	{
-		TextResourceFile* textResource = ResourceLoader::CreateTextResourceFile(entityFile.string());
-		if (textResource->isDirty())
-		{
-			ResourceLoader::Reload(textResource);
-		}
+		return;
+	}
 
-		EntityFactory::GetSingleton()->createEntity(textResource);
+	Ref<LevelLoad> load = m_LevelLoad;
+	load->m_IsCancelled = true;
+	if (load->m_Phase == LevelLoadPhase::Streaming)
+	{
+		// Preload tasks count into the load, so it is kept alive until they are all done
+		m_CancelledLoads.push_back(load);
+	}
+	else
+	{
+		// The previous level has already ended, tear down what was created of the new one
+		EntityFactory::GetSingleton()->destroyEntities();
+		HierarchySystem::GetSingleton()->getRootHierarchyComponent()->clear();
+		m_CurrentLevel = LevelDescription();
 	}
 
-	for (auto& [order, systems] : System::GetSystems())
+	PRINT("Cancelled loading level: " + load->m_LevelPath);
+	finishLevelLoad(*load, LevelLoadPhase::Cancelled);
+}
+
+void LevelManager::update()
+{
+	m_CancelledLoads.erase(
+	    std::remove_if(m_CancelledLoads.begin(), m_CancelledLoads.end(), [](const Ref<LevelLoad>& load) { return load->isStreamed(); }),
+	    m_CancelledLoads.end());
+
+	// Last frame's pointers to files are gone by now, only handles keep files resident.
+	// Loads in flight still pass files around between their tasks, so wait for them to finish.
+	if (!m_LevelLoad && m_CancelledLoads.empty())
 	{
-		for (auto& system : systems)
-		{
-			system->setConfig(m_CurrentLevel.getLevelSettings(), openInEditor);
-		}
+		ResourceLoader::EvictToBudgets();
 	}
 
-	EntityFactory::GetSingleton()->setupLiveEntities();
+	if (!m_LevelLoad)
+	{
+		ResourceLoader::RunPendingUploads();
+		return;
+	}
 
-	PRINT("Loaded level: " + levelPath);
+	// Keep the load alive in case its callback opens or cancels a level
+	Ref<LevelLoad> load = m_LevelLoad;
+	StopTimer timer;
+	ResourceLoader::RunPendingUploads(load->m_FrameBudget);
+	advanceLevelLoad(*load, load->m_FrameBudget - timer.getTimeMs());
+}
 
-	for (auto& [order, systems] : System::GetSystems())
+void LevelManager::advanceLevelLoad(LevelLoad& load, float budgetMilliseconds)
+{
+	StopTimer timer;
+
+	if (load.m_Phase == LevelLoadPhase::Streaming && load.isStreamed())
 	{
-		for (auto& system : systems)
+		PRINT("Preloaded " + std::to_string(load.m_PreloadTotal) + " new resources");
+		enterLevel(load.m_LevelPath, load.m_Arguments);
+		load.m_Phase = LevelLoadPhase::Creating;
+		load.m_Next = 0;
+	}
+
+	while (load.m_Phase == LevelLoadPhase::Creating && timer.getTimeMs() < budgetMilliseconds)
+	{
+		if (load.m_Next == load.m_EntityFiles.size())
 		{
-			if (system->isActive())
+			configureSystems(load.m_OpenInEditor);
+			for (auto& [id, entity] : EntityFactory::GetSingleton()->getEntities())
 			{
-				system->begin();
+				load.m_SetupEntities.push_back(entity);
 			}
+			load.m_Phase = LevelLoadPhase::Setup;
+			load.m_Next = 0;
+			break;
+		}
+
+		LevelLoad::EntityFile& entityFile = load.m_EntityFiles[load.m_Next++];
+		if (!entityFile.m_JSON.is_null())
+		{
+			EntityFactory::GetSingleton()->createEntity(entityFile.m_JSON, entityFile.m_Path);
 		}
+		// Release the parsed document as soon as its entity exists
+		entityFile.m_JSON = nullptr;
 	}
 
-	EventManager::GetSingleton()->deferredCall("OpenedLevel", "OpenedLevel", 0);
+	while (load.m_Phase == LevelLoadPhase::Setup && timer.getTimeMs() < budgetMilliseconds)
+	{
+		if (load.m_Next == load.m_SetupEntities.size())
+		{
+			load.m_SetupEntities.clear();
+			beginSystems(load.m_LevelPath);
+			finishLevelLoad(load, LevelLoadPhase::Done);
+			return;
+		}
+
+		Ref<Entity>& entity = load.m_SetupEntities[load.m_Next++];
+		if (!entity->setupEntities())
+		{
+			ERR("Could not setup: " + entity->getFullName());
+		}
+	}
+
+	if (load.m_OnProgress)
+	{
+		load.m_OnProgress(GetLevelLoadPhaseName(load.m_Phase), load.getProgress());
+	}
+}
+
+void LevelManager::finishLevelLoad(LevelLoad& load, LevelLoadPhase phase)
+{
+	load.m_Phase = phase;
+	if (m_LevelLoad.get() == &load)
+	{
+		m_LevelLoad.reset();
+	}
+	if (load.m_OnProgress)
+	{
+		load.m_OnProgress(GetLevelLoadPhaseName(phase), phase == LevelLoadPhase::Done ? 1.0f : load.getProgress());
+	}
+}
+
+bool LevelManager::isEnteringLevel() const
+{
+	LevelLoadPhase phase = getLevelLoadPhase();
+	return phase == LevelLoadPhase::Creating || phase == LevelLoadPhase::Setup;
+}
+
+LevelLoadPhase LevelManager::getLevelLoadPhase() const
+{
+	return m_LevelLoad ? m_LevelLoad->m_Phase : LevelLoadPhase::None;
+}
+
+float LevelManager::getLevelLoadProgress() const
+{
+	return m_LevelLoad ? m_LevelLoad->getProgress() : 0.0f;
 }
 
 void LevelManager::saveCurrentLevel()
@@ -166,6 +432,53 @@ void LevelManager::createLevel(const String& newLevelName)
 	PRINT("Created new level: " + newLevelName);
 }
 
+void LevelManager::enterLevel(const String& levelPath, const Vector<String>& arguments)
+{
+	endLevel();
+
+	m_CurrentLevel = LevelDescription(levelPath, arguments);
+
+	ResourceLoader::Unload(m_ToUnload);
+
+	if (!OS::IsExists(levelPath))
+	{
+		OS::CreateDirectoryName(levelPath);
+	}
+	if (!OS::IsExists(levelPath + "/entities/"))
+	{
+		OS::CreateDirectoryName(levelPath + "/entities/");
+	}
+}
+
+void LevelManager::configureSystems(bool openInEditor)
+{
+	for (auto& [order, systems] : System::GetSystems())
+	{
+		for (auto& system : systems)
+		{
+			system->setConfig(m_CurrentLevel.getLevelSettings(), openInEditor);
+		}
+	}
+}
+
+void LevelManager::beginSystems(const String& levelPath)
+{
+	PRINT("Loaded level: " + levelPath);
+
+	for (auto& [order, systems] : System::GetSystems())
+	{
+		for (auto& system : systems)
+		{
+			if (system->isActive())
+			{
+				system->begin();
+			}
+		}
+	}
+
+	EventManager::GetSingleton()->deferredCall("OpenedLevel", "OpenedLevel", 0);
+}
+
 void LevelManager::endLevel()
 {
 	if (isAnyLevelOpen())
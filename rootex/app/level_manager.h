@@ -3,10 +3,13 @@
 #include "common/common.h"
 #include "resource_loader.h"
 
+/// Main thread time spent on streaming a level in each frame, in milliseconds.
+#define LEVEL_LOAD_FRAME_BUDGET_MS 4.0f
+
 class LevelDescription
 {
 	String m_LevelName;
-	TextResourceFile* m_LevelSettingsFile = nullptr;
+	ResourceHandle<TextResourceFile> m_LevelSettingsFile;
 	JSON::json m_LevelSettings;
 	Vector<String> m_Preloads;
 	Vector<String> m_Arguments;
@@ -22,6 +25,25 @@ public:
 	const Vector<String>& getArguments() const { return m_Arguments; }
 };
 
+/// Stage of a level being streamed in by LevelManager::openLevelAsync().
+enum class LevelLoadPhase
+{
+	None,
+	/// Preloads and entity files are read and parsed on worker threads. The previous level keeps running.
+	Streaming,
+	/// Entities are created from the parsed files on the main thread.
+	Creating,
+	/// Systems are configured and entities are set up on the main thread.
+	Setup,
+	Done,
+	Cancelled
+};
+
+/// Called with the name of the current phase and the overall progress of a level load, from 0 to 1.
+typedef Function<void(const String& phase, float progress)> LevelLoadCallback;
+
+struct LevelLoad;
+
 /// Helper for loading, saving and creating new projects.
 class LevelManager
 {
@@ -31,8 +53,18 @@ class LevelManager
 
 	LevelDescription m_CurrentLevel;
 	Vector<String> m_ToUnload;
+	Ref<LevelLoad> m_LevelLoad;
+	/// Cancelled loads whose worker tasks are still running.
+	Vector<Ref<LevelLoad>> m_CancelledLoads;
 
 	void endLevel();
+	/// End the current level and make the level at levelPath current, without creating any entities.
+	void enterLevel(const String& levelPath, const Vector<String>& arguments);
+	void configureSystems(bool openInEditor);
+	void beginSystems(const String& levelPath);
+
+	void advanceLevelLoad(LevelLoad& load, float budgetMilliseconds);
+	void finishLevelLoad(LevelLoad& load, LevelLoadPhase phase);
 
 public:
 	static void RegisterAPI(sol::table& rootex);
@@ -44,6 +76,14 @@ public:
 	
 	/// Open an entire level in one go. This performs preloading on its own.
 	void openLevel(const String& levelPath, const Vector<String>& arguments, bool openInEditor = false);
+	/// Open a level over several frames. Files are read and parsed on worker threads while the current level keeps running,
+	/// then entities are created and set up on the main thread within a time budget per frame.
+	/// onProgress is called every frame until the load is done or cancelled.
+	void openLevelAsync(const String& levelPath, const Vector<String>& arguments, const LevelLoadCallback& onProgress = nullptr, bool openInEditor = false, float frameBudgetMilliseconds = LEVEL_LOAD_FRAME_BUDGET_MS);
+	/// Stop the level being streamed in. Entities it already created are destroyed and no level is left open.
+	void cancelLevelLoad();
+	/// Run pending resource uploads and advance the level being streamed in. Called once per frame by the Application.
+	void update();
 	
 	void saveCurrentLevel();
 	void saveCurrentLevelSettings();
@@ -51,6 +91,12 @@ public:
 	void createLevel(const String& newLevelName);
 
 	bool isAnyLevelOpen() const { return m_CurrentLevel.getLevelName() != ""; }
+	bool isLoadingLevel() const { return m_LevelLoad != nullptr; }
+	/// Returns true while a streaming level creates and sets up its entities. The previous level has ended and the new one has not begun.
+	bool isEnteringLevel() const;
+	LevelLoadPhase getLevelLoadPhase() const;
+	/// Overall progress of the level being streamed in, from 0 to 1.
+	float getLevelLoadProgress() const;
 
 	LevelDescription& getCurrentLevel() { return m_CurrentLevel; }
 };
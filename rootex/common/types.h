@@ -14,6 +14,8 @@
 #define MS_TO_S 1e-3f
 /// Convert seconds to milliseconds
 #define S_TO_MS 1e+3f
+/// Convert megabytes to bytes
+#define MB_TO_B (1024 * 1024)
 
 /// Future data type for reading future variables
 #include <future>
@@ -104,6 +106,8 @@ typedef DirectX::SimpleMath::Quaternion Quaternion;
 typedef DirectX::SimpleMath::Ray Ray;
 /// DirectX::SimpleMath::BoundingBox
 typedef DirectX::BoundingBox BoundingBox;
+/// DirectX::BoundingSphere
+typedef DirectX::BoundingSphere BoundingSphere;
 /// DirectX::SimpleMath::Color
 typedef DirectX::SimpleMath::Color Color;
 
@@ -8,7 +8,7 @@ typedef unsigned int ALuint;
 class AudioBuffer
 {
 protected:
-	AudioResourceFile* m_AudioFile;
+	ResourceHandle<AudioResourceFile> m_AudioFile;
 
 	AudioBuffer(AudioResourceFile* audioFile);
 
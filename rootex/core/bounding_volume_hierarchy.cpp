@@ -0,0 +1,361 @@
+#include "bounding_volume_hierarchy.h"
+
+/// Half of the surface area of a box, the cost of visiting it during a query.
+static float HalfArea(const Vector3& min, const Vector3& max)
+{
+	Vector3 size = max - min;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+static bool Overlaps(const Vector3& minA, const Vector3& maxA, const Vector3& minB, const Vector3& maxB)
+{
+	return minA.x <= maxB.x && minB.x <= maxA.x
+	    && minA.y <= maxB.y && minB.y <= maxA.y
+	    && minA.z <= maxB.z && minB.z <= maxA.z;
+}
+
+/// Slab test of a ray against a box, within maxDistance along the ray.
+static bool RayOverlaps(const Vector3& origin, const Vector3& direction, const Vector3& inverseDirection, float maxDistance, const Vector3& min, const Vector3& max)
+{
+	const float origins[3] = { origin.x, origin.y, origin.z };
+	const float directions[3] = { direction.x, direction.y, direction.z };
+	const float inverseDirections[3] = { inverseDirection.x, inverseDirection.y, inverseDirection.z };
+	const float mins[3] = { min.x, min.y, min.z };
+	const float maxs[3] = { max.x, max.y, max.z };
+
+	float enter = 0.0f;
+	float exit = maxDistance;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		// A ray parallel to the slabs never crosses them, 0 * inf would give NaN for an origin on a slab plane
+		if (directions[axis] == 0.0f)
+		{
+			if (origins[axis] < mins[axis] || maxs[axis] < origins[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float t0 = (mins[axis] - origins[axis]) * inverseDirections[axis];
+		float t1 = (maxs[axis] - origins[axis]) * inverseDirections[axis];
+		enter = std::max(enter, std::min(t0, t1));
+		exit = std::min(exit, std::max(t0, t1));
+	}
+	return enter <= exit;
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+    : m_Root(BVH_NULL_NODE)
+    , m_FreeList(BVH_NULL_NODE)
+    , m_ProxyCount(0)
+{
+}
+
+int BoundingVolumeHierarchy::allocateNode()
+{
+	int node = m_FreeList;
+	if (node == BVH_NULL_NODE)
+	{
+		node = m_Nodes.size();
+		m_Nodes.emplace_back();
+	}
+	else
+	{
+		m_FreeList = m_Nodes[node].m_Parent;
+	}
+
+	Node& newNode = m_Nodes[node];
+	newNode.m_UserData = nullptr;
+	newNode.m_Parent = BVH_NULL_NODE;
+	newNode.m_Left = BVH_NULL_NODE;
+	newNode.m_Right = BVH_NULL_NODE;
+	newNode.m_Height = 0;
+	return node;
+}
+
+void BoundingVolumeHierarchy::freeNode(int node)
+{
+	m_Nodes[node].m_Parent = m_FreeList;
+	m_Nodes[node].m_Height = -1;
+	m_FreeList = node;
+}
+
+void BoundingVolumeHierarchy::refit(int node)
+{
+	Node& parent = m_Nodes[node];
+	const Node& left = m_Nodes[parent.m_Left];
+	const Node& right = m_Nodes[parent.m_Right];
+	parent.m_Min = Vector3::Min(left.m_Min, right.m_Min);
+	parent.m_Max = Vector3::Max(left.m_Max, right.m_Max);
+	parent.m_Height = 1 + std::max(left.m_Height, right.m_Height);
+}
+
+void BoundingVolumeHierarchy::insertLeaf(int leaf)
+{
+	if (m_Root == BVH_NULL_NODE)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].m_Parent = BVH_NULL_NODE;
+		return;
+	}
+
+	// Descend towards the sibling that increases the total area of the tree the least
+	Vector3 leafMin = m_Nodes[leaf].m_Min;
+	Vector3 leafMax = m_Nodes[leaf].m_Max;
+	int index = m_Root;
+	while (!m_Nodes[index].isLeaf())
+	{
+		const Node& node = m_Nodes[index];
+		float area = HalfArea(node.m_Min, node.m_Max);
+		float combinedArea = HalfArea(Vector3::Min(node.m_Min, leafMin), Vector3::Max(node.m_Max, leafMax));
+
+		// Cost of making a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+		// Cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		auto descendCost = [&](int childIndex) {
+			const Node& child = m_Nodes[childIndex];
+			float childCombinedArea = HalfArea(Vector3::Min(child.m_Min, leafMin), Vector3::Max(child.m_Max, leafMax));
+			if (child.isLeaf())
+			{
+				return childCombinedArea + inheritanceCost;
+			}
+			return childCombinedArea - HalfArea(child.m_Min, child.m_Max) + inheritanceCost;
+		};
+		float leftCost = descendCost(node.m_Left);
+		float rightCost = descendCost(node.m_Right);
+
+		if (cost < leftCost && cost < rightCost)
+		{
+			break;
+		}
+		index = leftCost < rightCost ? node.m_Left : node.m_Right;
+	}
+
+	int sibling = index;
+	int oldParent = m_Nodes[sibling].m_Parent;
+	int newParent = allocateNode();
+	m_Nodes[newParent].m_Parent = oldParent;
+	m_Nodes[newParent].m_Left = sibling;
+	m_Nodes[newParent].m_Right = leaf;
+	m_Nodes[sibling].m_Parent = newParent;
+	m_Nodes[leaf].m_Parent = newParent;
+
+	if (oldParent == BVH_NULL_NODE)
+	{
+		m_Root = newParent;
+	}
+	else if (m_Nodes[oldParent].m_Left == sibling)
+	{
+		m_Nodes[oldParent].m_Left = newParent;
+	}
+	else
+	{
+		m_Nodes[oldParent].m_Right = newParent;
+	}
+
+	// Walk back up fixing heights and bounds
+	index = newParent;
+	while (index != BVH_NULL_NODE)
+	{
+		index = balance(index);
+		refit(index);
+		index = m_Nodes[index].m_Parent;
+	}
+}
+
+void BoundingVolumeHierarchy::removeLeaf(int leaf)
+{
+	if (leaf == m_Root)
+	{
+		m_Root = BVH_NULL_NODE;
+		return;
+	}
+
+	int parent = m_Nodes[leaf].m_Parent;
+	int grandParent = m_Nodes[parent].m_Parent;
+	int sibling = m_Nodes[parent].m_Left == leaf ? m_Nodes[parent].m_Right : m_Nodes[parent].m_Left;
+
+	freeNode(parent);
+	m_Nodes[sibling].m_Parent = grandParent;
+	if (grandParent == BVH_NULL_NODE)
+	{
+		m_Root = sibling;
+		return;
+	}
+
+	if (m_Nodes[grandParent].m_Left == parent)
+	{
+		m_Nodes[grandParent].m_Left = sibling;
+	}
+	else
+	{
+		m_Nodes[grandParent].m_Right = sibling;
+	}
+
+	int index = grandParent;
+	while (index != BVH_NULL_NODE)
+	{
+		index = balance(index);
+		refit(index);
+		index = m_Nodes[index].m_Parent;
+	}
+}
+
+int BoundingVolumeHierarchy::balance(int a)
+{
+	Node& nodeA = m_Nodes[a];
+	if (nodeA.isLeaf() || nodeA.m_Height < 2)
+	{
+		return a;
+	}
+
+	int b = nodeA.m_Left;
+	int c = nodeA.m_Right;
+	int difference = m_Nodes[c].m_Height - m_Nodes[b].m_Height;
+	if (difference > 1 || difference < -1)
+	{
+		// Rotate the taller child up into the place of a
+		bool isRightTaller = difference > 1;
+		int up = isRightTaller ? c : b;
+		int stay = isRightTaller ? b : c;
+		Node& nodeUp = m_Nodes[up];
+		int f = nodeUp.m_Left;
+		int g = nodeUp.m_Right;
+
+		nodeUp.m_Left = a;
+		nodeUp.m_Parent = nodeA.m_Parent;
+		nodeA.m_Parent = up;
+		if (nodeUp.m_Parent == BVH_NULL_NODE)
+		{
+			m_Root = up;
+		}
+		else if (m_Nodes[nodeUp.m_Parent].m_Left == a)
+		{
+			m_Nodes[nodeUp.m_Parent].m_Left = up;
+		}
+		else
+		{
+			m_Nodes[nodeUp.m_Parent].m_Right = up;
+		}
+
+		// The taller grandchild stays under the rotated node, the shorter one moves under a
+		int taller = m_Nodes[f].m_Height > m_Nodes[g].m_Height ? f : g;
+		int shorter = taller == f ? g : f;
+		nodeUp.m_Right = taller;
+		nodeA.m_Left = stay;
+		nodeA.m_Right = shorter;
+		m_Nodes[shorter].m_Parent = a;
+
+		refit(a);
+		refit(up);
+		return up;
+	}
+
+	return a;
+}
+
+int BoundingVolumeHierarchy::createProxy(const BoundingBox& bounds, void* userData)
+{
+	int proxy = allocateNode();
+	Node& node = m_Nodes[proxy];
+	Vector3 margin(BVH_FAT_MARGIN, BVH_FAT_MARGIN, BVH_FAT_MARGIN);
+	node.m_Bounds = bounds;
+	node.m_Min = Vector3(bounds.Center) - Vector3(bounds.Extents) - margin;
+	node.m_Max = Vector3(bounds.Center) + Vector3(bounds.Extents) + margin;
+	node.m_UserData = userData;
+	insertLeaf(proxy);
+	m_ProxyCount++;
+	return proxy;
+}
+
+void BoundingVolumeHierarchy::destroyProxy(int proxy)
+{
+	removeLeaf(proxy);
+	freeNode(proxy);
+	m_ProxyCount--;
+}
+
+bool BoundingVolumeHierarchy::moveProxy(int proxy, const BoundingBox& bounds)
+{
+	Node& node = m_Nodes[proxy];
+	node.m_Bounds = bounds;
+
+	Vector3 min = Vector3(bounds.Center) - Vector3(bounds.Extents);
+	Vector3 max = Vector3(bounds.Center) + Vector3(bounds.Extents);
+	bool isContained = node.m_Min.x <= min.x && node.m_Min.y <= min.y && node.m_Min.z <= min.z
+	    && max.x <= node.m_Max.x && max.y <= node.m_Max.y && max.z <= node.m_Max.z;
+	if (isContained)
+	{
+		return false;
+	}
+
+	removeLeaf(proxy);
+	Vector3 margin(BVH_FAT_MARGIN, BVH_FAT_MARGIN, BVH_FAT_MARGIN);
+	m_Nodes[proxy].m_Min = min - margin;
+	m_Nodes[proxy].m_Max = max + margin;
+	insertLeaf(proxy);
+	return true;
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+	m_Nodes.clear();
+	m_Root = BVH_NULL_NODE;
+	m_FreeList = BVH_NULL_NODE;
+	m_ProxyCount = 0;
+}
+
+void BoundingVolumeHierarchy::queryBounds(const BoundingBox& bounds, Vector<int>& results) const
+{
+	Vector3 min = Vector3(bounds.Center) - Vector3(bounds.Extents);
+	Vector3 max = Vector3(bounds.Center) + Vector3(bounds.Extents);
+	traverse(
+	    [&](const Vector3& nodeMin, const Vector3& nodeMax) { return Overlaps(min, max, nodeMin, nodeMax); },
+	    [&](const BoundingBox& leafBounds) { return bounds.Intersects(leafBounds); },
+	    results);
+}
+
+void BoundingVolumeHierarchy::querySphere(const BoundingSphere& sphere, Vector<int>& results) const
+{
+	Vector3 center = sphere.Center;
+	float radiusSquared = sphere.Radius * sphere.Radius;
+	traverse(
+	    [&](const Vector3& nodeMin, const Vector3& nodeMax) {
+		    Vector3 closest = Vector3::Min(Vector3::Max(center, nodeMin), nodeMax);
+		    return Vector3::DistanceSquared(center, closest) <= radiusSquared;
+	    },
+	    [&](const BoundingBox& leafBounds) { return sphere.Intersects(leafBounds); },
+	    results);
+}
+
+void BoundingVolumeHierarchy::queryFrustum(const Frustum& frustum, Vector<int>& results) const
+{
+	traverse(
+	    [&](const Vector3& nodeMin, const Vector3& nodeMax) {
+		    BoundingBox nodeBounds;
+		    BoundingBox::CreateFromPoints(nodeBounds, nodeMin, nodeMax);
+		    return frustum.intersects(nodeBounds);
+	    },
+	    [&](const BoundingBox& leafBounds) { return frustum.intersects(leafBounds); },
+	    results);
+}
+
+void BoundingVolumeHierarchy::queryRay(const Ray& ray, float maxDistance, Vector<int>& results) const
+{
+	Vector3 direction = ray.direction;
+	direction.Normalize();
+	// Zero components are handled separately by RayOverlaps, so their infinite inverses are never used
+	Vector3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	traverse(
+	    [&](const Vector3& nodeMin, const Vector3& nodeMax) {
+		    return RayOverlaps(ray.position, direction, inverseDirection, maxDistance, nodeMin, nodeMax);
+	    },
+	    [&](const BoundingBox& leafBounds) {
+		    float distance = 0.0f;
+		    return leafBounds.Intersects(ray.position, direction, distance) && distance <= maxDistance;
+	    },
+	    results);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "common/common.h"
+#include "renderer/frustum.h"
+
+/// Index used for a missing node in a BoundingVolumeHierarchy.
+#define BVH_NULL_NODE -1
+/// Distance by which leaf bounds are enlarged so that small movements do not need a reinsertion.
+#define BVH_FAT_MARGIN 0.1f
+/// Maximum number of nodes pending on the traversal stack of a query.
+#define BVH_STACK_SIZE 256
+
+/// Dynamic bounding volume tree of axis aligned boxes.
+/// Leaves are stored with enlarged bounds and the tree is kept balanced with rotations, so queries run in logarithmic time
+/// and proxies can be inserted, moved and removed incrementally.
+/// Queries return the proxies whose exact bounds pass the test.
+class BoundingVolumeHierarchy
+{
+	struct Node
+	{
+		/// Enlarged bounds for leaves, union of children for internal nodes.
+		Vector3 m_Min;
+		Vector3 m_Max;
+		/// Exact bounds of a leaf.
+		BoundingBox m_Bounds;
+		void* m_UserData;
+		/// Parent of a node in the tree, next node in the free list otherwise.
+		int m_Parent;
+		int m_Left;
+		int m_Right;
+		/// 0 for leaves, -1 for free nodes.
+		int m_Height;
+
+		bool isLeaf() const { return m_Left == BVH_NULL_NODE; }
+	};
+
+	Vector<Node> m_Nodes;
+	int m_Root;
+	int m_FreeList;
+	int m_ProxyCount;
+
+	int allocateNode();
+	void freeNode(int node);
+
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+	int balance(int node);
+	void refit(int node);
+
+	/// Visit every leaf whose enlarged bounds pass overlaps, and collect it if its exact bounds pass contains.
+	template <class Overlaps, class Contains>
+	void traverse(const Overlaps& overlaps, const Contains& contains, Vector<int>& results) const;
+
+public:
+	BoundingVolumeHierarchy();
+	BoundingVolumeHierarchy(BoundingVolumeHierarchy&) = delete;
+	~BoundingVolumeHierarchy() = default;
+
+	/// Add a box to the tree. Returns the proxy ID that refers to it.
+	int createProxy(const BoundingBox& bounds, void* userData);
+	void destroyProxy(int proxy);
+	/// Update the bounds of a proxy. Returns true if the proxy had to be reinserted into the tree.
+	bool moveProxy(int proxy, const BoundingBox& bounds);
+	void clear();
+
+	/// Append the proxies whose bounds intersect bounds to results.
+	void queryBounds(const BoundingBox& bounds, Vector<int>& results) const;
+	/// Append the proxies whose bounds intersect sphere to results.
+	void querySphere(const BoundingSphere& sphere, Vector<int>& results) const;
+	/// Append the proxies whose bounds intersect frustum to results.
+	void queryFrustum(const Frustum& frustum, Vector<int>& results) const;
+	/// Append the proxies whose bounds are hit by ray within maxDistance to results. Results are not sorted.
+	void queryRay(const Ray& ray, float maxDistance, Vector<int>& results) const;
+
+	void* getUserData(int proxy) const { return m_Nodes[proxy].m_UserData; }
+	const BoundingBox& getBounds(int proxy) const { return m_Nodes[proxy].m_Bounds; }
+	int getProxyCount() const { return m_ProxyCount; }
+	/// Height of the tree. 0 for an empty tree or a single proxy.
+	int getHeight() const { return m_Root == BVH_NULL_NODE ? 0 : m_Nodes[m_Root].m_Height; }
+};
+
+template <class Overlaps, class Contains>
+inline void BoundingVolumeHierarchy::traverse(const Overlaps& overlaps, const Contains& contains, Vector<int>& results) const
+{
+	if (m_Root == BVH_NULL_NODE)
+	{
+		return;
+	}
+
+	int stack[BVH_STACK_SIZE];
+	int top = 0;
+	stack[top++] = m_Root;
+	while (top > 0)
+	{
+		const Node& node = m_Nodes[stack[--top]];
+		if (!overlaps(node.m_Min, node.m_Max))
+		{
+			continue;
+		}
+
+		if (node.isLeaf())
+		{
+			if (contains(node.m_Bounds))
+			{
+				results.push_back(&node - m_Nodes.data());
+			}
+		}
+		else if (top + 2 <= BVH_STACK_SIZE)
+		{
+			stack[top++] = node.m_Left;
+			stack[top++] = node.m_Right;
+		}
+		else
+		{
+			ERR("Bounding volume hierarchy is too deep to be queried completely");
+		}
+	}
+}
@@ -0,0 +1,187 @@
+#include "cooked_model.h"
+
+bool CookedModelSource::Get(const String& path, CookedModelSource& source)
+{
+	std::error_code error;
+	FilePath absolutePath = OS::GetAbsolutePath(path);
+	source.m_Size = std::filesystem::file_size(absolutePath, error);
+	if (error)
+	{
+		return false;
+	}
+	source.m_LastWriteTime = std::filesystem::last_write_time(absolutePath, error).time_since_epoch().count();
+	return !error;
+}
+
+String CookedModel::GetCookedPath(const String& sourcePath)
+{
+	return COOKED_MODEL_DIRECTORY + FilePath(sourcePath).lexically_normal().generic_string() + COOKED_MODEL_EXTENSION;
+}
+
+CookedModel::CookedModel()
+    : m_Header(nullptr)
+    , m_Meshes(nullptr)
+    , m_Materials(nullptr)
+{
+}
+
+bool CookedModel::open(const String& cookedPath, const CookedModelSource& source)
+{
+	if (!m_File.open(cookedPath) || m_File.getSize() < sizeof(CookedModelHeader))
+	{
+		return false;
+	}
+
+	m_Header = (const CookedModelHeader*)m_File.getData();
+	if (m_Header->m_Magic != COOKED_MODEL_MAGIC
+	    || m_Header->m_Version != COOKED_MODEL_VERSION
+	    || m_Header->m_VertexSize != sizeof(VertexData)
+	    || m_Header->m_Source.m_Size != source.m_Size
+	    || m_Header->m_Source.m_LastWriteTime != source.m_LastWriteTime)
+	{
+		m_File.close();
+		return false;
+	}
+
+	size_t fileSize = m_File.getSize();
+	size_t tablesEnd = sizeof(CookedModelHeader) + m_Header->m_MeshCount * sizeof(CookedMesh) + m_Header->m_MaterialCount * sizeof(CookedMaterial);
+	if (tablesEnd > fileSize)
+	{
+		m_File.close();
+		return false;
+	}
+	m_Meshes = (const CookedMesh*)(m_File.getData() + sizeof(CookedModelHeader));
+	m_Materials = (const CookedMaterial*)(m_Meshes + m_Header->m_MeshCount);
+
+	// Reject offsets that point outside the file before anything reads through them
+	for (unsigned int i = 0; i < m_Header->m_MeshCount; i++)
+	{
+		const CookedMesh& mesh = m_Meshes[i];
+		if (mesh.m_Material >= m_Header->m_MaterialCount
+		    || (mesh.m_IndexSize != sizeof(unsigned short) && mesh.m_IndexSize != sizeof(int))
+		    || mesh.m_VertexOffset + (uint64_t)mesh.m_VertexCount * sizeof(VertexData) > fileSize
+		    || mesh.m_IndexOffset + (uint64_t)mesh.m_IndexCount * mesh.m_IndexSize > fileSize)
+		{
+			m_File.close();
+			return false;
+		}
+	}
+	for (unsigned int i = 0; i < m_Header->m_MaterialCount; i++)
+	{
+		if (m_Materials[i].m_PathOffset + m_Materials[i].m_PathLength > fileSize)
+		{
+			m_File.close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+String CookedModel::getMaterialPath(unsigned int material) const
+{
+	return String(m_File.getData() + m_Materials[material].m_PathOffset, m_Materials[material].m_PathLength);
+}
+
+unsigned int CookedModelWriter::findMaterial(const String& materialPath)
+{
+	auto findIt = std::find(m_MaterialPaths.begin(), m_MaterialPaths.end(), materialPath);
+	if (findIt != m_MaterialPaths.end())
+	{
+		return findIt - m_MaterialPaths.begin();
+	}
+	m_MaterialPaths.push_back(materialPath);
+	return m_MaterialPaths.size() - 1;
+}
+
+void CookedModelWriter::addMesh(const String& materialPath, const Vector<VertexData>& vertices, const Vector<unsigned short>& indices, const BoundingBox& bounds)
+{
+	const char* indexData = (const char*)indices.data();
+	m_Meshes.push_back({ findMaterial(materialPath), vertices, Vector<char>(indexData, indexData + indices.size() * sizeof(unsigned short)), sizeof(unsigned short), bounds });
+}
+
+void CookedModelWriter::addMesh(const String& materialPath, const Vector<VertexData>& vertices, const Vector<int>& indices, const BoundingBox& bounds)
+{
+	const char* indexData = (const char*)indices.data();
+	m_Meshes.push_back({ findMaterial(materialPath), vertices, Vector<char>(indexData, indexData + indices.size() * sizeof(int)), sizeof(int), bounds });
+}
+
+bool CookedModelWriter::save(const String& cookedPath, const CookedModelSource& source) const
+{
+	CookedModelHeader header = {};
+	header.m_Magic = COOKED_MODEL_MAGIC;
+	header.m_Version = COOKED_MODEL_VERSION;
+	header.m_VertexSize = sizeof(VertexData);
+	header.m_MeshCount = m_Meshes.size();
+	header.m_MaterialCount = m_MaterialPaths.size();
+	header.m_Source = source;
+
+	// Lay out the tables first, then the strings, then the aligned arrays
+	uint64_t offset = sizeof(CookedModelHeader) + m_Meshes.size() * sizeof(CookedMesh) + m_MaterialPaths.size() * sizeof(CookedMaterial);
+	Vector<CookedMaterial> materials;
+	for (auto& path : m_MaterialPaths)
+	{
+		materials.push_back({ offset, (uint32_t)path.size(), 0 });
+		offset += path.size();
+	}
+
+	auto align = [](uint64_t value) { return (value + COOKED_MODEL_ALIGNMENT - 1) / COOKED_MODEL_ALIGNMENT * COOKED_MODEL_ALIGNMENT; };
+	Vector<CookedMesh> meshes;
+	for (auto& mesh : m_Meshes)
+	{
+		CookedMesh cookedMesh = {};
+		cookedMesh.m_Material = mesh.m_Material;
+		cookedMesh.m_VertexCount = mesh.m_Vertices.size();
+		cookedMesh.m_IndexCount = mesh.m_Indices.size() / mesh.m_IndexSize;
+		cookedMesh.m_IndexSize = mesh.m_IndexSize;
+		cookedMesh.m_BoundingBox = mesh.m_BoundingBox;
+		offset = align(offset);
+		cookedMesh.m_VertexOffset = offset;
+		offset = align(offset + mesh.m_Vertices.size() * sizeof(VertexData));
+		cookedMesh.m_IndexOffset = offset;
+		offset += mesh.m_Indices.size();
+		meshes.push_back(cookedMesh);
+	}
+
+	FilePath absolutePath = OS::GetAbsolutePath(cookedPath);
+	std::error_code error;
+	std::filesystem::create_directories(absolutePath.parent_path(), error);
+	// Write to a temporary file first so that a failed write never leaves a cooked model that looks valid
+	FilePath temporaryPath = absolutePath.generic_string() + ".tmp";
+	std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+	if (!stream)
+	{
+		return false;
+	}
+
+	auto pad = [&]() {
+		static const char zeros[COOKED_MODEL_ALIGNMENT] = {};
+		uint64_t position = stream.tellp();
+		stream.write(zeros, align(position) - position);
+	};
+	stream.write((const char*)&header, sizeof(header));
+	stream.write((const char*)meshes.data(), meshes.size() * sizeof(CookedMesh));
+	stream.write((const char*)materials.data(), materials.size() * sizeof(CookedMaterial));
+	for (auto& path : m_MaterialPaths)
+	{
+		stream.write(path.data(), path.size());
+	}
+	for (auto& mesh : m_Meshes)
+	{
+		pad();
+		stream.write((const char*)mesh.m_Vertices.data(), mesh.m_Vertices.size() * sizeof(VertexData));
+		pad();
+		stream.write(mesh.m_Indices.data(), mesh.m_Indices.size());
+	}
+
+	bool isWritten = stream.good();
+	stream.close();
+	if (!isWritten)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	std::filesystem::rename(temporaryPath, absolutePath, error);
+	return !error;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "common/common.h"
+#include "core/renderer/vertex_data.h"
+#include "os/mapped_file.h"
+
+/// "RMDL" read as a little endian integer
+#define COOKED_MODEL_MAGIC 0x4C444D52
+/// Bump when the layout of the cooked model or VertexData changes, so stale cooked models get cooked again
+#define COOKED_MODEL_VERSION 1
+/// Directory relative to Rootex root where cooked models are kept
+#define COOKED_MODEL_DIRECTORY "cache/models/"
+#define COOKED_MODEL_EXTENSION ".rmodel"
+/// Alignment of the vertex and index arrays inside a cooked model
+#define COOKED_MODEL_ALIGNMENT 16
+
+/// Identifies the version of a source model file that a cooked model was made from.
+struct CookedModelSource
+{
+	uint64_t m_Size = 0;
+	int64_t m_LastWriteTime = 0;
+
+	/// Read the stamp of the file at path. Returns false if the file does not exist.
+	static bool Get(const String& path, CookedModelSource& source);
+};
+
+/// Starts every cooked model. Followed by the mesh table, the material table, the material path strings and the vertex and index arrays.
+struct CookedModelHeader
+{
+	uint32_t m_Magic;
+	uint32_t m_Version;
+	uint32_t m_VertexSize;
+	uint32_t m_MeshCount;
+	uint32_t m_MaterialCount;
+	uint32_t m_Padding;
+	CookedModelSource m_Source;
+};
+
+struct CookedMesh
+{
+	/// Index into the material table
+	uint32_t m_Material;
+	uint32_t m_VertexCount;
+	uint32_t m_IndexCount;
+	/// 2 for 16 bit indices, 4 for 32 bit ones
+	uint32_t m_IndexSize;
+	/// Byte offsets from the start of the file
+	uint64_t m_VertexOffset;
+	uint64_t m_IndexOffset;
+	BoundingBox m_BoundingBox;
+};
+
+struct CookedMaterial
+{
+	/// Byte offset of the material path from the start of the file
+	uint64_t m_PathOffset;
+	uint32_t m_PathLength;
+	uint32_t m_Padding;
+};
+
+/// Model geometry in the binary layout of a cooked model, mapped straight from disk.
+/// Vertex and index arrays can be uploaded to buffers without being copied or parsed.
+class CookedModel
+{
+	MappedFile m_File;
+	const CookedModelHeader* m_Header;
+	const CookedMesh* m_Meshes;
+	const CookedMaterial* m_Materials;
+
+public:
+	/// Path of the cooked model made from a source model file.
+	static String GetCookedPath(const String& sourcePath);
+
+	CookedModel();
+	CookedModel(CookedModel&) = delete;
+	~CookedModel() = default;
+
+	/// Map a cooked model. Returns false if it does not exist, is corrupt, or was made from a different version of source or of the format.
+	bool open(const String& cookedPath, const CookedModelSource& source);
+
+	unsigned int getMeshCount() const { return m_Header->m_MeshCount; }
+	const CookedMesh& getMesh(unsigned int mesh) const { return m_Meshes[mesh]; }
+	const VertexData* getVertices(unsigned int mesh) const { return (const VertexData*)(m_File.getData() + m_Meshes[mesh].m_VertexOffset); }
+	const void* getIndices(unsigned int mesh) const { return m_File.getData() + m_Meshes[mesh].m_IndexOffset; }
+	unsigned int getMaterialCount() const { return m_Header->m_MaterialCount; }
+	String getMaterialPath(unsigned int material) const;
+};
+
+/// Collects the geometry of a model and writes it as a cooked model.
+class CookedModelWriter
+{
+	struct MeshData
+	{
+		unsigned int m_Material;
+		Vector<VertexData> m_Vertices;
+		Vector<char> m_Indices;
+		unsigned int m_IndexSize;
+		BoundingBox m_BoundingBox;
+	};
+
+	Vector<String> m_MaterialPaths;
+	Vector<MeshData> m_Meshes;
+
+	unsigned int findMaterial(const String& materialPath);
+
+public:
+	CookedModelWriter() = default;
+	CookedModelWriter(CookedModelWriter&) = delete;
+	~CookedModelWriter() = default;
+
+	void addMesh(const String& materialPath, const Vector<VertexData>& vertices, const Vector<unsigned short>& indices, const BoundingBox& bounds);
+	void addMesh(const String& materialPath, const Vector<VertexData>& vertices, const Vector<int>& indices, const BoundingBox& bounds);
+	/// Write the collected meshes. Returns false if the file could not be written.
+	bool save(const String& cookedPath, const CookedModelSource& source) const;
+};
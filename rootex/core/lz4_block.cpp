@@ -0,0 +1,171 @@
+#include "lz4_block.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/// Shortest match that can be encoded
+#define LZ4_MIN_MATCH 4
+/// The last bytes of a block are always literals
+#define LZ4_LAST_LITERALS 5
+/// The last match has to start at least this many bytes before the end of a block
+#define LZ4_MATCH_FIND_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+
+static uint32_t Read32(const char* at)
+{
+	uint32_t value;
+	memcpy(&value, at, sizeof(value));
+	return value;
+}
+
+static uint32_t Hash(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+/// Lengths that do not fit in 4 bits of the token continue in bytes of 255 and a final byte below 255.
+static void WriteLength(size_t length, std::vector<char>& compressed)
+{
+	while (length >= 255)
+	{
+		compressed.push_back((char)255);
+		length -= 255;
+	}
+	compressed.push_back((char)length);
+}
+
+static void WriteSequence(const char* literals, size_t literalLength, size_t offset, size_t matchLength, std::vector<char>& compressed)
+{
+	size_t matchCode = matchLength ? matchLength - LZ4_MIN_MATCH : 0;
+	compressed.push_back((char)((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15)));
+	if (literalLength >= 15)
+	{
+		WriteLength(literalLength - 15, compressed);
+	}
+	compressed.insert(compressed.end(), literals, literals + literalLength);
+
+	if (matchLength)
+	{
+		compressed.push_back((char)(offset & 0xFF));
+		compressed.push_back((char)(offset >> 8));
+		if (matchCode >= 15)
+		{
+			WriteLength(matchCode - 15, compressed);
+		}
+	}
+}
+
+void LZ4Block::Compress(const char* source, size_t size, std::vector<char>& compressed)
+{
+	size_t anchor = 0;
+	if (size > LZ4_MATCH_FIND_LIMIT)
+	{
+		std::vector<size_t> table(1 << LZ4_HASH_BITS, SIZE_MAX);
+		size_t findLimit = size - LZ4_MATCH_FIND_LIMIT;
+		size_t matchLimit = size - LZ4_LAST_LITERALS;
+
+		size_t position = 0;
+		while (position <= findLimit)
+		{
+			uint32_t sequence = Read32(source + position);
+			uint32_t hash = Hash(sequence);
+			size_t candidate = table[hash];
+			table[hash] = position;
+
+			if (candidate == SIZE_MAX || position - candidate > LZ4_MAX_OFFSET || Read32(source + candidate) != sequence)
+			{
+				position++;
+				continue;
+			}
+
+			size_t matchLength = LZ4_MIN_MATCH;
+			while (position + matchLength < matchLimit && source[candidate + matchLength] == source[position + matchLength])
+			{
+				matchLength++;
+			}
+
+			WriteSequence(source + anchor, position - anchor, position - candidate, matchLength, compressed);
+			position += matchLength;
+			anchor = position;
+		}
+	}
+
+	WriteSequence(source + anchor, size - anchor, 0, 0, compressed);
+}
+
+bool LZ4Block::Decompress(const char* compressed, size_t compressedSize, char* destination, size_t size)
+{
+	const unsigned char* input = (const unsigned char*)compressed;
+	size_t in = 0;
+	size_t out = 0;
+
+	auto readLength = [&](size_t& length) {
+		unsigned char byte;
+		do
+		{
+			if (in >= compressedSize)
+			{
+				return false;
+			}
+			byte = input[in++];
+			length += byte;
+		} while (byte == 255);
+		return true;
+	};
+
+	while (in < compressedSize)
+	{
+		unsigned char token = input[in++];
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !readLength(literalLength))
+		{
+			return false;
+		}
+		if (literalLength > compressedSize - in || literalLength > size - out)
+		{
+			return false;
+		}
+		memcpy(destination + out, input + in, literalLength);
+		in += literalLength;
+		out += literalLength;
+
+		// The last sequence has no match
+		if (in == compressedSize)
+		{
+			break;
+		}
+
+		if (compressedSize - in < 2)
+		{
+			return false;
+		}
+		size_t offset = input[in] | (input[in + 1] << 8);
+		in += 2;
+		if (offset == 0 || offset > out)
+		{
+			return false;
+		}
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(matchLength))
+		{
+			return false;
+		}
+		matchLength += LZ4_MIN_MATCH;
+		if (matchLength > size - out)
+		{
+			return false;
+		}
+
+		// Matches may overlap the bytes they produce, so copy one byte at a time
+		for (size_t i = 0; i < matchLength; i++, out++)
+		{
+			destination[out] = destination[out - offset];
+		}
+	}
+
+	return out == size;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Only the standard library is used here so compression can be built and tested without the rest of the engine
+#include <cstddef>
+#include <vector>
+
+/// Compressor and decompressor for the LZ4 block format.
+/// Compression finds matches greedily with a single hash table, which is fast enough to run while packing.
+/// Decompression only copies bytes around, so it is cheap enough to run while loading.
+class LZ4Block
+{
+public:
+	/// Append the compressed form of size bytes at source to compressed.
+	static void Compress(const char* source, size_t size, std::vector<char>& compressed);
+	/// Decompress exactly size bytes into destination. Returns false if the compressed data is corrupt.
+	static bool Decompress(const char* compressed, size_t compressedSize, char* destination, size_t size);
+};
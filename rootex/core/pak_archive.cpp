@@ -0,0 +1,218 @@
+#include "pak_archive.h"
+
+#include "lz4_block.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+static bool IsEntryLess(uint64_t hashA, const std::string& pathA, uint64_t hashB, const std::string& pathB)
+{
+	return hashA != hashB ? hashA < hashB : pathA < pathB;
+}
+
+uint64_t PakArchive::HashPath(const std::string& normalizedPath)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : normalizedPath)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+PakArchive::PakArchive()
+    : m_Data(nullptr)
+    , m_Size(0)
+    , m_Header(nullptr)
+    , m_Entries(nullptr)
+{
+}
+
+bool PakArchive::open(const char* data, size_t size)
+{
+	m_Data = nullptr;
+	m_Size = 0;
+	if (size < sizeof(PakHeader))
+	{
+		return false;
+	}
+
+	const PakHeader* header = (const PakHeader*)data;
+	if (header->m_Magic != PAK_MAGIC
+	    || header->m_Version != PAK_VERSION
+	    || sizeof(PakHeader) + (uint64_t)header->m_EntryCount * sizeof(PakEntry) > size)
+	{
+		return false;
+	}
+	const PakEntry* entries = (const PakEntry*)(data + sizeof(PakHeader));
+
+	// Reject offsets that point outside the file before anything reads through them
+	for (unsigned int i = 0; i < header->m_EntryCount; i++)
+	{
+		const PakEntry& entry = entries[i];
+		if (entry.m_PathOffset + entry.m_PathLength > size
+		    || entry.m_Offset + entry.m_StoredSize > size
+		    || (entry.m_Compression == PakCompression::None && entry.m_StoredSize != entry.m_Size)
+		    || (entry.m_Compression != PakCompression::None && entry.m_Compression != PakCompression::LZ4))
+		{
+			return false;
+		}
+	}
+
+	m_Data = data;
+	m_Size = size;
+	m_Header = header;
+	m_Entries = entries;
+	return true;
+}
+
+const PakEntry* PakArchive::find(const std::string& normalizedPath) const
+{
+	uint64_t hash = HashPath(normalizedPath);
+	const PakEntry* end = m_Entries + m_Header->m_EntryCount;
+	const PakEntry* entry = std::lower_bound(m_Entries, end, hash, [](const PakEntry& entry, uint64_t hash) { return entry.m_Hash < hash; });
+
+	// Paths with equal hashes sit next to each other
+	for (; entry != end && entry->m_Hash == hash; entry++)
+	{
+		if (entry->m_PathLength == normalizedPath.size() && memcmp(m_Data + entry->m_PathOffset, normalizedPath.data(), normalizedPath.size()) == 0)
+		{
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+bool PakArchive::read(const PakEntry& entry, std::vector<char>& buffer) const
+{
+	if (entry.m_Compression == PakCompression::None)
+	{
+		buffer.assign(getData(entry), getData(entry) + entry.m_Size);
+		return true;
+	}
+
+	buffer.resize(entry.m_Size);
+	if (!LZ4Block::Decompress(getData(entry), entry.m_StoredSize, buffer.data(), entry.m_Size))
+	{
+		buffer.clear();
+		return false;
+	}
+	return true;
+}
+
+std::string PakArchive::getPath(const PakEntry& entry) const
+{
+	return std::string(m_Data + entry.m_PathOffset, entry.m_PathLength);
+}
+
+std::vector<std::string> PakArchive::getFilesInDirectory(const std::string& normalizedDirectory) const
+{
+	std::string prefix = normalizedDirectory;
+	if (!prefix.empty() && prefix.back() != '/')
+	{
+		prefix += '/';
+	}
+
+	std::vector<std::string> files;
+	for (unsigned int i = 0; i < m_Header->m_EntryCount; i++)
+	{
+		std::string path = getPath(m_Entries[i]);
+		if (path.compare(0, prefix.size(), prefix) == 0 && path.find('/', prefix.size()) == std::string::npos)
+		{
+			files.push_back(path);
+		}
+	}
+	return files;
+}
+
+void PakWriter::add(const std::string& normalizedPath, const std::string& sourcePath, bool isCompressed)
+{
+	m_Files.push_back({ normalizedPath, sourcePath, isCompressed });
+}
+
+bool PakWriter::write(std::ostream& stream, const FileReader& readFile) const
+{
+	// Later additions of a path replace earlier ones
+	std::vector<File> files;
+	std::unordered_map<std::string, size_t> fileIndices;
+	for (auto& file : m_Files)
+	{
+		auto [indexIt, isInserted] = fileIndices.emplace(file.m_Path, files.size());
+		if (isInserted)
+		{
+			files.push_back(file);
+		}
+		else
+		{
+			files[indexIt->second] = file;
+		}
+	}
+	std::sort(files.begin(), files.end(), [](const File& a, const File& b) {
+		return IsEntryLess(PakArchive::HashPath(a.m_Path), a.m_Path, PakArchive::HashPath(b.m_Path), b.m_Path);
+	});
+
+	PakHeader header = {};
+	header.m_Magic = PAK_MAGIC;
+	header.m_Version = PAK_VERSION;
+	header.m_EntryCount = files.size();
+
+	// Lay out the table and the strings first, contents are placed as they are written
+	std::vector<PakEntry> entries(files.size());
+	uint64_t offset = sizeof(PakHeader) + files.size() * sizeof(PakEntry);
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		entries[i].m_Hash = PakArchive::HashPath(files[i].m_Path);
+		entries[i].m_PathOffset = offset;
+		entries[i].m_PathLength = files[i].m_Path.size();
+		offset += files[i].m_Path.size();
+	}
+
+	auto align = [](uint64_t value) { return (value + PAK_ALIGNMENT - 1) / PAK_ALIGNMENT * PAK_ALIGNMENT; };
+	auto pad = [&]() {
+		static const char zeros[PAK_ALIGNMENT] = {};
+		uint64_t position = stream.tellp();
+		stream.write(zeros, align(position) - position);
+	};
+	stream.write((const char*)&header, sizeof(header));
+	stream.write((const char*)entries.data(), entries.size() * sizeof(PakEntry));
+	for (auto& file : files)
+	{
+		stream.write(file.m_Path.data(), file.m_Path.size());
+	}
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		std::vector<char> contents;
+		if (!readFile(files[i].m_SourcePath, contents))
+		{
+			return false;
+		}
+
+		PakEntry& entry = entries[i];
+		entry.m_Size = contents.size();
+		entry.m_Compression = PakCompression::None;
+
+		std::vector<char> compressed;
+		if (files[i].m_IsCompressed && !contents.empty())
+		{
+			LZ4Block::Compress(contents.data(), contents.size(), compressed);
+			if (compressed.size() <= contents.size() * (1.0f - PAK_MIN_COMPRESSION_SAVING))
+			{
+				entry.m_Compression = PakCompression::LZ4;
+			}
+		}
+		const std::vector<char>& stored = entry.m_Compression == PakCompression::LZ4 ? compressed : contents;
+
+		pad();
+		entry.m_Offset = stream.tellp();
+		entry.m_StoredSize = stored.size();
+		stream.write(stored.data(), stored.size());
+	}
+
+	// Fill in the table now that every offset is known
+	stream.seekp(sizeof(PakHeader));
+	stream.write((const char*)entries.data(), entries.size() * sizeof(PakEntry));
+	return stream.good();
+}
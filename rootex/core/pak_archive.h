@@ -0,0 +1,123 @@
+#pragma once
+
+// Only the standard library is used here so the archive format can be built and tested without the rest of the engine.
+// Reading archives from disk and writing them to disk live in pak_archive_file.cpp.
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+/// "RPAK" read as a little endian integer
+#define PAK_MAGIC 0x4B415052
+/// Bump when the layout of the archive changes
+#define PAK_VERSION 1
+/// Alignment of the contents of every file inside an archive
+#define PAK_ALIGNMENT 16
+/// Archive relative to Rootex root that the game mounts on startup if it exists
+#define PAK_GAME_ARCHIVE "game.pak"
+/// Files are only stored compressed if that saves at least this fraction of their size
+#define PAK_MIN_COMPRESSION_SAVING 0.1f
+
+enum class PakCompression : uint32_t
+{
+	None = 0,
+	/// LZ4 block format, see LZ4Block
+	LZ4 = 1
+};
+
+/// Starts every archive. Followed by the table of contents, the path strings and the aligned file contents.
+struct PakHeader
+{
+	uint32_t m_Magic;
+	uint32_t m_Version;
+	uint32_t m_EntryCount;
+	uint32_t m_Padding;
+};
+
+/// Entry of the table of contents. Entries are sorted by path hash and then by path.
+struct PakEntry
+{
+	uint64_t m_Hash;
+	/// Byte offsets from the start of the archive
+	uint64_t m_PathOffset;
+	uint64_t m_Offset;
+	/// Bytes the contents take inside the archive
+	uint64_t m_StoredSize;
+	/// Bytes of the contents once decompressed
+	uint64_t m_Size;
+	uint32_t m_PathLength;
+	PakCompression m_Compression;
+};
+
+/// Read only archive that packs many files into one, mapped straight from disk.
+/// Files are looked up by binary search over the hashes of their normalized paths.
+/// Uncompressed files can be used in place inside the mapping without copying them.
+class PakArchive
+{
+	std::shared_ptr<MappedFile> m_File;
+	const char* m_Data;
+	size_t m_Size;
+	const PakHeader* m_Header;
+	const PakEntry* m_Entries;
+
+public:
+	/// 64 bit FNV-1a hash of a normalized path.
+	static uint64_t HashPath(const std::string& normalizedPath);
+
+	PakArchive();
+	PakArchive(PakArchive&) = delete;
+	~PakArchive() = default;
+
+	/// Map an archive. Returns false if it does not exist, is corrupt or was written by a different version of the format.
+	bool open(const std::string& pakPath);
+	/// Read an archive that is already in memory, aligned to 8 bytes. data has to outlive the archive. Returns false if it is corrupt.
+	bool open(const char* data, size_t size);
+
+	/// Find a file by its normalized path. Returns nullptr if the archive does not contain it.
+	const PakEntry* find(const std::string& normalizedPath) const;
+	/// Copy or decompress the contents of a file. Returns false if compressed contents are corrupt.
+	bool read(const PakEntry& entry, std::vector<char>& buffer) const;
+	/// Contents of an uncompressed file inside the archive.
+	const char* getData(const PakEntry& entry) const { return m_Data + entry.m_Offset; }
+	std::string getPath(const PakEntry& entry) const;
+	/// Normalized paths of the files directly inside a normalized directory path.
+	std::vector<std::string> getFilesInDirectory(const std::string& normalizedDirectory) const;
+
+	/// The mapping of the whole archive, to keep it alive while contents are used in place. Null for archives read from memory.
+	const std::shared_ptr<MappedFile>& getMappedFile() const { return m_File; }
+	unsigned int getEntryCount() const { return m_Header->m_EntryCount; }
+};
+
+/// Collects files and writes them as an archive.
+class PakWriter
+{
+	struct File
+	{
+		std::string m_Path;
+		std::string m_SourcePath;
+		bool m_IsCompressed;
+	};
+
+	std::vector<File> m_Files;
+
+public:
+	/// Reads the contents of the file at a source path. Returns false if the file could not be read.
+	typedef std::function<bool(const std::string& sourcePath, std::vector<char>& contents)> FileReader;
+
+	PakWriter() = default;
+	PakWriter(PakWriter&) = delete;
+	~PakWriter() = default;
+
+	/// Add the file at sourcePath to the archive, to be found by the normalized path. Compressed files are stored as is when compression does not pay off.
+	void add(const std::string& normalizedPath, const std::string& sourcePath, bool isCompressed);
+	/// Write the collected files read from disk. Returns false if a file could not be read or the archive could not be written.
+	bool save(const std::string& pakPath) const;
+	/// Write the collected files to a seekable stream, reading them with readFile. Returns false if a file could not be read or written.
+	bool write(std::ostream& stream, const FileReader& readFile) const;
+
+	unsigned int getFileCount() const { return m_Files.size(); }
+};
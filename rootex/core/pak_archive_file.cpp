@@ -0,0 +1,49 @@
+#include "pak_archive.h"
+
+#include "common/common.h"
+#include "os/mapped_file.h"
+
+bool PakArchive::open(const String& pakPath)
+{
+	m_File.reset(new MappedFile());
+	if (!m_File->open(pakPath) || !open(m_File->getData(), m_File->getSize()))
+	{
+		m_File.reset();
+		return false;
+	}
+	return true;
+}
+
+bool PakWriter::save(const String& pakPath) const
+{
+	FilePath absolutePath = OS::GetAbsolutePath(pakPath);
+	std::error_code error;
+	std::filesystem::create_directories(absolutePath.parent_path(), error);
+	// Write to a temporary file first so that a failed write never leaves an archive that looks valid
+	FilePath temporaryPath = absolutePath.generic_string() + ".tmp";
+	std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+	if (!stream)
+	{
+		ERR("Could not write archive: " + pakPath);
+		return false;
+	}
+
+	bool isWritten = write(stream, [](const String& sourcePath, FileBuffer& contents) {
+		if (!OS::IsExists(sourcePath))
+		{
+			ERR("Could not find file to pack: " + sourcePath);
+			return false;
+		}
+		contents = OS::LoadFileContents(sourcePath);
+		return true;
+	});
+	stream.close();
+	if (!isWritten)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	std::filesystem::rename(temporaryPath, absolutePath, error);
+	return !error;
+}
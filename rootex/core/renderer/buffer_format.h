@@ -10,27 +10,39 @@ struct VertexBufferElement
 	/// Abstracts the DXGI input format types
 	enum Type
 	{
+		FloatFloatFloatFloat = DXGI_FORMAT_R32G32B32A32_FLOAT,
 		FloatFloatFloat = DXGI_FORMAT_R32G32B32_FLOAT,
 		FloatFloat = DXGI_FORMAT_R32G32_FLOAT,
-		ByteByteByteByte = DXGI_FORMAT_R8G8B8A8_UNORM
+		ByteByteByteByte = DXGI_FORMAT_R8G8B8A8_UNORM,
+		UintUint = DXGI_FORMAT_R32G32_UINT
 	};
 
 	/// What type of objects are present in buffer
 	Type m_Type; 
 	/// Used as the semantic of the Vertex Buffer element in shaders
 	LPCSTR m_Name;
+	/// Index of the semantic, used by elements spanning several registers like matrices
+	unsigned int m_SemanticIndex = 0;
+	/// Input slot of the vertex buffer the element is read from
+	unsigned int m_Slot = 0;
+	/// Whether the element advances once per instance instead of once per vertex
+	bool m_IsPerInstance = false;
 
 	/// Total size of the Vertex Buffer
 	static unsigned int GetSize(Type type)
 	{
 		switch (type)
 		{
+		case FloatFloatFloatFloat:
+			return sizeof(float) * 4;
 		case FloatFloatFloat:
 			return sizeof(float) * 3;
 		case FloatFloat:
 			return sizeof(float) * 2;
 		case ByteByteByteByte:
 			return sizeof(char) * 4;
+		case UintUint:
+			return sizeof(unsigned int) * 2;
 		default:
 			ERR("Unknown size found");
 			return 0;
@@ -47,6 +59,8 @@ public:
 	BufferFormat() = default;
 
 	void push(VertexBufferElement::Type type, LPCSTR name) { m_Elements.push_back({ type, name }); }
+	/// Add an element read once per instance from the instance buffer in slot 1
+	void pushInstance(VertexBufferElement::Type type, LPCSTR name, unsigned int semanticIndex) { m_Elements.push_back({ type, name, semanticIndex, 1, true }); }
 
 	const Vector<VertexBufferElement>& getElements() const { return m_Elements; }
 };
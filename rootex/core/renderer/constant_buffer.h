@@ -85,17 +85,17 @@ struct StaticPointLightsInfo
 	PointLightInfo pointLightInfos[MAX_STATIC_POINT_LIGHTS];
 };
 
+/// Dynamic point and spot lights are read from the light cluster buffers, see LightClusters
 struct LightsInfo
 {
 	Vector3 cameraPos;
-	int pointLightCount = 0;
-	PointLightInfo pointLightInfos[MAX_DYNAMIC_POINT_LIGHTS];
 	int directionalLightPresent = 0;
-	float pad2[3];
 	DirectionalLightInfo directionalLightInfo;
-	int spotLightCount = 0;
-	float pad3[3];
-	SpotLightInfo spotLightInfos[MAX_DYNAMIC_SPOT_LIGHTS];
+	/// Number of light clusters per pixel along the width and height of the screen
+	Vector2 clusterScale;
+	/// The depth slice of a view depth d is log(d) * clusterDepthScale - clusterDepthBias
+	float clusterDepthScale = 0.0f;
+	float clusterDepthBias = 0.0f;
 };
 
 /// Constant buffer uploaded once per frame in the PS
@@ -0,0 +1,98 @@
+#include "constant_buffer_ring.h"
+
+#include "rendering_device.h"
+
+ConstantBufferRing::ConstantBufferRing()
+    : m_Allocator(CONSTANT_BUFFER_RING_SIZE, CONSTANT_BUFFER_RING_ALIGNMENT)
+    , m_IsDiscardPending(true)
+    , m_Uploads(0)
+    , m_LastFrameUploads(0)
+{
+}
+
+ConstantBufferRing* ConstantBufferRing::GetSingleton()
+{
+	static ConstantBufferRing singleton;
+	return &singleton;
+}
+
+void ConstantBufferRing::createBuffer()
+{
+	D3D11_BUFFER_DESC cbd = { 0 };
+	cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	cbd.Usage = D3D11_USAGE_DYNAMIC;
+	cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	cbd.MiscFlags = 0u;
+	cbd.ByteWidth = m_Allocator.getCapacity();
+	cbd.StructureByteStride = 0u;
+
+	m_Buffer = RenderingDevice::GetSingleton()->createVSCB(&cbd, nullptr);
+	m_IsDiscardPending = true;
+}
+
+void ConstantBufferRing::beginFrame()
+{
+	m_LastFrameUploads = m_Uploads;
+	m_Uploads = 0;
+
+	if (m_Allocator.getOverflowBytes() > 0)
+	{
+		size_t demand = m_Allocator.getFrameBytes() + m_Allocator.getOverflowBytes();
+		m_Allocator.resize(std::max(demand, m_Allocator.getCapacity() * 2));
+		m_Buffer.Reset();
+	}
+
+	if (m_Allocator.beginFrame())
+	{
+		m_IsDiscardPending = true;
+	}
+}
+
+size_t ConstantBufferRing::upload(const void* data, size_t size)
+{
+	if (!RenderingDevice::GetSingleton()->isConstantBufferOffsetSupported())
+	{
+		return RingAllocator::InvalidOffset;
+	}
+	if (!m_Buffer)
+	{
+		createBuffer();
+	}
+
+	size_t offset = m_Allocator.allocate(size);
+	if (offset == RingAllocator::InvalidOffset)
+	{
+		return offset;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE subresource;
+	RenderingDevice::GetSingleton()->mapBuffer(m_Buffer.Get(), subresource, m_IsDiscardPending ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE);
+	memcpy((char*)subresource.pData + offset, data, size);
+	RenderingDevice::GetSingleton()->unmapBuffer(m_Buffer.Get());
+
+	m_IsDiscardPending = false;
+	m_Uploads++;
+	return offset;
+}
+
+bool ConstantBufferRing::setVSConstantBuffer(const void* data, size_t size, UINT slot)
+{
+	size_t offset = upload(data, size);
+	if (offset == RingAllocator::InvalidOffset)
+	{
+		return false;
+	}
+	RenderingDevice::GetSingleton()->setVSCB(m_Buffer.Get(), slot, offset / 16, RingAllocator::AlignUp(size, CONSTANT_BUFFER_RING_ALIGNMENT) / 16);
+	return true;
+}
+
+bool ConstantBufferRing::setPSConstantBuffer(const void* data, size_t size, UINT slot)
+{
+	size_t offset = upload(data, size);
+	if (offset == RingAllocator::InvalidOffset)
+	{
+		return false;
+	}
+	RenderingDevice::GetSingleton()->setPSCB(m_Buffer.Get(), slot, offset / 16, RingAllocator::AlignUp(size, CONSTANT_BUFFER_RING_ALIGNMENT) / 16);
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <d3d11.h>
+
+#include "common/common.h"
+#include "ring_allocator.h"
+
+/// Initial size of the constant buffer ring. The ring doubles in size after a frame that did not fit.
+#define CONSTANT_BUFFER_RING_SIZE (1024 * 1024)
+/// Granularity of constant buffer offsets, 16 constants of 16 bytes.
+#define CONSTANT_BUFFER_RING_ALIGNMENT 256
+
+/// One large dynamic constant buffer that per draw and per frame constants are sub-allocated from.
+/// Uploads are appended with no overwrite maps and bound with constant buffer offsets, instead of discarding a separate buffer per upload.
+/// Data uploaded through the ring is only valid until the end of the frame.
+class ConstantBufferRing
+{
+	RingAllocator m_Allocator;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_Buffer;
+	/// The next map has to discard the buffer, because the ring has wrapped or the buffer is new.
+	bool m_IsDiscardPending;
+	int m_Uploads;
+	int m_LastFrameUploads;
+
+	ConstantBufferRing();
+	ConstantBufferRing(ConstantBufferRing&) = delete;
+	~ConstantBufferRing() = default;
+
+	void createBuffer();
+	/// Copy size bytes into the ring. Returns the offset of the copy, or RingAllocator::InvalidOffset if it did not fit.
+	size_t upload(const void* data, size_t size);
+
+public:
+	static ConstantBufferRing* GetSingleton();
+
+	/// Start allocating for a new frame. Grows the ring if the last frame did not fit.
+	void beginFrame();
+	/// Upload a constant buffer and bind it to a vertex shader slot. Returns false if it could not be uploaded through the ring.
+	bool setVSConstantBuffer(const void* data, size_t size, UINT slot);
+	/// Upload a constant buffer and bind it to a pixel shader slot. Returns false if it could not be uploaded through the ring.
+	bool setPSConstantBuffer(const void* data, size_t size, UINT slot);
+
+	const RingAllocator& getAllocator() const { return m_Allocator; }
+	int getLastFrameUploads() const { return m_LastFrameUploads; }
+};
@@ -0,0 +1,114 @@
+#include "frustum.h"
+
+Frustum::Frustum(const DirectX::XMFLOAT4X4& viewProjection)
+{
+	const DirectX::XMFLOAT4X4& m = viewProjection;
+	// Row vectors are multiplied on the left so planes are combinations of the matrix columns
+	m_Planes[0] = { m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41 };
+	m_Planes[1] = { m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41 };
+	m_Planes[2] = { m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42 };
+	m_Planes[3] = { m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42 };
+	// Direct3D clip space depth goes from 0 to w
+	m_Planes[4] = { m._13, m._23, m._33, m._43 };
+	m_Planes[5] = { m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43 };
+
+	for (auto& plane : m_Planes)
+	{
+		DirectX::XMStoreFloat4(&plane, DirectX::XMPlaneNormalize(DirectX::XMLoadFloat4(&plane)));
+	}
+}
+
+DirectX::BoundingBox Frustum::TransformBounds(const DirectX::BoundingBox& bounds, const DirectX::XMFLOAT4X4& transform)
+{
+	DirectX::BoundingBox result;
+	bounds.Transform(result, DirectX::XMLoadFloat4x4(&transform));
+	return result;
+}
+
+bool Frustum::intersects(const DirectX::BoundingBox& bounds) const
+{
+	DirectX::XMVECTOR center = DirectX::XMLoadFloat3(&bounds.Center);
+	DirectX::XMVECTOR extents = DirectX::XMLoadFloat3(&bounds.Extents);
+	for (auto& plane : m_Planes)
+	{
+		DirectX::XMVECTOR p = DirectX::XMLoadFloat4(&plane);
+		// Signed distance of the center against the projected radius of the box on the plane normal
+		DirectX::XMVECTOR distance = DirectX::XMPlaneDotCoord(p, center);
+		DirectX::XMVECTOR radius = DirectX::XMVector3Dot(extents, DirectX::XMVectorAbs(p));
+		if (DirectX::XMVector4Less(DirectX::XMVectorAdd(distance, radius), DirectX::XMVectorZero()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::intersects(const DirectX::BoundingSphere& sphere) const
+{
+	DirectX::XMVECTOR center = DirectX::XMLoadFloat3(&sphere.Center);
+	DirectX::XMVECTOR radius = DirectX::XMVectorReplicate(sphere.Radius);
+	for (auto& plane : m_Planes)
+	{
+		DirectX::XMVECTOR distance = DirectX::XMPlaneDotCoord(DirectX::XMLoadFloat4(&plane), center);
+		if (DirectX::XMVector4Less(DirectX::XMVectorAdd(distance, radius), DirectX::XMVectorZero()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void Frustum::cull(const std::vector<DirectX::BoundingBox>& bounds, std::vector<char>& isInside) const
+{
+	isInside.resize(bounds.size());
+
+	// Splat every plane component once, each lane then tests a different box
+	DirectX::XMVECTOR planeX[6], planeY[6], planeZ[6], planeW[6];
+	DirectX::XMVECTOR absX[6], absY[6], absZ[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = DirectX::XMVectorReplicate(m_Planes[p].x);
+		planeY[p] = DirectX::XMVectorReplicate(m_Planes[p].y);
+		planeZ[p] = DirectX::XMVectorReplicate(m_Planes[p].z);
+		planeW[p] = DirectX::XMVectorReplicate(m_Planes[p].w);
+		absX[p] = DirectX::XMVectorAbs(planeX[p]);
+		absY[p] = DirectX::XMVectorAbs(planeY[p]);
+		absZ[p] = DirectX::XMVectorAbs(planeZ[p]);
+	}
+
+	int count = (int)bounds.size();
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const DirectX::BoundingBox* b = &bounds[i];
+		DirectX::XMVECTOR centerX = DirectX::XMVectorSet(b[0].Center.x, b[1].Center.x, b[2].Center.x, b[3].Center.x);
+		DirectX::XMVECTOR centerY = DirectX::XMVectorSet(b[0].Center.y, b[1].Center.y, b[2].Center.y, b[3].Center.y);
+		DirectX::XMVECTOR centerZ = DirectX::XMVectorSet(b[0].Center.z, b[1].Center.z, b[2].Center.z, b[3].Center.z);
+		DirectX::XMVECTOR extentX = DirectX::XMVectorSet(b[0].Extents.x, b[1].Extents.x, b[2].Extents.x, b[3].Extents.x);
+		DirectX::XMVECTOR extentY = DirectX::XMVectorSet(b[0].Extents.y, b[1].Extents.y, b[2].Extents.y, b[3].Extents.y);
+		DirectX::XMVECTOR extentZ = DirectX::XMVectorSet(b[0].Extents.z, b[1].Extents.z, b[2].Extents.z, b[3].Extents.z);
+
+		DirectX::XMVECTOR outside = DirectX::XMVectorFalseInt();
+		for (int p = 0; p < 6; p++)
+		{
+			DirectX::XMVECTOR distance = DirectX::XMVectorMultiplyAdd(centerX, planeX[p], planeW[p]);
+			distance = DirectX::XMVectorMultiplyAdd(centerY, planeY[p], distance);
+			distance = DirectX::XMVectorMultiplyAdd(centerZ, planeZ[p], distance);
+			DirectX::XMVECTOR radius = DirectX::XMVectorMultiply(extentX, absX[p]);
+			radius = DirectX::XMVectorMultiplyAdd(extentY, absY[p], radius);
+			radius = DirectX::XMVectorMultiplyAdd(extentZ, absZ[p], radius);
+			outside = DirectX::XMVectorOrInt(outside, DirectX::XMVectorLess(DirectX::XMVectorAdd(distance, radius), DirectX::XMVectorZero()));
+		}
+
+		DirectX::XMUINT4 mask;
+		DirectX::XMStoreUInt4(&mask, outside);
+		isInside[i + 0] = mask.x == 0;
+		isInside[i + 1] = mask.y == 0;
+		isInside[i + 2] = mask.z == 0;
+		isInside[i + 3] = mask.w == 0;
+	}
+	for (; i < count; i++)
+	{
+		isInside[i] = intersects(bounds[i]);
+	}
+}
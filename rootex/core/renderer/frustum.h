@@ -0,0 +1,31 @@
+#pragma once
+
+// Only DirectXMath and the standard library are used here so culling can be built and tested without the rest of the engine
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+#include <vector>
+
+/// View frustum as 6 planes facing inwards. Culling runs on the CPU without a rendering device.
+class Frustum
+{
+	/// Left, right, bottom, top, near and far planes as (a, b, c, d) where ax + by + cz + d >= 0 is inside.
+	DirectX::XMFLOAT4 m_Planes[6];
+
+public:
+	/// Extract the planes from a view projection matrix, with Direct3D clip space conventions.
+	Frustum(const DirectX::XMFLOAT4X4& viewProjection);
+	Frustum(const Frustum&) = default;
+	~Frustum() = default;
+
+	/// Returns the axis aligned bounds of a local space box after applying transform to it.
+	static DirectX::BoundingBox TransformBounds(const DirectX::BoundingBox& bounds, const DirectX::XMFLOAT4X4& transform);
+
+	/// Returns false only if the box lies completely outside one of the planes.
+	bool intersects(const DirectX::BoundingBox& bounds) const;
+	/// Returns false only if the sphere lies completely outside one of the planes.
+	bool intersects(const DirectX::BoundingSphere& sphere) const;
+	/// Test boxes 4 at a time. isInside[i] is set to 1 if bounds[i] intersects the frustum, otherwise 0.
+	void cull(const std::vector<DirectX::BoundingBox>& bounds, std::vector<char>& isInside) const;
+
+	const DirectX::XMFLOAT4& getPlane(int index) const { return m_Planes[index]; }
+};
@@ -15,6 +15,9 @@ protected:
 public:
 	IndexBuffer(const Vector<unsigned short>& indices);
 	IndexBuffer(const Vector<int>& indices);
+	/// Upload count indices straight from memory that is not owned by a Vector, like a mapped file.
+	IndexBuffer(const unsigned short* indices, unsigned int count);
+	IndexBuffer(const int* indices, unsigned int count);
 	~IndexBuffer() = default;
 
 	void bind() const;
@@ -0,0 +1,101 @@
+#include "light_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+
+DirectX::BoundingSphere LightClusters::GetSpotLightBounds(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& direction, float range, float angle)
+{
+	float cosAngle = std::cos(angle);
+	// Wide cones are bounded by the circle at their base, narrow ones by the sphere through their apex and base circle
+	float distance;
+	float radius;
+	if (angle > DirectX::XM_PIDIV4)
+	{
+		distance = cosAngle * range;
+		radius = std::sin(angle) * range;
+	}
+	else
+	{
+		distance = range / (2.0f * cosAngle);
+		radius = distance;
+	}
+
+	DirectX::XMFLOAT3 center;
+	DirectX::XMStoreFloat3(&center, DirectX::XMVectorMultiplyAdd(DirectX::XMLoadFloat3(&direction), DirectX::XMVectorReplicate(distance), DirectX::XMLoadFloat3(&position)));
+	return DirectX::BoundingSphere(center, radius);
+}
+
+LightClusters::LightClusters()
+    : m_ProjectionX(1.0f)
+    , m_ProjectionY(1.0f)
+    , m_Near(0.1f)
+    , m_Far(100.0f)
+    , m_DepthScale(0.0f)
+    , m_DepthBias(0.0f)
+{
+	m_Clusters.resize(LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z);
+	m_Cursors.resize(m_Clusters.size());
+	DirectX::XMFLOAT4X4 identity;
+	DirectX::XMStoreFloat4x4(&identity, DirectX::XMMatrixIdentity());
+	setProjection(identity, m_Near, m_Far);
+}
+
+int LightClusters::getSlice(float depth) const
+{
+	int slice = std::log(depth) * m_DepthScale - m_DepthBias;
+	return std::clamp(slice, 0, LIGHT_CLUSTERS_Z - 1);
+}
+
+float LightClusters::getSliceDepth(int slice) const
+{
+	return m_Near * std::pow(m_Far / m_Near, (float)slice / LIGHT_CLUSTERS_Z);
+}
+
+void LightClusters::setProjection(const DirectX::XMFLOAT4X4& projection, float nearPlane, float farPlane)
+{
+	m_ProjectionX = projection._11;
+	m_ProjectionY = projection._22;
+	m_Near = nearPlane;
+	m_Far = farPlane;
+
+	float logRange = std::log(m_Far / m_Near);
+	m_DepthScale = LIGHT_CLUSTERS_Z / logRange;
+	m_DepthBias = LIGHT_CLUSTERS_Z * std::log(m_Near) / logRange;
+}
+
+void LightClusters::bin(const std::vector<ClusteredLight>& pointLights, const std::vector<ClusteredLight>& spotLights)
+{
+	for (auto& cluster : m_Clusters)
+	{
+		cluster = {};
+	}
+
+	// Count the lights in each cluster, then lay the lists out one after the other
+	for (auto& light : pointLights)
+	{
+		visitClusters(light, [this](unsigned int cluster) { m_Clusters[cluster].m_PointLightCount++; });
+	}
+	for (auto& light : spotLights)
+	{
+		visitClusters(light, [this](unsigned int cluster) { m_Clusters[cluster].m_SpotLightCount++; });
+	}
+
+	unsigned int offset = 0;
+	for (size_t i = 0; i < m_Clusters.size(); i++)
+	{
+		m_Clusters[i].m_Offset = offset;
+		m_Cursors[i] = offset;
+		offset += m_Clusters[i].m_PointLightCount + m_Clusters[i].m_SpotLightCount;
+	}
+	m_LightIndices.resize(offset);
+
+	// Point lights fill the start of each list, leaving the cursors at the start of the spot lights
+	for (auto& light : pointLights)
+	{
+		visitClusters(light, [this, &light](unsigned int cluster) { m_LightIndices[m_Cursors[cluster]++] = light.m_Index; });
+	}
+	for (auto& light : spotLights)
+	{
+		visitClusters(light, [this, &light](unsigned int cluster) { m_LightIndices[m_Cursors[cluster]++] = light.m_Index; });
+	}
+}
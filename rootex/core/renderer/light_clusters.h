@@ -0,0 +1,119 @@
+#pragma once
+
+// Only DirectXMath and the standard library are used here so binning can be built and benchmarked without the rest of the engine
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+#include <vector>
+
+#include "core/renderer/shaders/register_locations_pixel_shader.h"
+
+/// Bounding sphere of a light in view space, and the value written to the light index lists for it.
+struct ClusteredLight
+{
+	DirectX::XMFLOAT3 m_Center;
+	float m_Radius;
+	unsigned int m_Index;
+};
+
+/// Range of the light index list holding the lights overlapping a cluster. Point lights come first, then spot lights.
+struct LightCluster
+{
+	unsigned int m_Offset;
+	unsigned int m_PointLightCount;
+	unsigned int m_SpotLightCount;
+	unsigned int m_Pad;
+};
+
+/// Bins lights into a grid of view space froxels, LIGHT_CLUSTERS_X by LIGHT_CLUSTERS_Y screen tiles split into LIGHT_CLUSTERS_Z
+/// exponentially spaced depth slices, and builds a compact index list of the lights affecting each cluster.
+/// Works in the right handed view space of the camera, looking down -z, and can be used without a rendering device.
+class LightClusters
+{
+	float m_ProjectionX;
+	float m_ProjectionY;
+	float m_Near;
+	float m_Far;
+	/// The depth slice of a view depth d is log(d) * m_DepthScale - m_DepthBias.
+	float m_DepthScale;
+	float m_DepthBias;
+
+	std::vector<LightCluster> m_Clusters;
+	std::vector<unsigned int> m_LightIndices;
+	std::vector<unsigned int> m_Cursors;
+
+	int getSlice(float depth) const;
+	float getSliceDepth(int slice) const;
+	/// Call visit with the index of every cluster overlapped by the bounding sphere of light.
+	template <class Visit>
+	void visitClusters(const ClusteredLight& light, const Visit& visit) const;
+
+public:
+	static unsigned int GetClusterIndex(int x, int y, int z) { return (z * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X + x; }
+	/// Bounding sphere of the cone lit by a spot light. angle is the half angle of the cone in radians.
+	static DirectX::BoundingSphere GetSpotLightBounds(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& direction, float range, float angle);
+
+	LightClusters();
+	LightClusters(LightClusters&) = delete;
+	~LightClusters() = default;
+
+	/// Set the symmetric perspective projection whose frustum is divided into clusters.
+	void setProjection(const DirectX::XMFLOAT4X4& projection, float nearPlane, float farPlane);
+	/// Rebuild the clusters and index lists from lights in view space.
+	void bin(const std::vector<ClusteredLight>& pointLights, const std::vector<ClusteredLight>& spotLights);
+
+	const std::vector<LightCluster>& getClusters() const { return m_Clusters; }
+	const std::vector<unsigned int>& getLightIndices() const { return m_LightIndices; }
+	float getDepthScale() const { return m_DepthScale; }
+	float getDepthBias() const { return m_DepthBias; }
+};
+
+template <class Visit>
+inline void LightClusters::visitClusters(const ClusteredLight& light, const Visit& visit) const
+{
+	float depth = -light.m_Center.z;
+	float radius = light.m_Radius;
+	float minDepth = std::max(depth - radius, m_Near);
+	float maxDepth = std::min(depth + radius, m_Far);
+	if (minDepth > maxDepth)
+	{
+		return;
+	}
+
+	int lastSlice = getSlice(maxDepth);
+	for (int slice = getSlice(minDepth); slice <= lastSlice; slice++)
+	{
+		float sliceNear = std::max(minDepth, getSliceDepth(slice));
+		float sliceFar = std::min(maxDepth, getSliceDepth(slice + 1));
+
+		// Radius of the widest cross section of the sphere inside the slice
+		float offset = depth < sliceNear ? sliceNear - depth : (depth > sliceFar ? depth - sliceFar : 0.0f);
+		float sliceRadius = std::sqrt(std::max(radius * radius - offset * offset, 0.0f));
+
+		// For a fixed x, x / depth is monotonic in depth so the extremes lie on the slice bounds
+		float minX = light.m_Center.x - sliceRadius;
+		float maxX = light.m_Center.x + sliceRadius;
+		float minY = light.m_Center.y - sliceRadius;
+		float maxY = light.m_Center.y + sliceRadius;
+		float ndcMinX = std::min(minX / sliceNear, minX / sliceFar) * m_ProjectionX;
+		float ndcMaxX = std::max(maxX / sliceNear, maxX / sliceFar) * m_ProjectionX;
+		float ndcMinY = std::min(minY / sliceNear, minY / sliceFar) * m_ProjectionY;
+		float ndcMaxY = std::max(maxY / sliceNear, maxY / sliceFar) * m_ProjectionY;
+		if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f)
+		{
+			continue;
+		}
+
+		// Tiles are numbered from the top left of the screen
+		int firstX = std::max((int)((ndcMinX * 0.5f + 0.5f) * LIGHT_CLUSTERS_X), 0);
+		int lastX = std::min((int)((ndcMaxX * 0.5f + 0.5f) * LIGHT_CLUSTERS_X), LIGHT_CLUSTERS_X - 1);
+		int firstY = std::max((int)((0.5f - ndcMaxY * 0.5f) * LIGHT_CLUSTERS_Y), 0);
+		int lastY = std::min((int)((0.5f - ndcMinY * 0.5f) * LIGHT_CLUSTERS_Y), LIGHT_CLUSTERS_Y - 1);
+		for (int y = firstY; y <= lastY; y++)
+		{
+			for (int x = firstX; x <= lastX; x++)
+			{
+				visit(GetClusterIndex(x, y, slice));
+			}
+		}
+	}
+}
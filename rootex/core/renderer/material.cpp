@@ -17,8 +17,10 @@ JSON::json Material::getJSON() const
 
 Material::Material(Shader* shader, const String& typeName, bool isAlpha)
     : m_Shader(shader)
+    , m_InstancedShader(nullptr)
     , m_TypeName(typeName)
     , m_IsAlpha(isAlpha)
+    , m_ID(s_NextID++)
 {
 }
 
@@ -1,17 +1,24 @@
 #pragma once
 
 #include "constant_buffer.h"
+#include "constant_buffer_ring.h"
 #include "shader.h"
 
 class Material
 {
+	static inline Atomic<unsigned int> s_NextID { 0 };
+
 protected:
 	Shader* m_Shader;
+	/// Variant of m_Shader reading model transforms from an instance buffer. nullptr if the material cannot be instanced.
+	Shader* m_InstancedShader;
 	Vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> m_PSConstantBuffer;
 	Vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> m_VSConstantBuffer;
 	String m_FileName;
 	String m_TypeName;
 	bool m_IsAlpha;
+	/// Unique ID used to order draws by material.
+	unsigned int m_ID;
 
 	Material(Shader* shader, const String& typeName, bool isAlpha);
 
@@ -20,15 +27,26 @@ public:
 	static void SetPSConstantBuffer(const T& constantBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& pointer, UINT slot);
 	template <typename T>
 	static void SetVSConstantBuffer(const T& constantBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& pointer, UINT slot);
+	/// Upload constants that are only read until the end of the frame through the ConstantBufferRing.
+	/// pointer is used as with SetPSConstantBuffer() when the ring cannot be used.
+	template <typename T>
+	static void SetTransientPSConstantBuffer(const T& constantBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& pointer, UINT slot);
+	template <typename T>
+	static void SetTransientVSConstantBuffer(const T& constantBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& pointer, UINT slot);
 
 	Material() = delete;
 	virtual ~Material() = default;
 
 	virtual void bind();
+	/// Upload the constant buffers that change with every object drawn, like the model matrix, while the material stays bound.
+	virtual void bindObject() {}
 	
 	virtual ID3D11ShaderResourceView* getPreview() = 0;
 
 	bool isAlpha() { return m_IsAlpha; }
+	unsigned int getID() const { return m_ID; }
+	Shader* getShader() const { return m_Shader; }
+	Shader* getInstancedShader() const { return m_InstancedShader; }
 	String getFileName() { return m_FileName; };
 	String getTypeName() { return m_TypeName; };
 	String getFullName() { return m_FileName + " - " + m_TypeName; };
@@ -98,3 +116,21 @@ void Material::SetVSConstantBuffer(const T& constantBuffer, Microsoft::WRL::ComP
 		RenderingDevice::GetSingleton()->setVSCB(bufferPointer.Get(), slot);
 	}
 }
+
+template <typename T>
+void Material::SetTransientPSConstantBuffer(const T& constantBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& bufferPointer, UINT slot)
+{
+	if (!ConstantBufferRing::GetSingleton()->setPSConstantBuffer(&constantBuffer, sizeof(T), slot))
+	{
+		SetPSConstantBuffer(constantBuffer, bufferPointer, slot);
+	}
+}
+
+template <typename T>
+void Material::SetTransientVSConstantBuffer(const T& constantBuffer, Microsoft::WRL::ComPtr<ID3D11Buffer>& bufferPointer, UINT slot)
+{
+	if (!ConstantBufferRing::GetSingleton()->setVSConstantBuffer(&constantBuffer, sizeof(T), slot))
+	{
+		SetVSConstantBuffer(constantBuffer, bufferPointer, slot);
+	}
+}
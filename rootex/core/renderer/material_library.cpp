@@ -117,5 +117,5 @@ void MaterialLibrary::CreateNewMaterialFile(const String& materialPath, const St
 
 bool MaterialLibrary::IsExists(const String& materialPath)
 {
-	return OS::IsExists(materialPath);
+	return ResourceLoader::IsExists(materialPath);
 }
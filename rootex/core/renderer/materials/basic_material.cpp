@@ -23,6 +23,7 @@ BasicMaterial::BasicMaterial(bool isAlpha, const String& imagePath, const String
     , m_IsAffectedBySky(affectedBySky)
     , m_IsNormal(isNormal)
 {
+	m_InstancedShader = ShaderLibrary::GetBasicInstancedShader();
 	m_DiffuseImageFile = ResourceLoader::CreateImageResourceFile(imagePath);
 	setTexture(m_DiffuseImageFile);
 	if (isNormal)
@@ -47,12 +48,12 @@ BasicMaterial::BasicMaterial(bool isAlpha, const String& imagePath, const String
 
 void BasicMaterial::setPSConstantBuffer(const PSDiffuseConstantBufferMaterial& constantBuffer)
 {
-	Material::SetPSConstantBuffer<PSDiffuseConstantBufferMaterial>(constantBuffer, m_PSConstantBuffer[(int)PixelConstantBufferType::Material], PER_OBJECT_PS_CPP);
+	Material::SetTransientPSConstantBuffer<PSDiffuseConstantBufferMaterial>(constantBuffer, m_PSConstantBuffer[(int)PixelConstantBufferType::Material], PER_OBJECT_PS_CPP);
 }
 
 void BasicMaterial::setVSConstantBuffer(const VSDiffuseConstantBuffer& constantBuffer)
 {
-	Material::SetVSConstantBuffer<VSDiffuseConstantBuffer>(constantBuffer, m_VSConstantBuffer[(int)VertexConstantBufferType::Model], PER_OBJECT_VS_CPP);
+	Material::SetTransientVSConstantBuffer<VSDiffuseConstantBuffer>(constantBuffer, m_VSConstantBuffer[(int)VertexConstantBufferType::Model], PER_OBJECT_VS_CPP);
 }
 
 Material* BasicMaterial::CreateDefault()
@@ -134,8 +135,7 @@ void BasicMaterial::bind()
 		m_BasicShader->set(m_NormalTexture.get(), NORMAL_PS_CPP);
 	}
 	m_BasicShader->set(m_SpecularTexture.get(), SPECULAR_PS_CPP);
-	Matrix currentModelMatrix = RenderSystem::GetSingleton()->getCurrentMatrix();
-	setVSConstantBuffer(VSDiffuseConstantBuffer(currentModelMatrix));
+	bindObject();
 
 	PSDiffuseConstantBufferMaterial objectPSCB;
 	objectPSCB.affectedBySky = m_IsAffectedBySky;
@@ -151,6 +151,12 @@ void BasicMaterial::bind()
 	setPSConstantBuffer(objectPSCB);
 }
 
+void BasicMaterial::bindObject()
+{
+	Matrix currentModelMatrix = RenderSystem::GetSingleton()->getCurrentMatrix();
+	setVSConstantBuffer(VSDiffuseConstantBuffer(currentModelMatrix));
+}
+
 JSON::json BasicMaterial::getJSON() const
 {
 	JSON::json& j = Material::getJSON();
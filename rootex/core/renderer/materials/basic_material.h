@@ -1,6 +1,7 @@
 #pragma once
 
 #include "renderer/material.h"
+#include "core/resource_handle.h"
 
 class Texture;
 
@@ -12,9 +13,9 @@ class BasicMaterial : public Material
 	Ref<Texture> m_SpecularTexture;
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> m_SamplerState;
 
-	ImageResourceFile* m_DiffuseImageFile;
-	ImageResourceFile* m_NormalImageFile;
-	ImageResourceFile* m_SpecularImageFile;
+	ResourceHandle<ImageResourceFile> m_DiffuseImageFile;
+	ResourceHandle<ImageResourceFile> m_NormalImageFile;
+	ResourceHandle<ImageResourceFile> m_SpecularImageFile;
 
 	bool m_IsLit;
 	bool m_IsNormal;
@@ -66,6 +67,7 @@ public:
 	virtual ID3D11ShaderResourceView* getPreview() override;
 
 	void bind() override;
+	void bindObject() override;
 	JSON::json getJSON() const override;
 
 #ifdef ROOTEX_EDITOR
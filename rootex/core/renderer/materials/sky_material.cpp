@@ -26,7 +26,7 @@ SkyMaterial::SkyMaterial(const String& imagePath)
 
 void SkyMaterial::setVSConstantBuffer(const VSDiffuseConstantBuffer& constantBuffer)
 {
-	Material::SetVSConstantBuffer<VSDiffuseConstantBuffer>(constantBuffer, m_VSConstantBuffer[(int)VertexConstantBufferType::Model], PER_OBJECT_VS_CPP);
+	Material::SetTransientVSConstantBuffer<VSDiffuseConstantBuffer>(constantBuffer, m_VSConstantBuffer[(int)VertexConstantBufferType::Model], PER_OBJECT_VS_CPP);
 }
 
 Material* SkyMaterial::CreateDefault()
@@ -43,6 +43,11 @@ void SkyMaterial::bind()
 {
 	Material::bind();
 	m_SkyShader->setSkyTexture(m_SkyTexture.get());
+	bindObject();
+}
+
+void SkyMaterial::bindObject()
+{
 	setVSConstantBuffer(VSDiffuseConstantBuffer(Matrix::CreateTranslation(RenderSystem::GetSingleton()->getCamera()->getOwner()->getComponent<TransformComponent>()->getAbsoluteTransform().Translation())));
 }
 
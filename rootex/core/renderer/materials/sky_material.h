@@ -39,6 +39,7 @@ public:
 	static Material* Create(const JSON::json& materialData);
 
 	void bind() override;
+	void bindObject() override;
 	JSON::json getJSON() const override;
 
 #ifdef ROOTEX_EDITOR
@@ -9,6 +9,8 @@ struct Mesh
 {
 	Ref<VertexBuffer> m_VertexBuffer;
 	Ref<IndexBuffer> m_IndexBuffer;
+	/// Bounds of the vertices in model space
+	BoundingBox m_BoundingBox;
 
 	Mesh() = default;
 	Mesh(const Mesh&) = default;
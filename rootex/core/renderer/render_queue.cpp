@@ -0,0 +1,130 @@
+#include "render_queue.h"
+
+#define RENDER_QUEUE_PASS_BITS 4
+#define RENDER_QUEUE_SHADER_BITS 10
+#define RENDER_QUEUE_MATERIAL_BITS 25
+#define RENDER_QUEUE_DEPTH_BITS 24
+
+/// Render passes are single bit flags, keys store the index of the bit.
+static unsigned int GetPassIndex(unsigned int renderPass)
+{
+	unsigned int passIndex = 0;
+	while ((renderPass >> (passIndex + 1)) != 0)
+	{
+		passIndex++;
+	}
+	return passIndex;
+}
+
+uint64_t RenderQueue::MakeKey(unsigned int renderPass, bool isAlpha, unsigned int shaderID, unsigned int materialID, float depth)
+{
+	unsigned int passIndex = GetPassIndex(renderPass);
+
+	// Bit patterns of non-negative floats sort the same as their values, keep the most significant bits
+	uint32_t depthBits = 0;
+	depth = std::max(depth, 0.0f);
+	memcpy(&depthBits, &depth, sizeof(depthBits));
+	uint64_t quantizedDepth = depthBits >> (32 - RENDER_QUEUE_DEPTH_BITS);
+
+	uint64_t shader = shaderID & ((1ull << RENDER_QUEUE_SHADER_BITS) - 1);
+	uint64_t material = materialID & ((1ull << RENDER_QUEUE_MATERIAL_BITS) - 1);
+
+	uint64_t key = (uint64_t)(passIndex & ((1u << RENDER_QUEUE_PASS_BITS) - 1)) << (64 - RENDER_QUEUE_PASS_BITS);
+	if (isAlpha)
+	{
+		uint64_t backToFront = ((1ull << RENDER_QUEUE_DEPTH_BITS) - 1) - quantizedDepth;
+		key |= 1ull << (63 - RENDER_QUEUE_PASS_BITS);
+		key |= backToFront << (RENDER_QUEUE_SHADER_BITS + RENDER_QUEUE_MATERIAL_BITS);
+		key |= shader << RENDER_QUEUE_MATERIAL_BITS;
+		key |= material;
+	}
+	else
+	{
+		key |= shader << (RENDER_QUEUE_MATERIAL_BITS + RENDER_QUEUE_DEPTH_BITS);
+		key |= material << RENDER_QUEUE_DEPTH_BITS;
+		key |= quantizedDepth;
+	}
+	return key;
+}
+
+bool RenderQueue::IsAlpha(uint64_t key)
+{
+	return (key >> (63 - RENDER_QUEUE_PASS_BITS)) & 1;
+}
+
+Pair<int, int> RenderQueue::getPassRange(unsigned int renderPass) const
+{
+	uint64_t passBegin = (uint64_t)GetPassIndex(renderPass) << (64 - RENDER_QUEUE_PASS_BITS);
+	uint64_t passEnd = passBegin + (1ull << (64 - RENDER_QUEUE_PASS_BITS));
+	auto compare = [](const DrawCommand& command, uint64_t key) { return command.m_Key < key; };
+	auto begin = std::lower_bound(m_Commands.begin(), m_Commands.end(), passBegin, compare);
+	auto end = passEnd == 0 ? m_Commands.end() : std::lower_bound(begin, m_Commands.end(), passEnd, compare);
+	return { (int)(begin - m_Commands.begin()), (int)(end - m_Commands.begin()) };
+}
+
+void RenderQueue::sort()
+{
+	if (m_Commands.size() < 2)
+	{
+		return;
+	}
+
+	// Histograms of all 8 bytes in a single pass
+	unsigned int counts[8][256] = {};
+	for (auto& command : m_Commands)
+	{
+		for (int byte = 0; byte < 8; byte++)
+		{
+			counts[byte][(command.m_Key >> (byte * 8)) & 0xFF]++;
+		}
+	}
+
+	m_SortBuffer.resize(m_Commands.size());
+	for (int byte = 0; byte < 8; byte++)
+	{
+		unsigned int* count = counts[byte];
+		if (count[(m_Commands.front().m_Key >> (byte * 8)) & 0xFF] == m_Commands.size())
+		{
+			continue;
+		}
+
+		unsigned int offsets[256];
+		unsigned int offset = 0;
+		for (int digit = 0; digit < 256; digit++)
+		{
+			offsets[digit] = offset;
+			offset += count[digit];
+		}
+
+		for (auto& command : m_Commands)
+		{
+			m_SortBuffer[offsets[(command.m_Key >> (byte * 8)) & 0xFF]++] = command;
+		}
+		m_Commands.swap(m_SortBuffer);
+	}
+
+	// Within a run of opaque draws with the same shader and material, front to back order only matters for overdraw.
+	// Bring identical meshes together instead, keeping the depth order between draws of the same mesh.
+	auto meshLess = [](const DrawCommand& a, const DrawCommand& b) {
+		if (a.m_VertexBuffer != b.m_VertexBuffer)
+		{
+			return std::less<const VertexBuffer*>()(a.m_VertexBuffer, b.m_VertexBuffer);
+		}
+		return std::less<const IndexBuffer*>()(a.m_IndexBuffer, b.m_IndexBuffer);
+	};
+	int runBegin = 0;
+	while (runBegin < m_Commands.size())
+	{
+		uint64_t runKey = m_Commands[runBegin].m_Key >> RENDER_QUEUE_DEPTH_BITS;
+		int runEnd = runBegin + 1;
+		while (runEnd < m_Commands.size() && (m_Commands[runEnd].m_Key >> RENDER_QUEUE_DEPTH_BITS) == runKey)
+		{
+			runEnd++;
+		}
+		if (runEnd - runBegin > 1 && !IsAlpha(m_Commands[runBegin].m_Key))
+		{
+			std::stable_sort(m_Commands.begin() + runBegin, m_Commands.begin() + runEnd, meshLess);
+		}
+		runBegin = runEnd;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/common.h"
+
+class Material;
+class VertexBuffer;
+class IndexBuffer;
+
+/// A single draw of a mesh with a material, ordered by its sort key.
+struct DrawCommand
+{
+	uint64_t m_Key;
+	Material* m_Material;
+	const VertexBuffer* m_VertexBuffer;
+	const IndexBuffer* m_IndexBuffer;
+	/// Index of the object issuing the draw, in a table kept by the submitter.
+	int m_Object;
+};
+
+/// Collects the draws of a frame as packed 64 bit sort keys and radix sorts them,
+/// so that draws sharing a shader and material end up next to each other and binds can be skipped.
+class RenderQueue
+{
+	Vector<DrawCommand> m_Commands;
+	Vector<DrawCommand> m_SortBuffer;
+
+public:
+	/// Pack a sort key. From the most significant bits: render pass, translucency, then shader, material and front to back depth
+	/// for opaque draws, or back to front depth, shader and material for translucent draws.
+	/// depth is any non-negative value growing with distance from the camera.
+	static uint64_t MakeKey(unsigned int renderPass, bool isAlpha, unsigned int shaderID, unsigned int materialID, float depth);
+	static bool IsAlpha(uint64_t key);
+
+	RenderQueue() = default;
+	RenderQueue(RenderQueue&) = delete;
+	~RenderQueue() = default;
+
+	/// Returns the first and one past the last index of the sorted commands in a render pass.
+	Pair<int, int> getPassRange(unsigned int renderPass) const;
+
+	void clear() { m_Commands.clear(); }
+	void push(const DrawCommand& command) { m_Commands.push_back(command); }
+	/// Stable least significant digit radix sort on the keys. Passes over bytes that are equal in every key are skipped.
+	/// Opaque draws sharing a shader and material are then grouped by mesh, so repeated meshes can be drawn instanced.
+	void sort();
+
+	const Vector<DrawCommand>& getCommands() const { return m_Commands; }
+};
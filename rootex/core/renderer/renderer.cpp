@@ -10,6 +10,9 @@
 #include "shader_library.h"
 
 Renderer::Renderer()
+    : m_BoundMaterial(nullptr)
+    , m_BoundVertexBuffer(nullptr)
+    , m_BoundIndexBuffer(nullptr)
 {
 	RenderingDevice::GetSingleton()->setPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 }
@@ -22,12 +25,104 @@ void Renderer::setViewport(Viewport& viewport)
 void Renderer::bind(Material* material) const
 {
 	material->bind();
+	m_BoundMaterial = material;
+	m_Counters.m_MaterialBinds++;
+}
+
+void Renderer::bindIfChanged(Material* material) const
+{
+	if (material != m_BoundMaterial)
+	{
+		bind(material);
+		return;
+	}
+	material->bindObject();
+	m_Counters.m_SkippedMaterialBinds++;
+}
+
+void Renderer::bindInstanced(Material* material) const
+{
+	bindInstanced(material, material->getInstancedShader());
+}
+
+void Renderer::bindInstanced(Material* material, const Shader* instancedShader) const
+{
+	material->bind();
+	instancedShader->bind();
+	// The regular shader is no longer bound, so the next regular draw has to bind the material again
+	m_BoundMaterial = nullptr;
+	m_Counters.m_MaterialBinds++;
 }
 
 void Renderer::draw(const VertexBuffer* vertexBuffer, const IndexBuffer* indexBuffer) const
 {
-	vertexBuffer->bind();
-	indexBuffer->bind();
+	if (vertexBuffer != m_BoundVertexBuffer)
+	{
+		vertexBuffer->bind();
+		m_BoundVertexBuffer = vertexBuffer;
+		m_Counters.m_BufferBinds++;
+	}
+	else
+	{
+		m_Counters.m_SkippedBufferBinds++;
+	}
+
+	if (indexBuffer != m_BoundIndexBuffer)
+	{
+		indexBuffer->bind();
+		m_BoundIndexBuffer = indexBuffer;
+		m_Counters.m_BufferBinds++;
+	}
+	else
+	{
+		m_Counters.m_SkippedBufferBinds++;
+	}
 
 	RenderingDevice::GetSingleton()->drawIndexed(indexBuffer->getCount());
+	m_Counters.m_Draws++;
+}
+
+void Renderer::drawInstanced(const VertexBuffer* vertexBuffer, const IndexBuffer* indexBuffer, const InstanceBuffer* instanceBuffer, unsigned int instanceCount, unsigned int startInstance) const
+{
+	if (vertexBuffer != m_BoundVertexBuffer)
+	{
+		vertexBuffer->bind();
+		m_BoundVertexBuffer = vertexBuffer;
+		m_Counters.m_BufferBinds++;
+	}
+	else
+	{
+		m_Counters.m_SkippedBufferBinds++;
+	}
+
+	if (indexBuffer != m_BoundIndexBuffer)
+	{
+		indexBuffer->bind();
+		m_BoundIndexBuffer = indexBuffer;
+		m_Counters.m_BufferBinds++;
+	}
+	else
+	{
+		m_Counters.m_SkippedBufferBinds++;
+	}
+
+	instanceBuffer->bind();
+	RenderingDevice::GetSingleton()->drawIndexedInstanced(indexBuffer->getCount(), instanceCount, startInstance);
+	m_Counters.m_Draws++;
+	m_Counters.m_InstancedDraws++;
+	m_Counters.m_Instances += instanceCount;
+}
+
+void Renderer::resetBindCache() const
+{
+	m_BoundMaterial = nullptr;
+	m_BoundVertexBuffer = nullptr;
+	m_BoundIndexBuffer = nullptr;
+}
+
+void Renderer::resetCounters()
+{
+	m_LastFrameCounters = m_Counters;
+	m_Counters = RenderCounters();
+	resetBindCache();
 }
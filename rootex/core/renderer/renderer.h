@@ -6,9 +6,34 @@
 #include "rendering_device.h"
 #include "viewport.h"
 
+/// Number of binds and draws issued through a Renderer in a frame.
+struct RenderCounters
+{
+	int m_MaterialBinds = 0;
+	/// Material binds avoided because the material was already bound. Only per object constant buffers were uploaded.
+	int m_SkippedMaterialBinds = 0;
+	int m_BufferBinds = 0;
+	int m_SkippedBufferBinds = 0;
+	int m_Draws = 0;
+	/// Instanced draws issued, each also counted in m_Draws.
+	int m_InstancedDraws = 0;
+	/// Models drawn through instanced draws.
+	int m_Instances = 0;
+	/// Draws with an instanced shader that were drawn on their own because no neighbouring draw could share their instanced draw.
+	int m_UnbatchedDraws = 0;
+};
+
 /// Makes the rendering draw call and set viewport, instrumental in seperating Game and HUD rendering
 class Renderer
 {
+	/// Last bound state, used to skip redundant binds.
+	mutable const Material* m_BoundMaterial;
+	mutable const VertexBuffer* m_BoundVertexBuffer;
+	mutable const IndexBuffer* m_BoundIndexBuffer;
+
+	mutable RenderCounters m_Counters;
+	RenderCounters m_LastFrameCounters;
+
 public:
 	Renderer();
 	Renderer(const Renderer&) = delete;
@@ -18,5 +43,23 @@ public:
 	void setViewport(Viewport& viewport);
 	
 	void bind(Material* material) const;
+	/// Bind a material, or only upload its per object constant buffers if it is already bound.
+	void bindIfChanged(Material* material) const;
+	/// Bind a material with its instanced shader in place of its regular one.
+	void bindInstanced(Material* material) const;
+	/// Bind a material with instancedShader in place of its regular shader.
+	void bindInstanced(Material* material, const Shader* instancedShader) const;
+	/// Draw with the given buffers. Buffers that are already bound are not bound again.
 	void draw(const VertexBuffer* vertexBuffer, const IndexBuffer* indexBuffer) const;
+	/// Draw instanceCount copies of the given buffers, reading per instance data from instanceBuffer starting at startInstance.
+	void drawInstanced(const VertexBuffer* vertexBuffer, const IndexBuffer* indexBuffer, const InstanceBuffer* instanceBuffer, unsigned int instanceCount, unsigned int startInstance) const;
+	/// Count draws that could have been instanced but were drawn on their own.
+	void countUnbatchedDraws(int count) const { m_Counters.m_UnbatchedDraws += count; }
+	/// Forget the last bound state. Call after binding pipeline state without going through the Renderer.
+	void resetBindCache() const;
+
+	/// Store the counters of the frame that just ended and start counting again.
+	void resetCounters();
+	/// Counters of the last completed frame.
+	const RenderCounters& getCounters() const { return m_LastFrameCounters; }
 };
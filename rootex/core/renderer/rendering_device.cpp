@@ -81,6 +81,14 @@ void RenderingDevice::initialize(HWND hWnd, int width, int height, bool MSAA)
 	    + FEATURE_STRING(features, SAD4ShaderInstructions)
 	    + FEATURE_STRING(features, UAVOnlyRenderingForcedSampleCount));
 
+	if (features.ConstantBufferOffsetting && features.MapNoOverwriteOnDynamicConstantBuffer)
+	{
+		if (FAILED(m_Context.As(&m_Context1)))
+		{
+			m_Context1 = nullptr;
+		}
+	}
+
 	{
 		D3D11_DEPTH_STENCIL_DESC dsDesc = { 0 };
 		dsDesc.DepthEnable = TRUE;
@@ -346,9 +354,9 @@ void RenderingDevice::createSwapChainAndRTs(int width, int height, bool MSAA, co
 	GFX_ERR_CHECK(m_Device->CreateShaderResourceView(m_OffScreenRTTextureResolved.Get(), &shaderResourceViewDesc, &m_OffScreenRTSRVResolved));
 }
 
-Ref<DirectX::SpriteFont> RenderingDevice::createFont(FileBuffer* fontFileBuffer)
+Ref<DirectX::SpriteFont> RenderingDevice::createFont(const char* fontFileData, size_t size)
 {
-	return Ref<DirectX::SpriteFont>(new DirectX::SpriteFont(m_Device.Get(), (const uint8_t*)fontFileBuffer->data(), fontFileBuffer->size()));
+	return Ref<DirectX::SpriteFont>(new DirectX::SpriteFont(m_Device.Get(), (const uint8_t*)fontFileData, size));
 }
 
 Microsoft::WRL::ComPtr<ID3DBlob> RenderingDevice::createBlob(LPCWSTR path)
@@ -422,6 +430,26 @@ Microsoft::WRL::ComPtr<ID3D11Buffer> RenderingDevice::createIB(D3D11_BUFFER_DESC
 	return indexBuffer;
 }
 
+Microsoft::WRL::ComPtr<ID3D11Buffer> RenderingDevice::createSRB(D3D11_BUFFER_DESC* bd, D3D11_SUBRESOURCE_DATA* sd)
+{
+	Microsoft::WRL::ComPtr<ID3D11Buffer> buffer = nullptr;
+	GFX_ERR_CHECK(m_Device->CreateBuffer(bd, sd, &buffer));
+	return buffer;
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderingDevice::createSRBView(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT elementCount)
+{
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	srvDesc.Buffer.FirstElement = 0;
+	srvDesc.Buffer.NumElements = elementCount;
+
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv = nullptr;
+	GFX_ERR_CHECK(m_Device->CreateShaderResourceView(buffer, &srvDesc, &srv));
+	return srv;
+}
+
 Microsoft::WRL::ComPtr<ID3D11Buffer> RenderingDevice::createVSCB(D3D11_BUFFER_DESC* cbd, D3D11_SUBRESOURCE_DATA* csd)
 {
 	Microsoft::WRL::ComPtr<ID3D11Buffer> constantBuffer = nullptr;
@@ -474,7 +502,7 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderingDevice::createTexture(
 	Microsoft::WRL::ComPtr<ID3D11Resource> textureResource;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureView;
 
-	if (FAILED(DirectX::CreateWICTextureFromMemoryEx(m_Device.Get(), (const uint8_t*)imageRes->getData()->getRawData()->data(), (size_t)imageRes->getData()->getRawDataByteSize(), 0, D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, DirectX::WIC_LOADER_IGNORE_SRGB | DirectX::WIC_LOADER_FORCE_RGBA32, textureResource.GetAddressOf(), textureView.GetAddressOf())))
+	if (FAILED(DirectX::CreateWICTextureFromMemoryEx(m_Device.Get(), (const uint8_t*)imageRes->getData()->getData(), (size_t)imageRes->getData()->getRawDataByteSize(), 0, D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, DirectX::WIC_LOADER_IGNORE_SRGB | DirectX::WIC_LOADER_FORCE_RGBA32, textureResource.GetAddressOf(), textureView.GetAddressOf())))
 	{
 		ERR("Could not create texture: " + imageRes->getPath().generic_string());
 	}
@@ -489,7 +517,7 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> RenderingDevice::createDDSTextu
 
 	if (FAILED(DirectX::CreateDDSTextureFromMemoryEx(
 		m_Device.Get(),
-		(const uint8_t*)imageRes->getData()->getRawData()->data(),
+		(const uint8_t*)imageRes->getData()->getData(),
 	        imageRes->getData()->getRawDataByteSize(), imageRes->getData()->getRawDataByteSize(), D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, D3D11_RESOURCE_MISC_TEXTURECUBE, false, &textureResource, &textureView)))
 	{
 		ERR("Could not load DDS image: " + imageRes->getPath().generic_string());
@@ -553,6 +581,11 @@ void RenderingDevice::bind(ID3D11Buffer* vertexBuffer, const unsigned int* strid
 	m_Context->IASetVertexBuffers(0u, 1u, &vertexBuffer, stride, offset);
 }
 
+void RenderingDevice::bindInstances(ID3D11Buffer* instanceBuffer, const unsigned int* stride, const unsigned int* offset)
+{
+	m_Context->IASetVertexBuffers(1u, 1u, &instanceBuffer, stride, offset);
+}
+
 void RenderingDevice::bind(ID3D11Buffer* indexBuffer, DXGI_FORMAT format)
 {
 	m_Context->IASetIndexBuffer(indexBuffer, format, 0u);
@@ -573,6 +606,23 @@ void RenderingDevice::bind(ID3D11InputLayout* inputLayout)
 	m_Context->IASetInputLayout(inputLayout);
 }
 
+void RenderingDevice::updateTextureRegion(ID3D11Texture2D* texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const char* pixels)
+{
+	D3D11_BOX box = { x, y, 0u, x + width, y + height, 1u };
+	m_Context->UpdateSubresource(texture, 0, &box, pixels, width * 4, 0);
+}
+
+void RenderingDevice::copyTextureRegion(ID3D11Texture2D* destination, unsigned int x, unsigned int y, ID3D11Texture2D* source)
+{
+	m_Context->CopySubresourceRegion(destination, 0, x, y, 0, source, 0, nullptr);
+}
+
+void RenderingDevice::copyTextureRegion(ID3D11Texture2D* destination, unsigned int x, unsigned int y, ID3D11Texture2D* source, unsigned int sourceX, unsigned int sourceY, unsigned int width, unsigned int height)
+{
+	D3D11_BOX box = { sourceX, sourceY, 0u, sourceX + width, sourceY + height, 1u };
+	m_Context->CopySubresourceRegion(destination, 0, x, y, 0, source, 0, &box);
+}
+
 void RenderingDevice::resolveSRV(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> source, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> destination)
 {
 	ID3D11Resource* destResource;
@@ -599,6 +649,14 @@ void RenderingDevice::mapBuffer(ID3D11Buffer* buffer, D3D11_MAPPED_SUBRESOURCE&
 	}
 }
 
+void RenderingDevice::mapBuffer(ID3D11Buffer* buffer, D3D11_MAPPED_SUBRESOURCE& subresource, D3D11_MAP mapType)
+{
+	if (FAILED(m_Context->Map(buffer, 0u, mapType, 0u, &subresource)))
+	{
+		ERR("Could not map to buffer");
+	}
+}
+
 //Assuming subresource offset = 0
 void RenderingDevice::unmapBuffer(ID3D11Buffer* buffer)
 {
@@ -625,6 +683,16 @@ void RenderingDevice::setPSCB(ID3D11Buffer* constantBuffer, UINT slot)
 	m_Context->PSSetConstantBuffers(slot, 1u, &constantBuffer);
 }
 
+void RenderingDevice::setVSCB(ID3D11Buffer* constantBuffer, UINT slot, UINT firstConstant, UINT constantCount)
+{
+	m_Context1->VSSetConstantBuffers1(slot, 1u, &constantBuffer, &firstConstant, &constantCount);
+}
+
+void RenderingDevice::setPSCB(ID3D11Buffer* constantBuffer, UINT slot, UINT firstConstant, UINT constantCount)
+{
+	m_Context1->PSSetConstantBuffers1(slot, 1u, &constantBuffer, &firstConstant, &constantCount);
+}
+
 void RenderingDevice::unbindRTSRVs()
 {
 	ID3D11ShaderResourceView* nullSRV[2] = { nullptr, nullptr };
@@ -794,6 +862,16 @@ void RenderingDevice::drawIndexed(UINT number)
 	m_Context->DrawIndexed(number, 0u, 0u);
 }
 
+void RenderingDevice::drawIndexed(UINT number, UINT startIndex, INT baseVertex)
+{
+	m_Context->DrawIndexed(number, startIndex, baseVertex);
+}
+
+void RenderingDevice::drawIndexedInstanced(UINT number, UINT instanceCount, UINT startInstance)
+{
+	m_Context->DrawIndexedInstanced(number, instanceCount, 0u, 0, startInstance);
+}
+
 void RenderingDevice::beginDrawUI()
 {
 	m_FontBatch->Begin();
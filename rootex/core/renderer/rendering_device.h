@@ -3,6 +3,7 @@
 #include "common/common.h"
 
 #include <d3d11.h>
+#include <d3d11_1.h>
 
 #include <d3dcompiler.h>
 #include <string>
@@ -28,6 +29,8 @@ public:
 private:
 	Microsoft::WRL::ComPtr<ID3D11Device> m_Device;
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_Context;
+	/// Only available where constant buffers can be bound with offsets.
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> m_Context1;
 	
 	HWND m_WindowHandle;
 
@@ -91,11 +94,14 @@ public:
 	Microsoft::WRL::ComPtr<ID3D11Buffer> createIB(D3D11_BUFFER_DESC* ibd, D3D11_SUBRESOURCE_DATA* isd, DXGI_FORMAT format);
 	Microsoft::WRL::ComPtr<ID3D11Buffer> createVSCB(D3D11_BUFFER_DESC* cbd, D3D11_SUBRESOURCE_DATA* csd);
 	Microsoft::WRL::ComPtr<ID3D11Buffer> createPSCB(D3D11_BUFFER_DESC* cbd, D3D11_SUBRESOURCE_DATA* csd);
+	/// Buffer read by shaders through a typed Buffer resource
+	Microsoft::WRL::ComPtr<ID3D11Buffer> createSRB(D3D11_BUFFER_DESC* bd, D3D11_SUBRESOURCE_DATA* sd);
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> createSRBView(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT elementCount);
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> createPS(ID3DBlob* blob);
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> createVS(ID3DBlob* blob);
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> createVL(ID3DBlob* vertexShaderBlob, const D3D11_INPUT_ELEMENT_DESC* ied, UINT size);
 
-	Ref<DirectX::SpriteFont> createFont(FileBuffer* fontFileBuffer);
+	Ref<DirectX::SpriteFont> createFont(const char* fontFileData, size_t size);
 	/// To hold shader blobs loaded from the compiled shader files
 	Microsoft::WRL::ComPtr<ID3DBlob> createBlob(LPCWSTR path);
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> createTexture(ImageResourceFile* imageRes);
@@ -109,10 +115,19 @@ public:
 	void bind(ID3D11VertexShader* vertexShader);
 	void bind(ID3D11PixelShader* pixelShader);
 	void bind(ID3D11InputLayout* inputLayout);
+	/// Binds a per instance vertex buffer to input slot 1
+	void bindInstances(ID3D11Buffer* instanceBuffer, const unsigned int* stride, const unsigned int* offset);
 
 	void resolveSRV(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> source, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> destination);
+	/// Write tightly packed RGBA pixels into the rectangle at x, y of the top mip of a texture
+	void updateTextureRegion(ID3D11Texture2D* texture, unsigned int x, unsigned int y, unsigned int width, unsigned int height, const char* pixels);
+	/// Copy the top mip of source into destination with its top left corner at x, y
+	void copyTextureRegion(ID3D11Texture2D* destination, unsigned int x, unsigned int y, ID3D11Texture2D* source);
+	/// Copy the rectangle at sourceX, sourceY of the top mip of source into destination with its top left corner at x, y. The textures must be different
+	void copyTextureRegion(ID3D11Texture2D* destination, unsigned int x, unsigned int y, ID3D11Texture2D* source, unsigned int sourceX, unsigned int sourceY, unsigned int width, unsigned int height);
 
 	void mapBuffer(ID3D11Buffer* buffer, D3D11_MAPPED_SUBRESOURCE& subresource);
+	void mapBuffer(ID3D11Buffer* buffer, D3D11_MAPPED_SUBRESOURCE& subresource, D3D11_MAP mapType);
 	void unmapBuffer(ID3D11Buffer* buffer);
 	
 	/// Binds textures used in Pixel Shader
@@ -122,6 +137,11 @@ public:
 	
 	void setVSCB(ID3D11Buffer* constantBuffer, UINT slot);
 	void setPSCB(ID3D11Buffer* constantBuffer, UINT slot);
+	/// Bind constantCount constants of 16 bytes starting at firstConstant. Requires isConstantBufferOffsetSupported().
+	void setVSCB(ID3D11Buffer* constantBuffer, UINT slot, UINT firstConstant, UINT constantCount);
+	void setPSCB(ID3D11Buffer* constantBuffer, UINT slot, UINT firstConstant, UINT constantCount);
+	/// Whether parts of a larger constant buffer can be bound and appended to with no overwrite maps.
+	bool isConstantBufferOffsetSupported() const { return m_Context1 != nullptr; }
 
 	void unbindShaderResources();
 
@@ -158,6 +178,10 @@ public:
 	
 	/// The last boss, draws Triangles
 	void drawIndexed(UINT number);
+	/// Draw number indices starting at startIndex, adding baseVertex to every index.
+	void drawIndexed(UINT number, UINT startIndex, INT baseVertex);
+	/// Draws instanceCount copies of the indexed geometry, reading instances from startInstance onwards
+	void drawIndexedInstanced(UINT number, UINT instanceCount, UINT startInstance);
 	
 	void beginDrawUI();
 	void endDrawUI();
@@ -0,0 +1,48 @@
+#include "ring_allocator.h"
+
+RingAllocator::RingAllocator(size_t capacity, size_t alignment)
+    : m_Capacity(AlignUp(capacity, alignment))
+    , m_Alignment(alignment)
+    , m_Head(0)
+    , m_FrameBegin(0)
+    , m_LastFrameBytes(0)
+    , m_OverflowBytes(0)
+{
+}
+
+bool RingAllocator::beginFrame()
+{
+	m_LastFrameBytes = m_Head - m_FrameBegin + m_OverflowBytes;
+	m_OverflowBytes = 0;
+
+	// Assume the next frame allocates as much as the last one
+	bool isWrapped = m_Head != 0 && m_Head + m_LastFrameBytes > m_Capacity;
+	if (isWrapped)
+	{
+		m_Head = 0;
+	}
+	m_FrameBegin = m_Head;
+	return isWrapped;
+}
+
+size_t RingAllocator::allocate(size_t size)
+{
+	size_t alignedSize = AlignUp(size, m_Alignment);
+	if (m_Head + alignedSize > m_Capacity)
+	{
+		m_OverflowBytes += alignedSize;
+		return InvalidOffset;
+	}
+
+	size_t offset = m_Head;
+	m_Head += alignedSize;
+	return offset;
+}
+
+void RingAllocator::resize(size_t capacity)
+{
+	m_Capacity = AlignUp(capacity, m_Alignment);
+	m_Head = 0;
+	m_FrameBegin = 0;
+	m_OverflowBytes = 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+/// Sub-allocates aligned ranges from a ring of fixed capacity, one frame after another.
+/// Allocations never wrap in the middle of a frame, so everything allocated in a frame stays valid until the frame ends.
+/// The ring only wraps back to its start at the beginning of a frame that may not fit in the remaining space.
+/// Only offsets are handed out, the memory itself is owned by the caller, so the allocator has no rendering device dependency.
+class RingAllocator
+{
+	size_t m_Capacity;
+	size_t m_Alignment;
+	size_t m_Head;
+	size_t m_FrameBegin;
+	/// Bytes requested in the last completed frame, including the ones that did not fit. Used to predict whether the next frame fits.
+	size_t m_LastFrameBytes;
+	/// Bytes that could not be allocated in the current frame.
+	size_t m_OverflowBytes;
+
+public:
+	/// Returned by allocate() when the rest of the frame does not fit in the ring.
+	static const size_t InvalidOffset = (size_t)-1;
+
+	static size_t AlignUp(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+
+	/// alignment is the granularity of every allocation.
+	RingAllocator(size_t capacity, size_t alignment);
+	RingAllocator(const RingAllocator&) = delete;
+	~RingAllocator() = default;
+
+	/// Start a new frame. Returns true if the ring wrapped back to its start, so the memory of earlier frames is reused.
+	bool beginFrame();
+	/// Reserve size bytes rounded up to the alignment. Returns the offset of the range, or InvalidOffset if the ring is full.
+	size_t allocate(size_t size);
+	/// Change the capacity and release all allocations.
+	void resize(size_t capacity);
+
+	size_t getCapacity() const { return m_Capacity; }
+	size_t getAlignment() const { return m_Alignment; }
+	/// Bytes allocated since the current frame began.
+	size_t getFrameBytes() const { return m_Head - m_FrameBegin; }
+	size_t getLastFrameBytes() const { return m_LastFrameBytes; }
+	size_t getOverflowBytes() const { return m_OverflowBytes; }
+};
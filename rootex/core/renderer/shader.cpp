@@ -5,7 +5,8 @@
 #include "shaders/register_locations_pixel_shader.h"
 
 Shader::Shader(const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, const BufferFormat& vertexBufferFormat)
-    : m_VertexPath(vertexPath)
+    : m_ID(s_NextID++)
+    , m_VertexPath(vertexPath)
     , m_PixelPath(pixelPath)
 {
 	Microsoft::WRL::ComPtr<ID3DBlob> vertexShaderBlob = RenderingDevice::GetSingleton()->createBlob(vertexPath);
@@ -25,12 +26,20 @@ Shader::Shader(const LPCWSTR& vertexPath, const LPCWSTR& pixelPath, const Buffer
 	const Vector<VertexBufferElement>& elements = vertexBufferFormat.getElements();
 
 	Vector<D3D11_INPUT_ELEMENT_DESC> vertexDescArray;
-	unsigned int offset = 0;
+	unsigned int offsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
 	for (auto& element : elements)
 	{
 		D3D11_INPUT_ELEMENT_DESC desc;
-		desc = { element.m_Name, 0, (DXGI_FORMAT)element.m_Type, 0, offset, D3D11_INPUT_PER_VERTEX_DATA, 0 };
-		offset += VertexBufferElement::GetSize(element.m_Type);
+		desc = {
+			element.m_Name,
+			element.m_SemanticIndex,
+			(DXGI_FORMAT)element.m_Type,
+			element.m_Slot,
+			offsets[element.m_Slot],
+			element.m_IsPerInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA,
+			element.m_IsPerInstance ? 1u : 0u
+		};
+		offsets[element.m_Slot] += VertexBufferElement::GetSize(element.m_Type);
 
 		vertexDescArray.push_back(desc);
 	}
@@ -15,7 +15,11 @@ public:
 		Pixel
 	};
 
+	static inline unsigned int s_NextID = 0;
+
 protected:
+	/// Unique ID used to order draws by shader.
+	unsigned int m_ID;
 	LPCWSTR m_VertexPath;
 	LPCWSTR m_PixelPath;
 
@@ -31,6 +35,8 @@ public:
 	virtual ~Shader();
 
 	virtual void bind() const;
+
+	unsigned int getID() const { return m_ID; }
 };
 
 class ColorShader : public Shader
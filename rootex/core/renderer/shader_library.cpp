@@ -15,8 +15,12 @@ Shader* ShaderLibrary::MakeShader(ShaderType shaderType, const LPCWSTR& vertexPa
 	switch (shaderType)
 	{
 	case ShaderLibrary::ShaderType::Basic:
+	case ShaderLibrary::ShaderType::BasicInstanced:
 		newShader = new BasicShader(vertexPath, pixelPath, vertexBufferFormat);
 		break;
+	case ShaderLibrary::ShaderType::CPUParticles:
+		newShader = new CPUParticlesShader(vertexPath, pixelPath, vertexBufferFormat);
+		break;
 	case ShaderLibrary::ShaderType::Sky:
 		newShader = new SkyShader(vertexPath, pixelPath, vertexBufferFormat);
 		break;
@@ -37,6 +41,19 @@ void ShaderLibrary::MakeShaders()
 		WARN("Tried constructing already constructed shader objects. Operation ignored");
 		return;
 	}
+	{
+		BufferFormat particlesBufferFormat;
+		particlesBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "POSITION");
+		particlesBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "NORMAL");
+		particlesBufferFormat.push(VertexBufferElement::Type::FloatFloat, "TEXCOORD");
+		particlesBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "TANGENT");
+		for (unsigned int row = 0; row < 3; row++)
+		{
+			particlesBufferFormat.pushInstance(VertexBufferElement::Type::FloatFloatFloatFloat, "INSTANCE_TRANSFORM", row);
+		}
+		particlesBufferFormat.pushInstance(VertexBufferElement::Type::FloatFloatFloatFloat, "INSTANCE_COLOR", 0);
+		MakeShader(ShaderType::CPUParticles, L"rootex/assets/shaders/cpu_particles_vertex_shader.cso", L"rootex/assets/shaders/cpu_particles_pixel_shader.cso", particlesBufferFormat);
+	}
 	{
 		BufferFormat basicBufferFormat;
 		basicBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "POSITION");
@@ -44,6 +61,17 @@ void ShaderLibrary::MakeShaders()
 		basicBufferFormat.push(VertexBufferElement::Type::FloatFloat, "TEXCOORD");
 		basicBufferFormat.push(VertexBufferElement::Type::FloatFloatFloat, "TANGENT");
 		MakeShader(ShaderType::Basic, L"rootex/assets/shaders/basic_vertex_shader.cso", L"rootex/assets/shaders/basic_pixel_shader.cso", basicBufferFormat);
+
+		for (unsigned int row = 0; row < 4; row++)
+		{
+			basicBufferFormat.pushInstance(VertexBufferElement::Type::FloatFloatFloatFloat, "INSTANCE_TRANSFORM", row);
+		}
+		for (unsigned int row = 0; row < 4; row++)
+		{
+			basicBufferFormat.pushInstance(VertexBufferElement::Type::FloatFloatFloatFloat, "INSTANCE_INVERSE_TRANSPOSE", row);
+		}
+		basicBufferFormat.pushInstance(VertexBufferElement::Type::UintUint, "INSTANCE_STATIC_LIGHTS", 0);
+		MakeShader(ShaderType::BasicInstanced, L"rootex/assets/shaders/basic_instanced_vertex_shader.cso", L"rootex/assets/shaders/basic_instanced_pixel_shader.cso", basicBufferFormat);
 	}
 	{
 		BufferFormat skyFormat;
@@ -62,7 +90,17 @@ BasicShader* ShaderLibrary::GetBasicShader()
 	return reinterpret_cast<BasicShader*>(s_Shaders[ShaderType::Basic].get());
 }
 
+BasicShader* ShaderLibrary::GetBasicInstancedShader()
+{
+	return reinterpret_cast<BasicShader*>(s_Shaders[ShaderType::BasicInstanced].get());
+}
+
 SkyShader* ShaderLibrary::GetSkyShader()
 {
 	return reinterpret_cast<SkyShader*>(s_Shaders[ShaderType::Sky].get());
 }
+
+CPUParticlesShader* ShaderLibrary::GetCPUParticlesShader()
+{
+	return reinterpret_cast<CPUParticlesShader*>(s_Shaders[ShaderType::CPUParticles].get());
+}
@@ -9,6 +9,8 @@ class ShaderLibrary
 	enum class ShaderType
 	{
 		Basic,
+		BasicInstanced,
+		CPUParticles,
 		Sky
 	};
 
@@ -26,5 +28,9 @@ public:
 	static void DestroyShaders();
 
 	static BasicShader* GetBasicShader();
+	/// Basic shader reading model transforms from a per instance buffer instead of a constant buffer.
+	static BasicShader* GetBasicInstancedShader();
 	static SkyShader* GetSkyShader();
+	/// Shader drawing all particles of an emitter in one instanced draw, with a transform and color per particle.
+	static CPUParticlesShader* GetCPUParticlesShader();
 };
@@ -0,0 +1,44 @@
+#include "shader_resource_buffer.h"
+
+#include "rendering_device.h"
+
+ShaderResourceBuffer::ShaderResourceBuffer(DXGI_FORMAT format, unsigned int stride)
+    : m_Format(format)
+    , m_Stride(stride)
+    , m_Capacity(0)
+{
+}
+
+void ShaderResourceBuffer::setData(const void* data, unsigned int count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (count > m_Capacity)
+	{
+		m_Capacity = std::max(count, m_Capacity * 2);
+
+		D3D11_BUFFER_DESC bd = { 0 };
+		bd.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		bd.MiscFlags = 0u;
+		bd.ByteWidth = m_Stride * m_Capacity;
+		bd.StructureByteStride = 0u;
+
+		m_Buffer = RenderingDevice::GetSingleton()->createSRB(&bd, nullptr);
+		m_View = RenderingDevice::GetSingleton()->createSRBView(m_Buffer.Get(), m_Format, m_Capacity);
+	}
+
+	D3D11_MAPPED_SUBRESOURCE subresource;
+	RenderingDevice::GetSingleton()->mapBuffer(m_Buffer.Get(), subresource);
+	memcpy(subresource.pData, data, m_Stride * count);
+	RenderingDevice::GetSingleton()->unmapBuffer(m_Buffer.Get());
+}
+
+void ShaderResourceBuffer::bind(unsigned int slot) const
+{
+	RenderingDevice::GetSingleton()->setInPixelShader(slot, 1, m_View.Get());
+}
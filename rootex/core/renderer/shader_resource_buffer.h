@@ -0,0 +1,26 @@
+#pragma once
+
+#include <d3d11.h>
+
+#include "common/common.h"
+
+/// Dynamic buffer of typed elements read by pixel shaders through a Buffer resource.
+/// Grows to fit the largest set of elements uploaded to it.
+class ShaderResourceBuffer
+{
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_Buffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_View;
+	DXGI_FORMAT m_Format;
+	unsigned int m_Stride;
+	unsigned int m_Capacity;
+
+public:
+	ShaderResourceBuffer(DXGI_FORMAT format, unsigned int stride);
+	~ShaderResourceBuffer() = default;
+
+	/// Replace the contents of the buffer with count elements of stride bytes each.
+	void setData(const void* data, unsigned int count);
+	/// Bind the buffer to a texture register of the pixel shader.
+	void bind(unsigned int slot) const;
+	unsigned int getCapacity() const { return m_Capacity; }
+};
@@ -0,0 +1,3 @@
+// The basic pixel shader, reading the static lights of each instance from StaticLightIndices instead of the per model constant buffer
+#define INSTANCED_STATIC_LIGHTS
+#include "basic_pixel_shader.hlsl"
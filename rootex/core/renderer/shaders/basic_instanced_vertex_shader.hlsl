@@ -0,0 +1,63 @@
+#include "register_locations_vertex_shader.h"
+
+cbuffer CBuf : register(PER_FRAME_VS_HLSL)
+{
+    matrix V;
+	float fogStart;
+	float fogEnd;
+};
+
+cbuffer CBuf : register(PER_CAMERA_CHANGE_VS_HLSL)
+{
+    matrix P;
+};
+
+struct VertexInputType
+{
+    float4 position : POSITION;
+    float2 tex : TEXCOORD0;
+    float4 normal : NORMAL;
+	float3 tangent : TANGENT;
+	float4 transform0 : INSTANCE_TRANSFORM0;
+	float4 transform1 : INSTANCE_TRANSFORM1;
+	float4 transform2 : INSTANCE_TRANSFORM2;
+	float4 transform3 : INSTANCE_TRANSFORM3;
+	float4 inverseTranspose0 : INSTANCE_INVERSE_TRANSPOSE0;
+	float4 inverseTranspose1 : INSTANCE_INVERSE_TRANSPOSE1;
+	float4 inverseTranspose2 : INSTANCE_INVERSE_TRANSPOSE2;
+	float4 inverseTranspose3 : INSTANCE_INVERSE_TRANSPOSE3;
+	uint2 staticLights : INSTANCE_STATIC_LIGHTS;
+};
+
+struct PixelInputType
+{
+    float4 screenPosition : SV_POSITION;
+    float3 normal : NORMAL;
+    float4 worldPosition : POSITION;
+    float2 tex : TEXCOORD0;
+	float fogFactor : FOG;
+	float3 tangent : TANGENT;
+	nointerpolation uint2 staticLights : STATIC_LIGHTS;
+};
+
+PixelInputType main(VertexInputType input)
+{
+    float4x4 M = float4x4(input.transform0, input.transform1, input.transform2, input.transform3);
+    float4x4 MInverseTranspose = float4x4(input.inverseTranspose0, input.inverseTranspose1, input.inverseTranspose2, input.inverseTranspose3);
+
+    PixelInputType output;
+    output.screenPosition = mul(input.position, mul(M, mul(V, P)));
+	output.normal = normalize(mul((float3)input.normal, (float3x3)MInverseTranspose));
+    output.worldPosition = mul(input.position, M);
+    output.tex.x = input.tex.x;
+    output.tex.y = 1 - input.tex.y;
+
+    output.tangent = mul(input.tangent, M);
+	
+    float4 cameraPosition = mul(input.position, mul(M, V));
+    output.fogFactor = saturate((fogEnd - cameraPosition.z) / (fogEnd - fogStart));
+
+    output.staticLights = input.staticLights;
+	
+	return output;
+}
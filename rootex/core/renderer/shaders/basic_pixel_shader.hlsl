@@ -18,6 +18,10 @@ struct PixelInputType
 	float2 tex : TEXCOORD0;
 	float fogFactor : FOG;
 	float3 tangent : TANGENT;
+#ifdef INSTANCED_STATIC_LIGHTS
+	/// Offset into StaticLightIndices and number of static lights affecting the instance
+	nointerpolation uint2 staticLights : STATIC_LIGHTS;
+#endif
 };
 
 cbuffer CBuf : register(PER_OBJECT_PS_HLSL)
@@ -25,11 +29,15 @@ cbuffer CBuf : register(PER_OBJECT_PS_HLSL)
     BasicMaterial material;
 };
 
+#ifdef INSTANCED_STATIC_LIGHTS
+Buffer<uint> StaticLightIndices : register(STATIC_LIGHT_INDICES_PS_HLSL);
+#else
 cbuffer CBuf : register(PER_MODEL_PS_HLSL)
 {
 	int staticPointLightAffectingCount = 0;
     int staticPointsLightsAffecting[MAX_STATIC_POINT_LIGHTS_AFFECTING_1_OBJECT];
 };
+#endif
 
 float4 main(PixelInputType input) : SV_TARGET
 {
@@ -54,21 +62,31 @@ float4 main(PixelInputType input) : SV_TARGET
     input.normal = lerp(input.normal, mul(uncompressedNormal, TBN), material.hasNormalMap);
 
     float3 specularColor = SpecularTexture.Sample(SampleType, input.tex).rgb;
-    for (int i = 0; i < pointLightCount; i++)
+    uint4 cluster = GetLightCluster(input.screenPosition);
+    for (uint light = 0; light < cluster.y; light++)
     {
-        finalColor += saturate(GetColorFromPointLight(pointLightInfos[i], toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
+        PointLightInfo pointLight = LoadPointLight(LightIndices.Load(cluster.x + light));
+        finalColor += saturate(GetColorFromPointLight(pointLight, toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
     }
     
-    for (i = 0; i < staticPointLightAffectingCount; i++)
+#ifdef INSTANCED_STATIC_LIGHTS
+    for (uint i = 0; i < input.staticLights.y; i++)
+    {
+        finalColor += saturate(GetColorFromPointLight(staticPointLightInfos[StaticLightIndices.Load(input.staticLights.x + i)], toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
+    }
+#else
+    for (int i = 0; i < staticPointLightAffectingCount; i++)
     {
         finalColor += saturate(GetColorFromPointLight(staticPointLightInfos[staticPointsLightsAffecting[i]], toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
     }
+#endif
 
     finalColor += saturate(GetColorFromDirectionalLight(directionalLightInfo, toEye, input.normal, materialColor, specularColor, material));
     
-    for (i = 0; i < spotLightCount; i++)
+    for (light = 0; light < cluster.z; light++)
     {
-        finalColor += saturate(GetColorFromSpotLight(spotLightInfos[i], toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
+        SpotLightInfo spotLight = LoadSpotLight(LightIndices.Load(cluster.x + cluster.y + light));
+        finalColor += saturate(GetColorFromSpotLight(spotLight, toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
     }
     
     finalColor.rgb = GetReflectionFromSky(finalColor, toEye, input.normal, SkyTexture, SampleType, material);
@@ -0,0 +1,84 @@
+#include "register_locations_pixel_shader.h"
+#include "light.hlsli"
+#include "basic_material.hlsli"
+#include "sky.hlsli"
+
+Texture2D ShaderTexture : register(DIFFUSE_PS_HLSL);
+TextureCube SkyTexture : register(SKY_PS_HLSL);
+Texture2D NormalTexture : register(NORMAL_PS_HLSL);
+Texture2D SpecularTexture : register(SPECULAR_PS_HLSL);
+
+SamplerState SampleType;
+
+struct PixelInputType
+{
+    float4 screenPosition : SV_POSITION;
+    float3 normal : NORMAL;
+    float4 worldPosition : POSITION;
+	float2 tex : TEXCOORD0;
+	float fogFactor : FOG;
+	float3 tangent : TANGENT;
+	float4 color : COLOR;
+};
+
+cbuffer CBuf : register(PER_OBJECT_PS_HLSL)
+{
+    BasicMaterial material;
+};
+
+cbuffer CBuf : register(PER_MODEL_PS_HLSL)
+{
+	int staticPointLightAffectingCount = 0;
+    int staticPointsLightsAffecting[MAX_STATIC_POINT_LIGHTS_AFFECTING_1_OBJECT];
+};
+
+float4 main(PixelInputType input) : SV_TARGET
+{
+    float4 materialColor = ShaderTexture.Sample(SampleType, input.tex) * input.color;
+    float4 finalColor = materialColor;
+    
+    clip(finalColor.a - 0.001f);
+    
+    float3 toEye = normalize(cameraPos - (float3) input.worldPosition);
+    
+    finalColor.rgb = lerp(finalColor.rgb, float3(0.0f, 0.0f, 0.0f), material.isLit);
+    input.normal = normalize(input.normal);
+
+    float3 normalMapSample = NormalTexture.Sample(SampleType, input.tex).rgb;
+    float3 uncompressedNormal = 2.0f * normalMapSample - 1.0f;
+    float3 N = input.normal;
+    float3 T = normalize(input.tangent - dot(input.tangent, N) * N);
+    float3 B = cross(N, T);
+
+    float3x3 TBN = float3x3(T, B, N);
+
+    input.normal = lerp(input.normal, mul(uncompressedNormal, TBN), material.hasNormalMap);
+
+    float3 specularColor = SpecularTexture.Sample(SampleType, input.tex).rgb;
+    uint4 cluster = GetLightCluster(input.screenPosition);
+    for (uint light = 0; light < cluster.y; light++)
+    {
+        PointLightInfo pointLight = LoadPointLight(LightIndices.Load(cluster.x + light));
+        finalColor += saturate(GetColorFromPointLight(pointLight, toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
+    }
+    
+    for (int i = 0; i < staticPointLightAffectingCount; i++)
+    {
+        finalColor += saturate(GetColorFromPointLight(staticPointLightInfos[staticPointsLightsAffecting[i]], toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
+    }
+
+    finalColor += saturate(GetColorFromDirectionalLight(directionalLightInfo, toEye, input.normal, materialColor, specularColor, material));
+    
+    for (light = 0; light < cluster.z; light++)
+    {
+        SpotLightInfo spotLight = LoadSpotLight(LightIndices.Load(cluster.x + cluster.y + light));
+        finalColor += saturate(GetColorFromSpotLight(spotLight, toEye, input.normal, input.worldPosition, materialColor, specularColor, material));
+    }
+    
+    finalColor.rgb = GetReflectionFromSky(finalColor, toEye, input.normal, SkyTexture, SampleType, material);
+    finalColor.rgb = GetRefractionFromSky(finalColor, input.normal, input.worldPosition, cameraPos, SkyTexture, SampleType, material);
+    
+    finalColor.rgb = (lerp(fogColor, finalColor, input.fogFactor)).rgb;
+
+    return finalColor;
+}
@@ -0,0 +1,63 @@
+#include "register_locations_vertex_shader.h"
+
+cbuffer CBuf : register(PER_FRAME_VS_HLSL)
+{
+    matrix V;
+	float fogStart;
+	float fogEnd;
+};
+
+cbuffer CBuf : register(PER_CAMERA_CHANGE_VS_HLSL)
+{
+    matrix P;
+};
+
+struct VertexInputType
+{
+    float4 position : POSITION;
+    float2 tex : TEXCOORD0;
+    float4 normal : NORMAL;
+	float3 tangent : TANGENT;
+	float4 transform0 : INSTANCE_TRANSFORM0;
+	float4 transform1 : INSTANCE_TRANSFORM1;
+	float4 transform2 : INSTANCE_TRANSFORM2;
+	float4 color : INSTANCE_COLOR0;
+};
+
+struct PixelInputType
+{
+    float4 screenPosition : SV_POSITION;
+    float3 normal : NORMAL;
+    float4 worldPosition : POSITION;
+    float2 tex : TEXCOORD0;
+	float fogFactor : FOG;
+	float3 tangent : TANGENT;
+	float4 color : COLOR;
+};
+
+PixelInputType main(VertexInputType input)
+{
+    // Translation is packed in the w components of the rotation and scale rows
+    float4x4 M = float4x4(
+        float4(input.transform0.xyz, 0.0f),
+        float4(input.transform1.xyz, 0.0f),
+        float4(input.transform2.xyz, 0.0f),
+        float4(input.transform0.w, input.transform1.w, input.transform2.w, 1.0f));
+
+    PixelInputType output;
+    output.screenPosition = mul(input.position, mul(M, mul(V, P)));
+    // Particles are scaled uniformly, so the normal only needs the rotation of M
+	output.normal = normalize(mul((float3)input.normal, (float3x3)M));
+    output.worldPosition = mul(input.position, M);
+    output.tex.x = input.tex.x;
+    output.tex.y = 1 - input.tex.y;
+
+    output.tangent = mul(input.tangent, (float3x3)M);
+	
+    float4 cameraPosition = mul(input.position, mul(M, V));
+    output.fogFactor = saturate((fogEnd - cameraPosition.z) / (fogEnd - fogStart));
+
+    output.color = input.color;
+	
+	return output;
+}
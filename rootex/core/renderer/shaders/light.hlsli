@@ -47,15 +47,67 @@ cbuffer StaticPointLights : register(PER_LEVEL_PS_HLSL)
 cbuffer Lights : register(PER_FRAME_PS_HLSL)
 {
     float3 cameraPos;
-    int pointLightCount;
-    PointLightInfo pointLightInfos[MAX_DYNAMIC_POINT_LIGHTS];
     int directionLightPresent;
     DirectionalLightInfo directionalLightInfo;
-    int spotLightCount;
-    SpotLightInfo spotLightInfos[MAX_DYNAMIC_SPOT_LIGHTS];
+    float2 clusterScale;
+    float clusterDepthScale;
+    float clusterDepthBias;
     float4 fogColor;
 }
 
+/// Offset into LightIndices, point light count and spot light count of each cluster
+Buffer<uint4> LightClusters : register(LIGHT_CLUSTERS_PS_HLSL);
+/// Offsets into LightData of the lights in each cluster
+Buffer<uint> LightIndices : register(LIGHT_INDICES_PS_HLSL);
+Buffer<float4> LightData : register(LIGHT_DATA_PS_HLSL);
+
+uint4 GetLightCluster(float4 screenPosition)
+{
+    // w of the screen position is the view depth of the pixel
+    uint x = min((uint)(screenPosition.x * clusterScale.x), LIGHT_CLUSTERS_X - 1);
+    uint y = min((uint)(screenPosition.y * clusterScale.y), LIGHT_CLUSTERS_Y - 1);
+    uint z = (uint)clamp(log(screenPosition.w) * clusterDepthScale - clusterDepthBias, 0.0f, LIGHT_CLUSTERS_Z - 1);
+    return LightClusters.Load((z * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X + x);
+}
+
+PointLightInfo LoadPointLight(uint offset)
+{
+    float4 attenuation = LightData.Load(offset + 2);
+    float4 position = LightData.Load(offset + 3);
+
+    PointLightInfo pointLight;
+    pointLight.ambientColor = LightData.Load(offset);
+    pointLight.diffuseColor = LightData.Load(offset + 1);
+    pointLight.diffuseIntensity = attenuation.x;
+    pointLight.attConst = attenuation.y;
+    pointLight.attLin = attenuation.z;
+    pointLight.attQuad = attenuation.w;
+    pointLight.lightPos = position.xyz;
+    pointLight.range = position.w;
+    return pointLight;
+}
+
+SpotLightInfo LoadSpotLight(uint offset)
+{
+    float4 attenuation = LightData.Load(offset + 2);
+    float4 position = LightData.Load(offset + 3);
+    float4 direction = LightData.Load(offset + 4);
+
+    SpotLightInfo spotLight;
+    spotLight.ambientColor = LightData.Load(offset);
+    spotLight.diffuseColor = LightData.Load(offset + 1);
+    spotLight.diffuseIntensity = attenuation.x;
+    spotLight.attConst = attenuation.y;
+    spotLight.attLin = attenuation.z;
+    spotLight.attQuad = attenuation.w;
+    spotLight.lightPos = position.xyz;
+    spotLight.range = position.w;
+    spotLight.direction = direction.xyz;
+    spotLight.spot = direction.w;
+    spotLight.angleRange = LightData.Load(offset + 5).x;
+    return spotLight;
+}
+
 float4 GetColorFromPointLight(PointLightInfo pointLight, float3 toEye, float3 normal, float4 worldPosition, float4 materialColor, float3 specularColor, BasicMaterial material)
 {
     float dist = distance(pointLight.lightPos, worldPosition.xyz);
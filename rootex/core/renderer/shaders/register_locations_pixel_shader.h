@@ -20,10 +20,23 @@
 #define SPECULAR_PS_HLSL CONCAT(t, SPECULAR_PS_CPP)
 #define SKY_PS_CPP 4
 #define SKY_PS_HLSL CONCAT(t, SKY_PS_CPP)
+#define LIGHT_CLUSTERS_PS_CPP 5
+#define LIGHT_CLUSTERS_PS_HLSL CONCAT(t, LIGHT_CLUSTERS_PS_CPP)
+#define LIGHT_INDICES_PS_CPP 6
+#define LIGHT_INDICES_PS_HLSL CONCAT(t, LIGHT_INDICES_PS_CPP)
+#define LIGHT_DATA_PS_CPP 7
+#define LIGHT_DATA_PS_HLSL CONCAT(t, LIGHT_DATA_PS_CPP)
+#define STATIC_LIGHT_INDICES_PS_CPP 8
+#define STATIC_LIGHT_INDICES_PS_HLSL CONCAT(t, STATIC_LIGHT_INDICES_PS_CPP)
 
 #define MAX_STATIC_POINT_LIGHTS 1000
 #define MAX_STATIC_POINT_LIGHTS_AFFECTING_1_OBJECT 10
-#define MAX_DYNAMIC_POINT_LIGHTS 4
-#define MAX_DYNAMIC_SPOT_LIGHTS 4
+#define LIGHT_CLUSTERS_X 16
+#define LIGHT_CLUSTERS_Y 8
+#define LIGHT_CLUSTERS_Z 24
+/// Number of float4 registers a point light takes in the light data buffer
+#define POINT_LIGHT_DATA_SIZE 4
+/// Number of float4 registers a spot light takes in the light data buffer
+#define SPOT_LIGHT_DATA_SIZE 6
 
 #endif
@@ -2,6 +2,8 @@
 
 #include <d3d11.h>
 
+#include "core/resource_handle.h"
+
 class ImageResourceFile;
 
 /// Encapsulates all Texture related functionalities, uses DirectXTK behind the scenes
@@ -9,7 +11,7 @@ class Texture
 {
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_TextureView;
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> m_Texture;
-	ImageResourceFile* m_ImageFile;
+	ResourceHandle<ImageResourceFile> m_ImageFile;
 	unsigned int m_Width;
 	unsigned int m_Height;
 	unsigned int m_MipLevels;
@@ -40,7 +42,7 @@ public:
 class Texture3D
 {
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_TextureView;
-	ImageResourceFile* m_ImageFile;
+	ResourceHandle<ImageResourceFile> m_ImageFile;
 	
 	void loadTexture();
 
@@ -3,18 +3,23 @@
 #include "rendering_device.h"
 
 VertexBuffer::VertexBuffer(const Vector<VertexData>& buffer)
+    : VertexBuffer(buffer.data(), buffer.size())
+{
+}
+
+VertexBuffer::VertexBuffer(const VertexData* vertices, unsigned int count)
     : m_Stride(sizeof(VertexData))
-    , m_Count(buffer.size())
+    , m_Count(count)
 {
 	D3D11_BUFFER_DESC vbd = { 0 };
 	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	vbd.Usage = D3D11_USAGE_DYNAMIC;
 	vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	vbd.MiscFlags = 0u;
-	vbd.ByteWidth = sizeof(VertexData) * buffer.size();
+	vbd.ByteWidth = sizeof(VertexData) * count;
 	vbd.StructureByteStride = sizeof(VertexData);
 	D3D11_SUBRESOURCE_DATA vsd = { 0 };
-	vsd.pSysMem = buffer.data();
+	vsd.pSysMem = vertices;
 	
 	const UINT offset = 0u;
 	m_VertexBuffer = RenderingDevice::GetSingleton()->createVB(&vbd, &vsd, &m_Stride, &offset);
@@ -61,3 +66,44 @@ void VertexBuffer::bind() const
 	const UINT offset = 0u;
 	RenderingDevice::GetSingleton()->bind(m_VertexBuffer.Get(), &m_Stride, &offset);
 }
+
+InstanceBuffer::InstanceBuffer(unsigned int stride)
+    : m_Stride(stride)
+    , m_Capacity(0)
+{
+}
+
+void InstanceBuffer::setData(const void* data, unsigned int count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (count > m_Capacity)
+	{
+		m_Capacity = std::max(count, m_Capacity * 2);
+
+		D3D11_BUFFER_DESC ibd = { 0 };
+		ibd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		ibd.Usage = D3D11_USAGE_DYNAMIC;
+		ibd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		ibd.MiscFlags = 0u;
+		ibd.ByteWidth = m_Stride * m_Capacity;
+		ibd.StructureByteStride = m_Stride;
+
+		const UINT offset = 0u;
+		m_InstanceBuffer = RenderingDevice::GetSingleton()->createVB(&ibd, nullptr, &m_Stride, &offset);
+	}
+
+	D3D11_MAPPED_SUBRESOURCE subresource;
+	RenderingDevice::GetSingleton()->mapBuffer(m_InstanceBuffer.Get(), subresource);
+	memcpy(subresource.pData, data, m_Stride * count);
+	RenderingDevice::GetSingleton()->unmapBuffer(m_InstanceBuffer.Get());
+}
+
+void InstanceBuffer::bind() const
+{
+	const UINT offset = 0u;
+	RenderingDevice::GetSingleton()->bindInstances(m_InstanceBuffer.Get(), &m_Stride, &offset);
+}
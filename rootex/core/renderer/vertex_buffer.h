@@ -15,6 +15,8 @@ class VertexBuffer
 
 public:
 	VertexBuffer(const Vector<VertexData>& buffer);
+	/// Upload count vertices straight from memory that is not owned by a Vector, like a mapped file.
+	VertexBuffer(const VertexData* vertices, unsigned int count);
 	VertexBuffer(const Vector<UIVertexData>& buffer);
 	VertexBuffer(const Vector<float>& buffer);
 	~VertexBuffer() = default;
@@ -22,3 +24,21 @@ public:
 	void bind() const;
 	unsigned int getCount() const { return m_Count; }
 };
+
+/// Dynamic vertex buffer holding per instance data, bound to input slot 1.
+/// Grows to fit the largest set of instances uploaded to it.
+class InstanceBuffer
+{
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_InstanceBuffer;
+	unsigned int m_Stride;
+	unsigned int m_Capacity;
+
+public:
+	InstanceBuffer(unsigned int stride);
+	~InstanceBuffer() = default;
+
+	/// Replace the contents of the buffer with count instances of stride bytes each.
+	void setData(const void* data, unsigned int count);
+	void bind() const;
+	unsigned int getCapacity() const { return m_Capacity; }
+};
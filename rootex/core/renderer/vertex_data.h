@@ -17,3 +17,13 @@ struct UIVertexData
 	char m_Color[4];
 	Vector2 m_TextureCoord;
 };
+
+/// Data sent once per instance of an instanced draw
+struct InstanceData
+{
+	Matrix m_Transform;
+	Matrix m_InverseTransposeTransform;
+	/// Offset into the static light index buffer of the static lights affecting the instance.
+	unsigned int m_StaticLightOffset;
+	unsigned int m_StaticLightCount;
+};
@@ -12,14 +12,43 @@ FilePath ResourceData::getPath()
 	return m_Path;
 }
 
+const char* ResourceData::getData() const
+{
+	return m_MappedFile ? m_MappedData : m_FileBuffer.data();
+}
+
 FileBuffer* ResourceData::getRawData()
 {
+	if (m_MappedFile)
+	{
+		m_FileBuffer.assign(m_MappedData, m_MappedData + m_MappedSize);
+		m_MappedFile.reset();
+		m_MappedData = nullptr;
+		m_MappedSize = 0;
+	}
 	return &m_FileBuffer;
 }
 
-unsigned int ResourceData::getRawDataByteSize()
+unsigned int ResourceData::getRawDataByteSize() const
 {
-	return m_FileBuffer.size();
+	return m_MappedFile ? m_MappedSize : m_FileBuffer.size();
+}
+
+void ResourceData::setRawData(const FileBuffer& data)
+{
+	m_FileBuffer = data;
+	m_MappedFile.reset();
+	m_MappedData = nullptr;
+	m_MappedSize = 0;
+}
+
+void ResourceData::setMappedData(const Ref<MappedFile>& mappedFile, const char* data, size_t size)
+{
+	m_FileBuffer.clear();
+	m_FileBuffer.shrink_to_fit();
+	m_MappedFile = mappedFile;
+	m_MappedData = data;
+	m_MappedSize = size;
 }
 
 void ResourceData::setPath(String path)
@@ -45,8 +74,8 @@ ResourceData::operator bool() const
 
 void ResourceData::startStream()
 {
-	m_StreamStart = &m_FileBuffer.front();
-	m_StreamEnd = &m_FileBuffer.back();
+	m_StreamStart = getData();
+	m_StreamEnd = getData() + getRawDataByteSize() - 1;
 }
 
 bool ResourceData::isEndOfFile()
@@ -56,12 +85,24 @@ bool ResourceData::isEndOfFile()
 
 void ResourceData::resetStream()
 {
-	m_StreamStart = &m_FileBuffer.front();
+	m_StreamStart = getData();
 }
 
 ResourceData::ResourceData(FilePath path, FileBuffer& data)
     : m_ID(s_Count)
     , m_FileBuffer(data)
+    , m_MappedData(nullptr)
+    , m_MappedSize(0)
+    , m_Path(path.generic_string())
+{
+	s_Count++;
+}
+
+ResourceData::ResourceData(FilePath path, const Ref<MappedFile>& mappedFile, const char* data, size_t size)
+    : m_ID(s_Count)
+    , m_MappedFile(mappedFile)
+    , m_MappedData(data)
+    , m_MappedSize(size)
     , m_Path(path.generic_string())
 {
 	s_Count++;
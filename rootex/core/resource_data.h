@@ -2,6 +2,7 @@
 
 #include "common/common.h"
 #include "os/os.h"
+#include "os/mapped_file.h"
 
 /// Convert kilobytes to bytes
 #define KB_TO_B (1024.0f)
@@ -17,6 +18,8 @@
 #define MB_TO_GB (1.0f / GB_TO_MB)
 
 /// Representation of a ResourceFile data buffer. Contains a faceless collection of bytes loaded from disk.
+/// The bytes either live in a buffer owned by the ResourceData or are a view into a MappedFile, which the OS pages in from disk
+/// on first access and shares between everything that maps the same file.
 class ResourceData
 {
 	static unsigned int s_Count;
@@ -24,22 +27,35 @@ class ResourceData
 protected:
 	unsigned int m_ID;
 	FileBuffer m_FileBuffer;
+	/// Keeps the mapping alive while m_MappedData points into it. Null if the bytes are in m_FileBuffer.
+	Ref<MappedFile> m_MappedFile;
+	const char* m_MappedData;
+	size_t m_MappedSize;
 	FilePath m_Path;
 
-	char* m_StreamStart;
+	const char* m_StreamStart;
 	const char* m_StreamEnd;
 
 public:
 	ResourceData(FilePath path, FileBuffer& data);
+	/// Refer to size bytes at data inside a mapped file, without copying them.
+	ResourceData(FilePath path, const Ref<MappedFile>& mappedFile, const char* data, size_t size);
 	~ResourceData() = default;
 
 	unsigned int getID();
 	FilePath getPath();
-	/// Get the collection of bytes in a file
+	/// Get the bytes in a file for reading. Does not copy mapped data.
+	const char* getData() const;
+	/// Get the collection of bytes in a file for editing. Mapped data is copied into a buffer owned by the ResourceData first.
 	FileBuffer* getRawData();
 	/// Get the number of bytes in a file
-	unsigned int getRawDataByteSize();
+	unsigned int getRawDataByteSize() const;
+	bool isMapped() const { return m_MappedFile != nullptr; }
 
+	/// Replace the bytes with a copy of data.
+	void setRawData(const FileBuffer& data);
+	/// Replace the bytes with a view of size bytes at data inside a mapped file.
+	void setMappedData(const Ref<MappedFile>& mappedFile, const char* data, size_t size);
 	/// Set the path of file loaded. Potentially dangerous to use if you don't know what gets effected.
 	void setPath(String path);
 
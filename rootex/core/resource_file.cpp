@@ -11,10 +11,12 @@
 ResourceFile::ResourceFile(const Type& type, ResourceData* resData)
     : m_Type(type)
     , m_ResourceData(resData)
+    , m_HandleCount(new Atomic<int>(0))
 {
 	PANIC(resData == nullptr, "Null resource found. Resource of this type has not been loaded correctly: " + std::to_string((int)type));
 	m_LastReadTime = OS::s_FileSystemClock.now();
-	m_LastChangedTime = OS::GetFileLastChangedTime(getPath().string());
+	m_LastChangedTime = m_LastReadTime;
+	getLastChangedTime();
 }
 
 void ResourceFile::RegisterAPI(sol::table& rootex)
@@ -31,6 +33,11 @@ ResourceFile::~ResourceFile()
 {
 }
 
+Ref<Atomic<int>> ResourceHandleBase::GetHandleCount(ResourceFile* file)
+{
+	return file->m_HandleCount;
+}
+
 bool ResourceFile::isValid()
 {
 	return m_ResourceData != nullptr;
@@ -58,7 +65,11 @@ ResourceData* ResourceFile::getData()
 
 const FileTimePoint& ResourceFile::getLastChangedTime()
 {
-	m_LastChangedTime = OS::GetFileLastChangedTime(getPath().string());
+	// Files that only exist inside an archive never change
+	if (OS::IsExists(getPath().string()))
+	{
+		m_LastChangedTime = OS::GetFileLastChangedTime(getPath().string());
+	}
 	return m_LastChangedTime;
 }
 
@@ -130,8 +141,8 @@ void TextResourceFile::append(const String& add)
 String TextResourceFile::getString() const
 {
 	return String(
-	    m_ResourceData->getRawData()->begin(),
-	    m_ResourceData->getRawData()->end());
+	    m_ResourceData->getData(),
+	    m_ResourceData->getData() + m_ResourceData->getRawDataByteSize());
 }
 
 LuaTextResourceFile::LuaTextResourceFile(ResourceData* resData)
@@ -194,7 +205,7 @@ FontResourceFile::~FontResourceFile()
 
 void FontResourceFile::regenerateFont()
 {
-	m_Font = RenderingDevice::GetSingleton()->createFont(m_ResourceData->getRawData());
+	m_Font = RenderingDevice::GetSingleton()->createFont(m_ResourceData->getData(), m_ResourceData->getRawDataByteSize());
 	m_Font->SetDefaultCharacter('X');
 }
 
@@ -2,6 +2,7 @@
 
 #include "common/common.h"
 #include "core/resource_data.h"
+#include "core/resource_handle.h"
 #include "core/renderer/mesh.h"
 #include "core/renderer/texture.h"
 #include "DirectXTK/Inc/SpriteFont.h"
@@ -28,10 +29,13 @@ protected:
 	ResourceData* m_ResourceData;
 	FileTimePoint m_LastReadTime;
 	FileTimePoint m_LastChangedTime;
+	/// Number of ResourceHandles to this file.
+	Ref<Atomic<int>> m_HandleCount;
 
 	explicit ResourceFile(const Type& type, ResourceData* resData);
 
 	friend class ResourceLoader;
+	friend class ResourceHandleBase;
 
 public:
 	static void RegisterAPI(sol::table& rootex);
@@ -52,6 +56,8 @@ public:
 	ResourceData* getData();
 	const FileTimePoint& getLastReadTime() const { return m_LastReadTime; }
 	const FileTimePoint& getLastChangedTime();
+	/// Number of ResourceHandles keeping the file resident.
+	int getHandleCount() const { return m_HandleCount->load(); }
 };
 
 /// Representation of a text file.
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "common/types.h"
+#include "script/interpreter.h"
+
+class ResourceFile;
+
+/// Counts itself as a user of a ResourceFile. ResourceLoader never evicts or unloads a file while a handle to it exists.
+class ResourceHandleBase
+{
+protected:
+	/// Shared with the file, so a handle can still be released after the file is gone.
+	Ref<Atomic<int>> m_HandleCount;
+
+	static Ref<Atomic<int>> GetHandleCount(ResourceFile* file);
+
+	explicit ResourceHandleBase(ResourceFile* file)
+	    : m_HandleCount(file ? GetHandleCount(file) : nullptr)
+	{
+		retain();
+	}
+	ResourceHandleBase(const ResourceHandleBase& other)
+	    : m_HandleCount(other.m_HandleCount)
+	{
+		retain();
+	}
+	ResourceHandleBase& operator=(const ResourceHandleBase& other)
+	{
+		Ref<Atomic<int>> handleCount = other.m_HandleCount;
+		if (handleCount)
+		{
+			(*handleCount)++;
+		}
+		release();
+		m_HandleCount = handleCount;
+		return *this;
+	}
+	~ResourceHandleBase() { release(); }
+
+	void retain()
+	{
+		if (m_HandleCount)
+		{
+			(*m_HandleCount)++;
+		}
+	}
+	void release()
+	{
+		if (m_HandleCount)
+		{
+			(*m_HandleCount)--;
+		}
+	}
+};
+
+/// Handle to a loaded file of type T that keeps it resident. Converts to and from a plain pointer to the file.
+template <class T>
+class ResourceHandle : public ResourceHandleBase
+{
+	T* m_File;
+
+public:
+	ResourceHandle()
+	    : ResourceHandleBase(nullptr)
+	    , m_File(nullptr)
+	{
+	}
+	ResourceHandle(T* file)
+	    : ResourceHandleBase(file)
+	    , m_File(file)
+	{
+	}
+	ResourceHandle(const ResourceHandle&) = default;
+	ResourceHandle& operator=(const ResourceHandle&) = default;
+	~ResourceHandle() = default;
+
+	T* get() const { return m_File; }
+	T* operator->() const { return m_File; }
+	operator T*() const { return m_File; }
+};
+
+/// Lets Lua hold handles, so files handed to scripts stay resident until the script drops them.
+template <class T>
+struct sol::unique_usertype_traits<ResourceHandle<T>>
+{
+	typedef T type;
+	typedef ResourceHandle<T> actual_type;
+	static const bool value = true;
+
+	static bool is_null(const actual_type& handle) { return handle.get() == nullptr; }
+	static type* get(const actual_type& handle) { return handle.get(); }
+};
@@ -12,13 +12,146 @@
 #include "core/renderer/vertex_data.h"
 #include "script/interpreter.h"
 #include "core/renderer/material_library.h"
+#include "core/cooked_model.h"
+#include "core/pak_archive.h"
 #include "os/thread.h"
+#include "os/timer.h"
+#include "os/mapped_file.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
-HashMap<Ptr<ResourceData>, Ptr<ResourceFile>> ResourceLoader::s_ResourcesDataFiles;
+std::mutex ResourceLoader::s_Mutex;
+HashMap<String, ResourcePathID> ResourceLoader::s_PathIDs;
+HashMap<ResourceKey, Ref<ResourceEntry>> ResourceLoader::s_Resources;
+// Static initialization runs on the main thread, which creates and owns the rendering device
+const std::thread::id ResourceLoader::s_OwningThread = std::this_thread::get_id();
+std::mutex ResourceLoader::s_UploadsMutex;
+Vector<Function<void()>> ResourceLoader::s_Uploads;
+Vector<Ref<PakArchive>> ResourceLoader::s_Archives;
+Atomic<uint64_t> ResourceLoader::s_UseClock(0);
+HashMap<ResourceFile::Type, size_t> ResourceLoader::s_Budgets;
+
+/// Geometry of a model read on any thread, turned into materials and buffers on the owning thread by UploadModel().
+struct ModelImport
+{
+	struct ImportedMesh
+	{
+		String m_MaterialPath;
+		/// Index of the material in the Assimp scene, used to create the material file if it does not exist.
+		unsigned int m_Material;
+		Vector<VertexData> m_Vertices;
+		Vector<unsigned short> m_ShortIndices;
+		Vector<int> m_Indices;
+		BoundingBox m_BoundingBox;
+	};
+
+	/// Keeps the scene alive for its materials and embedded textures. Only set for models imported with Assimp.
+	Ptr<Assimp::Importer> m_Importer;
+	const aiScene* m_Scene = nullptr;
+	Vector<ImportedMesh> m_Meshes;
+	/// Only set for models read from their cooked form.
+	Ptr<CookedModel> m_CookedModel;
+};
+
+/// Contents of a file found in a mounted archive or on disk. Either a view into a mapping or a buffer of its own.
+struct FileContents
+{
+	/// Null if the contents are in m_Buffer.
+	Ref<MappedFile> m_MappedFile;
+	FileBuffer m_Buffer;
+	const char* m_Data = nullptr;
+	size_t m_Size = 0;
+	bool m_IsArchived = false;
+};
+
+/// Samples of a WAV file that OpenAL can play without decoding.
+struct PCMSamples
+{
+	const char* m_Data = nullptr;
+	int m_Size = 0;
+	ALenum m_Format = 0;
+	float m_Frequency = 0.0f;
+};
+
+/// Find the samples of an uncompressed 8 or 16 bit mono or stereo WAV file. Returns false for any other file.
+static bool FindPCMSamples(const char* file, size_t size, PCMSamples& samples)
+{
+	auto readU16 = [](const char* at) { return (unsigned int)(unsigned char)at[0] | (unsigned int)(unsigned char)at[1] << 8; };
+	auto readU32 = [&](const char* at) { return readU16(at) | readU16(at + 2) << 16; };
+
+	if (size < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0)
+	{
+		return false;
+	}
+
+	bool isFormatFound = false;
+	size_t offset = 12;
+	while (offset + 8 <= size)
+	{
+		const char* chunk = file + offset;
+		size_t chunkSize = readU32(chunk + 4);
+		const char* chunkData = chunk + 8;
+		if (chunkSize > size - offset - 8)
+		{
+			return false;
+		}
+
+		if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16)
+		{
+			unsigned int encoding = readU16(chunkData);
+			unsigned int channels = readU16(chunkData + 2);
+			unsigned int bitDepth = readU16(chunkData + 14);
+			if (encoding != 1)
+			{
+				return false;
+			}
+
+			if (channels == 1 && bitDepth == 8)
+			{
+				samples.m_Format = AL_FORMAT_MONO8;
+			}
+			else if (channels == 1 && bitDepth == 16)
+			{
+				samples.m_Format = AL_FORMAT_MONO16;
+			}
+			else if (channels == 2 && bitDepth == 8)
+			{
+				samples.m_Format = AL_FORMAT_STEREO8;
+			}
+			else if (channels == 2 && bitDepth == 16)
+			{
+				samples.m_Format = AL_FORMAT_STEREO16;
+			}
+			else
+			{
+				return false;
+			}
+			samples.m_Frequency = readU32(chunkData + 4);
+			isFormatFound = true;
+		}
+		else if (memcmp(chunk, "data", 4) == 0)
+		{
+			samples.m_Data = chunkData;
+			samples.m_Size = chunkSize;
+			return isFormatFound;
+		}
+
+		// Chunks are padded to an even number of bytes
+		offset += 8 + chunkSize + (chunkSize & 1);
+	}
+	return false;
+}
+
+static String GetAssimpMaterialPath(const aiMaterial* material)
+{
+	if (String(material->GetName().C_Str()) == "DefaultMaterial")
+	{
+		return "rootex/assets/materials/default.rmat";
+	}
+	return "game/assets/materials/" + String(material->GetName().C_Str()) + ".rmat";
+}
 
 bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileType)
 {
@@ -31,28 +164,403 @@ bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileTy
 	return false;
 }
 
-void ResourceLoader::LoadAssimp(ModelResourceFile* file)
+String ResourceLoader::NormalizePath(const String& path)
+{
+	String normalized = FilePath(path).lexically_normal().generic_string();
+	std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](char c) { return std::tolower(c); });
+	return normalized;
+}
+
+ResourcePathID ResourceLoader::InternPath(const String& path)
+{
+	auto [pathIt, isInserted] = s_PathIDs.emplace(NormalizePath(path), s_PathIDs.size());
+	return pathIt->second;
+}
+
+ResourceKey ResourceLoader::GetKey(ResourcePathID pathID, ResourceFile::Type type)
+{
+	return ((ResourceKey)pathID << 32) | (ResourceKey)type;
+}
+
+ResourceFile::Type ResourceLoader::GetKeyType(ResourceKey key)
+{
+	return (ResourceFile::Type)(key & 0xFFFFFFFF);
+}
+
+ResourceFile::Type ResourceLoader::GetType(const String& path)
+{
+	String extension = FilePath(path).extension().generic_string();
+	for (auto& [resourceType, extensions] : SupportedFiles)
+	{
+		if (std::find(extensions.begin(), extensions.end(), extension) != extensions.end())
+		{
+			return resourceType;
+		}
+	}
+	return ResourceFile::Type::None;
+}
+
+const PakEntry* ResourceLoader::FindInArchives(const String& path, PakArchive*& archive)
+{
+	if (s_Archives.empty())
+	{
+		return nullptr;
+	}
+
+	String normalizedPath = NormalizePath(path);
+	for (auto it = s_Archives.rbegin(); it != s_Archives.rend(); it++)
+	{
+		if (const PakEntry* entry = (*it)->find(normalizedPath))
+		{
+			archive = it->get();
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+bool ResourceLoader::IsExists(const String& path)
+{
+	PakArchive* archive = nullptr;
+	return FindInArchives(path, archive) || OS::IsExists(path);
+}
+
+bool ResourceLoader::OpenFile(const String& path, FileContents& contents)
+{
+	PakArchive* archive = nullptr;
+	if (const PakEntry* entry = FindInArchives(path, archive))
+	{
+		contents.m_IsArchived = true;
+		if (entry->m_Compression == PakCompression::None)
+		{
+			contents.m_MappedFile = archive->getMappedFile();
+			contents.m_Data = archive->getData(*entry);
+			contents.m_Size = entry->m_Size;
+			return true;
+		}
+		if (!archive->read(*entry, contents.m_Buffer))
+		{
+			ERR("Corrupt file in archive: " + path);
+			return false;
+		}
+		contents.m_Data = contents.m_Buffer.data();
+		contents.m_Size = contents.m_Buffer.size();
+		return true;
+	}
+
+	contents.m_MappedFile = OS::MapFileContents(path);
+	if (contents.m_MappedFile)
+	{
+		contents.m_Data = contents.m_MappedFile->getData();
+		contents.m_Size = contents.m_MappedFile->getSize();
+		return true;
+	}
+	// Empty files cannot be mapped
+	return OS::IsExists(path);
+}
+
+/// Whether data read from a mapped file should keep referring to the mapping instead of being copied out of it.
+static bool IsKeptMapped(const FileContents& contents)
+{
+	// Archived files share the mapping of their archive, so referring to them costs nothing
+#ifdef ROOTEX_EDITOR
+	// Assets are edited by other tools while the editor runs, and they cannot be written in place while mapped
+	return contents.m_IsArchived;
+#else
+	return contents.m_IsArchived || contents.m_Size >= RESOURCE_MAPPING_MIN_SIZE;
+#endif // ROOTEX_EDITOR
+}
+
+ResourceData* ResourceLoader::ReadOnlyResourceData(const String& path)
+{
+	FileContents contents;
+	if (!OpenFile(path, contents))
+	{
+		ERR("Could not read file: " + path);
+	}
+
+	if (contents.m_MappedFile && IsKeptMapped(contents))
+	{
+		return new ResourceData(path, contents.m_MappedFile, contents.m_Data, contents.m_Size);
+	}
+	if (contents.m_MappedFile)
+	{
+		contents.m_Buffer.assign(contents.m_Data, contents.m_Data + contents.m_Size);
+	}
+	return new ResourceData(path, contents.m_Buffer);
+}
+
+bool ResourceLoader::MountArchive(const String& pakPath)
+{
+	Ref<PakArchive> archive(new PakArchive());
+	if (!archive->open(pakPath))
+	{
+		ERR("Could not mount archive: " + pakPath);
+		return false;
+	}
+
+	s_Archives.push_back(archive);
+	PRINT("Mounted archive: " + pakPath + " with " + std::to_string(archive->getEntryCount()) + " files");
+	return true;
+}
+
+Vector<FilePath> ResourceLoader::GetFilesInDirectory(const String& directory)
+{
+	Vector<FilePath> files;
+	HashMap<String, bool> isListed;
+	String normalizedDirectory = NormalizePath(directory);
+	for (auto it = s_Archives.rbegin(); it != s_Archives.rend(); it++)
+	{
+		for (auto& path : (*it)->getFilesInDirectory(normalizedDirectory))
+		{
+			if (!isListed[path])
+			{
+				isListed[path] = true;
+				files.push_back(path);
+			}
+		}
+	}
+
+	if (OS::IsExists(directory))
+	{
+		for (auto& path : OS::GetFilesInDirectory(directory))
+		{
+			if (!isListed[NormalizePath(path.generic_string())])
+			{
+				files.push_back(path);
+			}
+		}
+	}
+	return files;
+}
+
+bool ResourceLoader::Acquire(const String& path, ResourceFile::Type type, Ref<ResourceEntry>& entry)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	ResourceKey key = GetKey(InternPath(path), type);
+	auto findIt = s_Resources.find(key);
+	if (findIt != s_Resources.end())
+	{
+		entry = findIt->second;
+		entry->m_LastUsed = ++s_UseClock;
+		return false;
+	}
+
+	entry.reset(new ResourceEntry());
+	entry->m_LastUsed = ++s_UseClock;
+	s_Resources[key] = entry;
+	return true;
+}
+
+Ref<ResourceEntry> ResourceLoader::Request(const String& path, ResourceFile::Type type)
+{
+	Ref<ResourceEntry> entry;
+	if (Acquire(path, type, entry))
+	{
+		Load(entry, path, type);
+	}
+	return entry;
+}
+
+ResourceFile* ResourceLoader::Wait(const Ref<ResourceEntry>& entry)
+{
+	while (entry->m_State.load(std::memory_order_acquire) == ResourceEntry::State::Loading)
+	{
+		// The load may be waiting for its upload, which only the owning thread can run
+		if (IsOwningThread() && RunPendingUploads() > 0)
+		{
+			continue;
+		}
+		if (!Application::GetSingleton()->getThreadPool().help())
+		{
+			std::this_thread::yield();
+		}
+	}
+	return entry->m_State == ResourceEntry::State::Ready ? entry->m_File.get() : nullptr;
+}
+
+void ResourceLoader::Then(const Ref<ResourceEntry>& entry, const Function<void()>& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		if (entry->m_State == ResourceEntry::State::Loading)
+		{
+			entry->m_Continuations.push_back(job);
+			return;
+		}
+	}
+	job();
+}
+
+void ResourceLoader::Finish(const Ref<ResourceEntry>& entry, ResourceData* resourceData, ResourceFile* resourceFile)
+{
+	Vector<Function<void()>> continuations;
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		entry->m_Data.reset(resourceData);
+		entry->m_File.reset(resourceFile);
+		entry->m_State.store(ResourceEntry::State::Ready, std::memory_order_release);
+		continuations.swap(entry->m_Continuations);
+	}
+	for (auto& continuation : continuations)
+	{
+		continuation();
+	}
+}
+
+void ResourceLoader::Fail(const Ref<ResourceEntry>& entry, ResourceFile::Type type, const String& path)
+{
+	Vector<Function<void()>> continuations;
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		entry->m_State.store(ResourceEntry::State::Failed, std::memory_order_release);
+		continuations.swap(entry->m_Continuations);
+
+		// Forget the failed entry so that the file can be requested again once it exists
+		auto findIt = s_Resources.find(GetKey(InternPath(path), type));
+		if (findIt != s_Resources.end() && findIt->second == entry)
+		{
+			s_Resources.erase(findIt);
+		}
+	}
+	for (auto& continuation : continuations)
+	{
+		continuation();
+	}
+}
+
+void ResourceLoader::Upload(const Function<void()>& job)
+{
+	if (IsOwningThread())
+	{
+		job();
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(s_UploadsMutex);
+	s_Uploads.push_back(job);
+}
+
+int ResourceLoader::RunPendingUploads()
+{
+	Vector<Function<void()>> uploads;
+	{
+		std::lock_guard<std::mutex> lock(s_UploadsMutex);
+		uploads.swap(s_Uploads);
+	}
+	for (auto& upload : uploads)
+	{
+		upload();
+	}
+	return uploads.size();
+}
+
+int ResourceLoader::RunPendingUploads(float budgetMilliseconds)
+{
+	Vector<Function<void()>> uploads;
+	{
+		std::lock_guard<std::mutex> lock(s_UploadsMutex);
+		uploads.swap(s_Uploads);
+	}
+
+	StopTimer timer;
+	int ran = 0;
+	while (ran < uploads.size() && (ran == 0 || timer.getTimeMs() < budgetMilliseconds))
+	{
+		uploads[ran++]();
+	}
+
+	if (ran < uploads.size())
+	{
+		std::lock_guard<std::mutex> lock(s_UploadsMutex);
+		s_Uploads.insert(s_Uploads.begin(), uploads.begin() + ran, uploads.end());
+	}
+	return ran;
+}
+
+Vector<ResourceFile*> ResourceLoader::GetResources()
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	Vector<ResourceFile*> resources;
+	resources.reserve(s_Resources.size());
+	for (auto& [key, entry] : s_Resources)
+	{
+		if (entry->m_State == ResourceEntry::State::Ready)
+		{
+			resources.push_back(entry->m_File.get());
+		}
+	}
+	return resources;
+}
+
+void ResourceLoader::AddMesh(ModelResourceFile* file, const Ref<Material>& material, const Mesh& mesh)
+{
+	for (auto& materialModels : file->getMeshes())
+	{
+		if (materialModels.first == material)
+		{
+			materialModels.second.push_back(mesh);
+			return;
+		}
+	}
+	file->getMeshes().push_back(Pair<Ref<Material>, Vector<Mesh>>(material, { mesh }));
+}
+
+Ref<ModelImport> ResourceLoader::ImportModel(const String& path)
 {
-	Assimp::Importer modelLoader;
-	const aiScene* scene = modelLoader.ReadFile(
-	    file->getPath().generic_string(),
+	Ref<ModelImport> import(new ModelImport());
+	if (ImportCookedModel(path, *import) || ImportAssimp(path, *import))
+	{
+		return import;
+	}
+	return nullptr;
+}
+
+bool ResourceLoader::ImportCookedModel(const String& path, ModelImport& import)
+{
+	CookedModelSource source;
+	Ptr<CookedModel> cookedModel(new CookedModel());
+	if (!CookedModelSource::Get(path, source) || !cookedModel->open(CookedModel::GetCookedPath(path), source))
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < cookedModel->getMaterialCount(); i++)
+	{
+		if (!MaterialLibrary::IsExists(cookedModel->getMaterialPath(i)))
+		{
+			// Let the importer create the material again
+			return false;
+		}
+	}
+
+	import.m_CookedModel = std::move(cookedModel);
+	return true;
+}
+
+bool ResourceLoader::ImportAssimp(const String& path, ModelImport& import)
+{
+	import.m_Importer.reset(new Assimp::Importer());
+	const aiScene* scene = import.m_Importer->ReadFile(
+	    path,
 	    aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_OptimizeMeshes | aiProcess_CalcTangentSpace);
 
 	if (!scene)
 	{
-		ERR("Model could not be loaded: " + OS::GetAbsolutePath(file->m_ResourceData->getPath().string()).generic_string());
-		ERR("Assimp: " + modelLoader.GetErrorString());
-		return;
+		ERR("Model could not be loaded: " + OS::GetAbsolutePath(path).generic_string());
+		ERR("Assimp: " + import.m_Importer->GetErrorString());
+		return false;
 	}
+	import.m_Scene = scene;
 
-	Vector<Ref<Texture>> textures;
-	textures.resize(scene->mNumTextures, nullptr);
-	file->m_Meshes.clear();
+	CookedModelWriter cookedModelWriter;
+	import.m_Meshes.resize(scene->mNumMeshes);
 	for (int i = 0; i < scene->mNumMeshes; i++)
 	{
 		const aiMesh* mesh = scene->mMeshes[i];
+		ModelImport::ImportedMesh& importedMesh = import.m_Meshes[i];
 
-		Vector<VertexData> vertices;
+		Vector<VertexData>& vertices = importedMesh.m_Vertices;
 		vertices.reserve(mesh->mNumVertices);
 
 		VertexData vertex;
@@ -90,7 +598,8 @@ void ResourceLoader::LoadAssimp(ModelResourceFile* file)
 			vertices.push_back(vertex);
 		}
 
-		std::vector<unsigned short> indices;
+		Vector<int>& indices = importedMesh.m_Indices;
+		indices.reserve(mesh->mNumFaces * 3);
 
 		aiFace* face = nullptr;
 		for (unsigned int f = 0; f < mesh->mNumFaces; f++)
@@ -102,171 +611,242 @@ void ResourceLoader::LoadAssimp(ModelResourceFile* file)
 			indices.push_back(face->mIndices[2]);
 		}
 
-		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+		if (!vertices.empty())
+		{
+			BoundingBox::CreateFromPoints(importedMesh.m_BoundingBox, vertices.size(), &vertices.front().m_Position, sizeof(VertexData));
+		}
+
+		importedMesh.m_Material = mesh->mMaterialIndex;
+		importedMesh.m_MaterialPath = GetAssimpMaterialPath(scene->mMaterials[mesh->mMaterialIndex]);
 
-		aiColor3D color(0.0f, 0.0f, 0.0f);
-		float alpha = 1.0f;
-		if (AI_SUCCESS != material->Get(AI_MATKEY_COLOR_DIFFUSE, color))
+		// 16 bit indices are enough for most meshes and take half the space
+		if (vertices.size() <= (size_t)USHRT_MAX + 1)
 		{
-			WARN("Material does not have color: " + String(material->GetName().C_Str()));
+			importedMesh.m_ShortIndices.assign(indices.begin(), indices.end());
+			indices.clear();
+			cookedModelWriter.addMesh(importedMesh.m_MaterialPath, vertices, importedMesh.m_ShortIndices, importedMesh.m_BoundingBox);
 		}
-		if (AI_SUCCESS != material->Get(AI_MATKEY_OPACITY, alpha))
+		else
 		{
-			WARN("Material does not have alpha: " + String(material->GetName().C_Str()));
+			cookedModelWriter.addMesh(importedMesh.m_MaterialPath, vertices, indices, importedMesh.m_BoundingBox);
 		}
+	}
 
-		Ref<BasicMaterial> extractedMaterial;
-		
-		String materialPath;
-		if (String(material->GetName().C_Str()) == "DefaultMaterial")
+	CookedModelSource source;
+	if (CookedModelSource::Get(path, source) && !cookedModelWriter.save(CookedModel::GetCookedPath(path), source))
+	{
+		WARN("Could not write cooked model for: " + path);
+	}
+	return true;
+}
+
+void ResourceLoader::UploadModel(ModelResourceFile* file, ModelImport& import)
+{
+	file->m_Meshes.clear();
+
+	if (const CookedModel* cookedModel = import.m_CookedModel.get())
+	{
+		Vector<Ref<BasicMaterial>> materials;
+		for (unsigned int i = 0; i < cookedModel->getMaterialCount(); i++)
 		{
-			materialPath = "rootex/assets/materials/default.rmat";
+			materials.push_back(std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(cookedModel->getMaterialPath(i))));
 		}
-		else
+
+		for (unsigned int i = 0; i < cookedModel->getMeshCount(); i++)
 		{
-			materialPath = "game/assets/materials/" + String(material->GetName().C_Str()) + ".rmat";
+			const CookedMesh& cookedMesh = cookedModel->getMesh(i);
+			if (!materials[cookedMesh.m_Material])
+			{
+				continue;
+			}
+
+			Mesh mesh;
+			mesh.m_VertexBuffer.reset(new VertexBuffer(cookedModel->getVertices(i), cookedMesh.m_VertexCount));
+			if (cookedMesh.m_IndexSize == sizeof(unsigned short))
+			{
+				mesh.m_IndexBuffer.reset(new IndexBuffer((const unsigned short*)cookedModel->getIndices(i), cookedMesh.m_IndexCount));
+			}
+			else
+			{
+				mesh.m_IndexBuffer.reset(new IndexBuffer((const int*)cookedModel->getIndices(i), cookedMesh.m_IndexCount));
+			}
+			mesh.m_BoundingBox = cookedMesh.m_BoundingBox;
+			AddMesh(file, materials[cookedMesh.m_Material], mesh);
 		}
+		return;
+	}
 
-		if (MaterialLibrary::IsExists(materialPath))
+	Vector<Ref<Texture>> textures;
+	textures.resize(import.m_Scene->mNumTextures, nullptr);
+	Vector<Ref<Material>> materials;
+	materials.resize(import.m_Scene->mNumMaterials, nullptr);
+	for (auto& importedMesh : import.m_Meshes)
+	{
+		Ref<Material>& material = materials[importedMesh.m_Material];
+		if (!material)
 		{
-			extractedMaterial = std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(materialPath));
+			material = UploadAssimpMaterial(file, import, importedMesh.m_Material, textures);
+		}
+
+		Mesh extractedMesh;
+		extractedMesh.m_VertexBuffer.reset(new VertexBuffer(importedMesh.m_Vertices));
+		if (importedMesh.m_Indices.empty())
+		{
+			extractedMesh.m_IndexBuffer.reset(new IndexBuffer(importedMesh.m_ShortIndices));
 		}
 		else
 		{
-			MaterialLibrary::CreateNewMaterialFile(materialPath, "BasicMaterial");
-			extractedMaterial = std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(materialPath));
-			extractedMaterial->setColor({ color.r, color.g, color.b, alpha });
+			extractedMesh.m_IndexBuffer.reset(new IndexBuffer(importedMesh.m_Indices));
+		}
+		extractedMesh.m_BoundingBox = importedMesh.m_BoundingBox;
+
+		if (material)
+		{
+			AddMesh(file, material, extractedMesh);
+		}
+	}
+}
+
+Ref<Material> ResourceLoader::UploadAssimpMaterial(ModelResourceFile* file, ModelImport& import, unsigned int materialIndex, Vector<Ref<Texture>>& textures)
+{
+	const aiScene* scene = import.m_Scene;
+	aiMaterial* material = scene->mMaterials[materialIndex];
+
+	aiColor3D color(0.0f, 0.0f, 0.0f);
+	float alpha = 1.0f;
+	if (AI_SUCCESS != material->Get(AI_MATKEY_COLOR_DIFFUSE, color))
+	{
+		WARN("Material does not have color: " + String(material->GetName().C_Str()));
+	}
+	if (AI_SUCCESS != material->Get(AI_MATKEY_OPACITY, alpha))
+	{
+		WARN("Material does not have alpha: " + String(material->GetName().C_Str()));
+	}
+
+	Ref<BasicMaterial> extractedMaterial;
+	
+	String materialPath = GetAssimpMaterialPath(material);
+	if (MaterialLibrary::IsExists(materialPath))
+	{
+		extractedMaterial = std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(materialPath));
+	}
+	else
+	{
+		MaterialLibrary::CreateNewMaterialFile(materialPath, "BasicMaterial");
+		extractedMaterial = std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(materialPath));
+		extractedMaterial->setColor({ color.r, color.g, color.b, alpha });
+
+		for (int i = 0; i < material->GetTextureCount(aiTextureType_DIFFUSE); i++)
+		{
+			aiString str;
+			material->GetTexture(aiTextureType_DIFFUSE, i, &str);
+				
+			char embeddedAsterisk = *str.C_Str();
 
-			for (int i = 0; i < material->GetTextureCount(aiTextureType_DIFFUSE); i++)
+			if (embeddedAsterisk == '*')
 			{
-				aiString str;
-				material->GetTexture(aiTextureType_DIFFUSE, i, &str);
-					
-				char embeddedAsterisk = *str.C_Str();
+				// Texture is embedded
+				int textureID = atoi(str.C_Str() + 1);
 
-				if (embeddedAsterisk == '*')
+				if (!textures[textureID])
 				{
-					// Texture is embedded
-					int textureID = atoi(str.C_Str() + 1);
-
-					if (!textures[textureID])
-					{
-						aiTexture* texture = scene->mTextures[textureID];
-						size_t size = scene->mTextures[textureID]->mWidth;
-						PANIC(texture->mHeight == 0, "Compressed texture found but expected embedded texture");
-						textures[textureID].reset(new Texture(reinterpret_cast<const char*>(texture->pcData), size));
-					}
-
-					extractedMaterial->setTextureInternal(textures[textureID]);
+					aiTexture* texture = scene->mTextures[textureID];
+					size_t size = scene->mTextures[textureID]->mWidth;
+					PANIC(texture->mHeight == 0, "Compressed texture found but expected embedded texture");
+					textures[textureID].reset(new Texture(reinterpret_cast<const char*>(texture->pcData), size));
 				}
-				else
-				{
-					// Texture is given as a path
-					String texturePath = str.C_Str();
-					ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(file->getPath().parent_path().generic_string() + "/" + texturePath);
-
-					if (image)
-					{
-						extractedMaterial->setTexture(image);
-					}
-					else
-					{
-						WARN("Could not set material diffuse texture: " + texturePath);
-					}
-				}
-			}
 
-			for (int i = 0; i < material->GetTextureCount(aiTextureType_NORMALS); i++)
+				extractedMaterial->setTextureInternal(textures[textureID]);
+			}
+			else
 			{
-				aiString normalStr;
-				material->GetTexture(aiTextureType_NORMALS, i, &normalStr);
-				char embeddedAsterisk = *normalStr.C_Str();
-				if (embeddedAsterisk == '*')
-				{
-					int textureID = atoi(normalStr.C_Str() + 1);
+				// Texture is given as a path
+				String texturePath = str.C_Str();
+				ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(file->getPath().parent_path().generic_string() + "/" + texturePath);
 
-					if (!textures[textureID])
-					{
-						aiTexture* texture = scene->mTextures[textureID];
-						size_t size = scene->mTextures[textureID]->mWidth;
-						PANIC(texture->mHeight == 0, "Compressed texture found but expected embedded texture");
-						textures[textureID].reset(new Texture(reinterpret_cast<const char*>(texture->pcData), size));
-					}
-
-					extractedMaterial->setNormalInternal(textures[textureID]);
+				if (image)
+				{
+					extractedMaterial->setTexture(image);
 				}
 				else
 				{
-					String texturePath = normalStr.C_Str();
-					ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(file->getPath().parent_path().generic_string() + "/" + texturePath);
-
-					if (image)
-					{
-						extractedMaterial->setNormal(image);
-					}
-					else
-					{
-						WARN("Could not set material normal map texture: " + texturePath);
-					}
+					WARN("Could not set material diffuse texture: " + texturePath);
 				}
 			}
+		}
 
-			for (int i = 0; i < material->GetTextureCount(aiTextureType_SPECULAR); i++)
+		for (int i = 0; i < material->GetTextureCount(aiTextureType_NORMALS); i++)
+		{
+			aiString normalStr;
+			material->GetTexture(aiTextureType_NORMALS, i, &normalStr);
+			char embeddedAsterisk = *normalStr.C_Str();
+			if (embeddedAsterisk == '*')
 			{
-				aiString specularStr;
-				material->GetTexture(aiTextureType_SPECULAR, i, &specularStr);
-				char embeddedAsterisk = *specularStr.C_Str();
-				if (embeddedAsterisk == '*')
+				int textureID = atoi(normalStr.C_Str() + 1);
+
+				if (!textures[textureID])
 				{
-					int textureID = atoi(specularStr.C_Str() + 1);
+					aiTexture* texture = scene->mTextures[textureID];
+					size_t size = scene->mTextures[textureID]->mWidth;
+					PANIC(texture->mHeight == 0, "Compressed texture found but expected embedded texture");
+					textures[textureID].reset(new Texture(reinterpret_cast<const char*>(texture->pcData), size));
+				}
 
-					if (!textures[textureID])
-					{
-						aiTexture* texture = scene->mTextures[textureID];
-						size_t size = scene->mTextures[textureID]->mWidth;
-						PANIC(texture->mHeight == 0, "Compressed texture found but expected embedded texture");
-						textures[textureID].reset(new Texture(reinterpret_cast<const char*>(texture->pcData), size));
-					}
+				extractedMaterial->setNormalInternal(textures[textureID]);
+			}
+			else
+			{
+				String texturePath = normalStr.C_Str();
+				ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(file->getPath().parent_path().generic_string() + "/" + texturePath);
 
-					extractedMaterial->setSpecularInternal(textures[textureID]);
+				if (image)
+				{
+					extractedMaterial->setNormal(image);
 				}
 				else
 				{
-					String texturePath = specularStr.C_Str();
-					ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(file->getPath().parent_path().generic_string() + "/" + texturePath);
-
-					if (image)
-					{
-						extractedMaterial->setSpecularTexture(image);
-					}
-					else
-					{
-						WARN("Could not set material specular map texture: " + texturePath);
-					}
+					WARN("Could not set material normal map texture: " + texturePath);
 				}
 			}
 		}
 
-		Mesh extractedMesh;
-		extractedMesh.m_VertexBuffer.reset(new VertexBuffer(vertices));
-		extractedMesh.m_IndexBuffer.reset(new IndexBuffer(indices));
-		
-		bool found = false;
-		for (auto& materialModels : file->getMeshes())
+		for (int i = 0; i < material->GetTextureCount(aiTextureType_SPECULAR); i++)
 		{
-			if (materialModels.first == extractedMaterial)
+			aiString specularStr;
+			material->GetTexture(aiTextureType_SPECULAR, i, &specularStr);
+			char embeddedAsterisk = *specularStr.C_Str();
+			if (embeddedAsterisk == '*')
 			{
-				found = true;
-				materialModels.second.push_back(extractedMesh);
-				break;
+				int textureID = atoi(specularStr.C_Str() + 1);
+
+				if (!textures[textureID])
+				{
+					aiTexture* texture = scene->mTextures[textureID];
+					size_t size = scene->mTextures[textureID]->mWidth;
+					PANIC(texture->mHeight == 0, "Compressed texture found but expected embedded texture");
+					textures[textureID].reset(new Texture(reinterpret_cast<const char*>(texture->pcData), size));
+				}
+
+				extractedMaterial->setSpecularInternal(textures[textureID]);
 			}
-		}
+			else
+			{
+				String texturePath = specularStr.C_Str();
+				ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(file->getPath().parent_path().generic_string() + "/" + texturePath);
 
-		if (!found && extractedMaterial)
-		{
-			file->getMeshes().push_back(Pair<Ref<Material>, Vector<Mesh>>(extractedMaterial, { extractedMesh }));
+				if (image)
+				{
+					extractedMaterial->setSpecularTexture(image);
+				}
+				else
+				{
+					WARN("Could not set material specular map texture: " + texturePath);
+				}
+			}
 		}
 	}
+
+	return extractedMaterial;
 }
 
 void ResourceLoader::LoadALUT(AudioResourceFile* audioRes, const char* audioBuffer, int format, int size, float frequency)
@@ -306,39 +886,14 @@ void ResourceLoader::LoadALUT(AudioResourceFile* audioRes, const char* audioBuff
 	audioRes->m_Duration /= frequency;
 }
 
-ResourceFile* ResourceLoader::CreateSomeResourceFile(const String& path)
+ResourceHandle<ResourceFile> ResourceLoader::CreateSomeResourceFile(const String& path)
 {
-	ResourceFile* result = nullptr;
-	for (auto& [resourceType, extensions] : SupportedFiles)
+	ResourceFile::Type type = GetType(path);
+	if (type == ResourceFile::Type::None)
 	{
-		if (std::find(extensions.begin(), extensions.end(), FilePath(path).extension().generic_string()) != extensions.end())
-		{
-			switch (resourceType)
-			{
-			case ResourceFile::Type::Text:
-				result = CreateTextResourceFile(path);
-				break;
-			case ResourceFile::Type::Audio:
-				result = CreateAudioResourceFile(path);
-				break;
-			case ResourceFile::Type::Font:
-				result = CreateFontResourceFile(path);
-				break;
-			case ResourceFile::Type::Image:
-				result = CreateImageResourceFile(path);
-				break;
-			case ResourceFile::Type::Lua:
-				result = CreateLuaTextResourceFile(path);
-				break;
-			case ResourceFile::Type::Model:
-				result = CreateModelResourceFile(path);
-				break;
-			default:
-				break;
-			}
-		}
+		return nullptr;
 	}
-	return result;
+	return Wait(Request(path, type));
 }
 
 void ResourceLoader::RegisterAPI(sol::table& rootex)
@@ -351,204 +906,254 @@ void ResourceLoader::RegisterAPI(sol::table& rootex)
 	resourceLoader["CreateText"] = &ResourceLoader::CreateTextResourceFile;
 	resourceLoader["CreateNewText"] = &ResourceLoader::CreateNewTextResourceFile;
 	resourceLoader["CreateVisualModel"] = &ResourceLoader::CreateModelResourceFile;
+	resourceLoader["SetBudget"] = &ResourceLoader::SetBudget;
+	resourceLoader["GetBudget"] = &ResourceLoader::GetBudget;
+	resourceLoader["GetResidentBytes"] = &ResourceLoader::GetResidentBytes;
 }
 
-TextResourceFile* ResourceLoader::CreateTextResourceFile(const String& path)
+void ResourceLoader::Load(const Ref<ResourceEntry>& entry, const String& path, ResourceFile::Type type)
 {
-	for (auto& item : s_ResourcesDataFiles)
+	if (IsExists(path) == false)
 	{
-		if (item.first->getPath() == path && item.second->getType() == ResourceFile::Type::Text)
-		{
-			return reinterpret_cast<TextResourceFile*>(item.second.get());
-		}
+		ERR("File not found: " + path);
+		Fail(entry, type, path);
+		return;
 	}
 
-	if (OS::IsExists(path) == false)
+	switch (type)
 	{
-		ERR("File not found: " + path);
-		return nullptr;
+	case ResourceFile::Type::Text:
+	case ResourceFile::Type::Lua:
+		LoadTextFile(entry, path, type);
+		break;
+	case ResourceFile::Type::Audio:
+		LoadAudioFile(entry, path);
+		break;
+	case ResourceFile::Type::Model:
+		LoadModelFile(entry, path);
+		break;
+	case ResourceFile::Type::Image:
+		LoadImageFile(entry, path);
+		break;
+	case ResourceFile::Type::Font:
+		LoadFontFile(entry, path);
+		break;
+	default:
+		Fail(entry, type, path);
+		break;
 	}
+}
 
-	// File not found in cache, load it only once
-	FileBuffer& buffer = OS::LoadFileContents(path);
+void ResourceLoader::LoadTextFile(const Ref<ResourceEntry>& entry, const String& path, ResourceFile::Type type)
+{
+	// Text is edited in place, so it always gets a buffer of its own
+	FileContents contents;
+	OpenFile(path, contents);
+	if (contents.m_MappedFile)
+	{
+		contents.m_Buffer.assign(contents.m_Data, contents.m_Data + contents.m_Size);
+	}
+	FileBuffer& buffer = contents.m_Buffer;
 	ResourceData* resData = new ResourceData(path, buffer);
-	TextResourceFile* textRes = new TextResourceFile(ResourceFile::Type::Text, resData);
-
-	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(textRes);
-	return textRes;
+	if (type == ResourceFile::Type::Lua)
+	{
+		Finish(entry, resData, new LuaTextResourceFile(resData));
+	}
+	else
+	{
+		Finish(entry, resData, new TextResourceFile(ResourceFile::Type::Text, resData));
+	}
 }
 
-TextResourceFile* ResourceLoader::CreateNewTextResourceFile(const String& path)
+void ResourceLoader::LoadAudioFile(const Ref<ResourceEntry>& entry, const String& path)
 {
-	if (!OS::IsExists(path))
+	FileBuffer empty;
+	ResourceData* resData = new ResourceData(path, empty);
+	AudioResourceFile* audioRes = new AudioResourceFile(resData);
+	if (!ReadAudio(audioRes, path))
 	{
-		OS::CreateFileName(path);
+		delete audioRes;
+		delete resData;
+		Fail(entry, ResourceFile::Type::Audio, path);
+		return;
 	}
-	return CreateTextResourceFile(path);
+
+	Finish(entry, resData, audioRes);
 }
 
-LuaTextResourceFile* ResourceLoader::CreateLuaTextResourceFile(const String& path)
+bool ResourceLoader::ReadAudio(AudioResourceFile* audioRes, const String& path)
 {
-	for (auto& item : s_ResourcesDataFiles)
+	FileContents contents;
+	if (!OpenFile(path, contents) || contents.m_Size == 0)
 	{
-		if (item.first->getPath() == path && item.second->getType() == ResourceFile::Type::Lua)
+		ERR("Could not read audio file: " + path);
+		return false;
+	}
+
+	PCMSamples samples;
+	if (FindPCMSamples(contents.m_Data, contents.m_Size, samples))
+	{
+		if (contents.m_MappedFile && IsKeptMapped(contents))
+		{
+			// Samples are handed to OpenAL straight from the mapping and paged in when first played
+			audioRes->m_ResourceData->setMappedData(contents.m_MappedFile, samples.m_Data, samples.m_Size);
+		}
+		else
 		{
-			return reinterpret_cast<LuaTextResourceFile*>(item.second.get());
+			audioRes->m_ResourceData->setRawData(FileBuffer(samples.m_Data, samples.m_Data + samples.m_Size));
 		}
+		LoadALUT(audioRes, audioRes->m_ResourceData->getData(), samples.m_Format, samples.m_Size, samples.m_Frequency);
+		return true;
 	}
 
-	if (OS::IsExists(path) == false)
+	ALenum format;
+	ALsizei size;
+	ALfloat frequency;
+	void* decoded = nullptr;
+	ALUT_CHECK(decoded = alutLoadMemoryFromFileImage(contents.m_Data, contents.m_Size, &format, &size, &frequency));
+	if (!decoded)
 	{
-		ERR("File not found: " + path);
-		return nullptr;
+		ERR("Could not decode audio file: " + path);
+		return false;
 	}
 
-	// File not found in cache, load it only once
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
-	LuaTextResourceFile* luaRes = new LuaTextResourceFile(resData);
-
-	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(luaRes);
-
-	return luaRes;
+	audioRes->m_ResourceData->setRawData(FileBuffer((const char*)decoded, (const char*)decoded + size));
+	free(decoded);
+	LoadALUT(audioRes, audioRes->m_ResourceData->getData(), format, size, frequency);
+	return true;
 }
 
-AudioResourceFile* ResourceLoader::CreateAudioResourceFile(const String& path)
+void ResourceLoader::LoadModelFile(const Ref<ResourceEntry>& entry, const String& path)
 {
-	for (auto& item : s_ResourcesDataFiles)
-	{
-		if (item.first->getPath() == path && item.second->getType() == ResourceFile::Type::Audio)
-		{
-			return reinterpret_cast<AudioResourceFile*>(item.second.get());
-		}
-	}
+	ResourceData* resData = ReadOnlyResourceData(path);
+	ModelResourceFile* visualRes = new ModelResourceFile(resData);
 
-	if (OS::IsExists(path) == false)
+	Ref<ModelImport> import = ImportModel(path);
+	if (!import)
 	{
-		ERR("File not found: " + path);
-		return nullptr;
+		delete visualRes;
+		delete resData;
+		Fail(entry, ResourceFile::Type::Model, path);
+		return;
 	}
 
-	// File not found in cache, load it only once
-	const char* audioBuffer;
-	int format;
-	int size;
-	float frequency;
-	ALUT_CHECK(audioBuffer = (const char*)alutLoadMemoryFromFile(
-	               OS::GetAbsolutePath(path).generic_string().c_str(),
-	               &format,
-	               &size,
-	               &frequency));
-
-	Vector<char> dataArray;
-	dataArray.insert(
-	    dataArray.begin(),
-	    audioBuffer,
-	    audioBuffer + size);
-	ResourceData* resData = new ResourceData(path, dataArray);
+	Upload([=]() {
+		UploadModel(visualRes, *import);
+		Finish(entry, resData, visualRes);
+	});
+}
 
-	AudioResourceFile* audioRes = new AudioResourceFile(resData);
-	LoadALUT(audioRes, audioBuffer, format, size, frequency);
+void ResourceLoader::LoadImageFile(const Ref<ResourceEntry>& entry, const String& path)
+{
+	ResourceData* resData = ReadOnlyResourceData(path);
+	Finish(entry, resData, new ImageResourceFile(resData));
+}
 
-	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(audioRes);
+void ResourceLoader::LoadFontFile(const Ref<ResourceEntry>& entry, const String& path)
+{
+	ResourceData* resData = ReadOnlyResourceData(path);
 
-	return audioRes;
+	// Fonts are made into textures as soon as they are created
+	Upload([=]() {
+		Finish(entry, resData, new FontResourceFile(resData));
+	});
 }
 
-ModelResourceFile* ResourceLoader::CreateModelResourceFile(const String& path)
+ResourceHandle<TextResourceFile> ResourceLoader::CreateTextResourceFile(const String& path)
 {
-	for (auto& item : s_ResourcesDataFiles)
-	{
-		if (item.first->getPath() == path && item.second->getType() == ResourceFile::Type::Model)
-		{
-			return reinterpret_cast<ModelResourceFile*>(item.second.get());
-		}
-	}
+	return static_cast<TextResourceFile*>(Wait(Request(path, ResourceFile::Type::Text)));
+}
 
-	if (OS::IsExists(path) == false)
+ResourceHandle<TextResourceFile> ResourceLoader::CreateNewTextResourceFile(const String& path)
+{
+	if (!OS::IsExists(path))
 	{
-		ERR("File not found: " + path);
-		return nullptr;
+		OS::CreateFileName(path);
 	}
-	
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
-	ModelResourceFile* visualRes = new ModelResourceFile(resData);
-	
-	LoadAssimp(visualRes);
-
-	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(visualRes);
-
-	return visualRes;
+	return CreateTextResourceFile(path);
 }
 
-ImageResourceFile* ResourceLoader::CreateImageResourceFile(const String& path)
+ResourceHandle<LuaTextResourceFile> ResourceLoader::CreateLuaTextResourceFile(const String& path)
 {
-	for (auto& item : s_ResourcesDataFiles)
-	{
-		if (item.first->getPath() == path && item.second->getType() == ResourceFile::Type::Image)
-		{
-			return reinterpret_cast<ImageResourceFile*>(item.second.get());
-		}
-	}
+	return static_cast<LuaTextResourceFile*>(Wait(Request(path, ResourceFile::Type::Lua)));
+}
 
-	if (OS::IsExists(path) == false)
-	{
-		ERR("File not found: " + path);
-		return nullptr;
-	}
+ResourceHandle<AudioResourceFile> ResourceLoader::CreateAudioResourceFile(const String& path)
+{
+	return static_cast<AudioResourceFile*>(Wait(Request(path, ResourceFile::Type::Audio)));
+}
 
-	// File not found in cache, load it only once
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
-	ImageResourceFile* imageRes = new ImageResourceFile(resData);
+ResourceHandle<ModelResourceFile> ResourceLoader::CreateModelResourceFile(const String& path)
+{
+	return static_cast<ModelResourceFile*>(Wait(Request(path, ResourceFile::Type::Model)));
+}
 
-	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(imageRes);
+ResourceHandle<ImageResourceFile> ResourceLoader::CreateImageResourceFile(const String& path)
+{
+	return static_cast<ImageResourceFile*>(Wait(Request(path, ResourceFile::Type::Image)));
+}
 
-	return imageRes;
+ResourceHandle<FontResourceFile> ResourceLoader::CreateFontResourceFile(const String& path)
+{
+	return static_cast<FontResourceFile*>(Wait(Request(path, ResourceFile::Type::Font)));
 }
 
-FontResourceFile* ResourceLoader::CreateFontResourceFile(const String& path)
+void ResourceLoader::ReleaseMappings(const String& path)
 {
-	for (auto& item : s_ResourcesDataFiles)
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	ResourcePathID pathID = InternPath(path);
+	for (int type = (int)ResourceFile::Type::None + 1; type <= (int)ResourceFile::Type::Font; type++)
 	{
-		if (item.first->getPath() == path && item.second->getType() == ResourceFile::Type::Font)
+		auto findIt = s_Resources.find(GetKey(pathID, (ResourceFile::Type)type));
+		if (findIt != s_Resources.end() && findIt->second->m_State == ResourceEntry::State::Ready && findIt->second->m_Data->isMapped())
 		{
-			return reinterpret_cast<FontResourceFile*>(item.second.get());
+			// Copies the mapped bytes and unmaps the file
+			findIt->second->m_Data->getRawData();
+			if (type == (int)ResourceFile::Type::Audio)
+			{
+				// The samples moved into the copy
+				AudioResourceFile* audioRes = static_cast<AudioResourceFile*>(findIt->second->m_File.get());
+				audioRes->m_DecompressedAudioBuffer = findIt->second->m_Data->getData();
+			}
 		}
 	}
-
-	if (OS::IsExists(path) == false)
-	{
-		ERR("File not found: " + path);
-		return nullptr;
-	}
-
-	// File not found in cache, load it only once
-	FileBuffer& buffer = OS::LoadFileContents(path);
-	ResourceData* resData = new ResourceData(path, buffer);
-	FontResourceFile* fontRes = new FontResourceFile(resData);
-
-	s_ResourcesDataFiles[Ptr<ResourceData>(resData)] = Ptr<ResourceFile>(fontRes);
-
-	return fontRes;
 }
 
 void ResourceLoader::SaveResourceFile(ResourceFile* resourceFile)
 {
+	ReleaseMappings(resourceFile->getPath().generic_string());
 	bool saved = OS::SaveFile(resourceFile->getPath(), resourceFile->getData());
 	PANIC(saved == false, "Old resource could not be located for saving file: " + resourceFile->getPath().generic_string());
 }
 
 void ResourceLoader::ReloadResourceData(const String& path)
 {
-	FileBuffer& buffer = OS::LoadFileContents(path);
+	// The file may have been replaced, so map it again instead of trusting the old mapping
+	ReleaseMappings(path);
+	Ref<MappedFile> mappedFile = OS::MapFileContents(path);
 
-	for (auto&& [resData, resFile] : s_ResourcesDataFiles)
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	ResourcePathID pathID = InternPath(path);
+	for (int type = (int)ResourceFile::Type::None + 1; type <= (int)ResourceFile::Type::Font; type++)
 	{
-		if (resData->getPath() == path)
+		auto findIt = s_Resources.find(GetKey(pathID, (ResourceFile::Type)type));
+		if (findIt == s_Resources.end() || findIt->second->m_State != ResourceEntry::State::Ready)
 		{
-			*resData->getRawData() = buffer;
+			continue;
+		}
+
+		ResourceData* resData = findIt->second->m_Data.get();
+		if (resData->isMapped() && mappedFile)
+		{
+			resData->setMappedData(mappedFile, mappedFile->getData(), mappedFile->getSize());
+		}
+		else if (mappedFile)
+		{
+			resData->setRawData(FileBuffer(mappedFile->getData(), mappedFile->getData() + mappedFile->getSize()));
+		}
+		else
+		{
+			resData->setRawData(FileBuffer());
 		}
 	}
 }
@@ -556,7 +1161,7 @@ void ResourceLoader::ReloadResourceData(const String& path)
 void ResourceLoader::UpdateFileTimes(ResourceFile* file)
 {
 	file->m_LastReadTime = OS::s_FileSystemClock.now();
-	file->m_LastChangedTime = OS::GetFileLastChangedTime(file->getPath().string());
+	file->getLastChangedTime();
 }
 
 void ResourceLoader::Reload(TextResourceFile* file)
@@ -573,31 +1178,17 @@ void ResourceLoader::Reload(LuaTextResourceFile* file)
 void ResourceLoader::Reload(AudioResourceFile* file)
 {
 	UpdateFileTimes(file);
-	ReloadResourceData(file->getPath().string());
-	const char* audioBuffer;
-	int format;
-	int size;
-	float frequency;
-	ALUT_CHECK(audioBuffer = (const char*)alutLoadMemoryFromFile(
-	               OS::GetAbsolutePath(file->m_ResourceData->getPath().string()).string().c_str(),
-	               &format,
-	               &size,
-	               &frequency));
-	file->m_ResourceData->getRawData()->clear();
-	file->m_ResourceData->getRawData()->insert(
-	    file->m_ResourceData->getRawData()->begin(),
-	    audioBuffer,
-	    audioBuffer + size);
-
-	AudioResourceFile* audioRes = file;
-	LoadALUT(audioRes, audioBuffer, format, size, frequency);
+	ReadAudio(file, file->getPath().generic_string());
 }
 
 void ResourceLoader::Reload(ModelResourceFile* file)
 {
 	UpdateFileTimes(file);
 	ReloadResourceData(file->getPath().string());
-	LoadAssimp(file);
+	if (Ref<ModelImport> import = ImportModel(file->getPath().generic_string()))
+	{
+		UploadModel(file, *import);
+	}
 }
 
 void ResourceLoader::Reload(ImageResourceFile* file)
@@ -638,39 +1229,147 @@ int ResourceLoader::Preload(Vector<String> paths, Atomic<int>& progress)
 	for (auto& path : empericalPaths)
 	{
 		Ref<Task> loadingTask(new Task([=, &progress]() {
-			CreateSomeResourceFile(path);
-			progress++;
+			ResourceFile::Type type = GetType(path);
+			if (type == ResourceFile::Type::None)
+			{
+				progress++;
+				return;
+			}
+			Ref<ResourceEntry> entry = Request(path, type);
+			entry->m_IsPinned = true;
+			// Count the file once its device upload has run too, without holding the worker until then
+			Then(entry, [&progress]() { progress++; });
 		}));
+		// Imports can take far longer than a frame, keep them away from the main thread when it helps out
+		loadingTask->m_IsBackground = true;
 		preloadTasks.push_back(loadingTask);
 	}
 
-	// FIX: This is a workaround which saves the main thread from being blocked when 1 task is submitted
-	preloadTasks.push_back(Ref<Task>(new Task([]() {})));
-
 	preloadThreads.submit(preloadTasks);
 
 	PRINT("Preloading " + std::to_string(paths.size()) + " resource files");
-	return preloadTasks.size() - 1; // 1 less for the dummy task
+	return preloadTasks.size();
 }
 
 void ResourceLoader::Unload(const Vector<String>& paths)
 {
-	Vector<const Ptr<ResourceData>*> unloads;
-	for (auto& [data, file] : s_ResourcesDataFiles)
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	int unloaded = 0;
+	for (auto& path : paths)
 	{
-		for (auto& path : paths)
+		auto pathIt = s_PathIDs.find(NormalizePath(path));
+		if (pathIt == s_PathIDs.end())
 		{
-			if (data->getPath() == path)
+			continue;
+		}
+
+		for (int type = (int)ResourceFile::Type::None + 1; type <= (int)ResourceFile::Type::Font; type++)
+		{
+			auto findIt = s_Resources.find(GetKey(pathIt->second, (ResourceFile::Type)type));
+			if (findIt == s_Resources.end())
+			{
+				continue;
+			}
+			// Files still held by a handle stay loaded, they can be evicted once released
+			if (findIt->second->m_State == ResourceEntry::State::Ready && findIt->second->m_File->getHandleCount() > 0)
 			{
-				unloads.push_back(&data);
+				findIt->second->m_IsPinned = false;
+				continue;
 			}
+			s_Resources.erase(findIt);
+			unloaded++;
 		}
 	}
 
-	for (auto& dataPtr : unloads)
+	PRINT("Unloaded " + std::to_string(unloaded) + " resource files");
+}
+
+void ResourceLoader::SetBudget(ResourceFile::Type type, size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	if (bytes == 0)
+	{
+		s_Budgets.erase(type);
+	}
+	else
 	{
-		s_ResourcesDataFiles.erase(*dataPtr);
+		s_Budgets[type] = bytes;
 	}
+}
 
-	PRINT("Unloaded " + std::to_string(paths.size()) + " resource files");
+size_t ResourceLoader::GetBudget(ResourceFile::Type type)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	auto findIt = s_Budgets.find(type);
+	return findIt == s_Budgets.end() ? 0 : findIt->second;
+}
+
+size_t ResourceLoader::GetResidentBytes(ResourceFile::Type type)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	size_t bytes = 0;
+	for (auto& [key, entry] : s_Resources)
+	{
+		if (GetKeyType(key) == type && entry->m_State == ResourceEntry::State::Ready)
+		{
+			bytes += entry->m_Data->getRawDataByteSize();
+		}
+	}
+	return bytes;
+}
+
+int ResourceLoader::EvictToBudgets()
+{
+	// Evicted entries are destroyed after the lock is released, in case destroying a file requests another
+	Vector<Ref<ResourceEntry>> evicted;
+	{
+		std::lock_guard<std::mutex> lock(s_Mutex);
+		if (s_Budgets.empty())
+		{
+			return 0;
+		}
+
+		HashMap<ResourceFile::Type, size_t> residentBytes;
+		Vector<Pair<ResourceKey, ResourceEntry*>> candidates;
+		for (auto& [key, entry] : s_Resources)
+		{
+			if (entry->m_State != ResourceEntry::State::Ready)
+			{
+				continue;
+			}
+
+			ResourceFile::Type type = GetKeyType(key);
+			residentBytes[type] += entry->m_Data->getRawDataByteSize();
+			// Entries referenced outside the registry are still being handed to a caller of Request()
+			bool isHeld = entry->m_IsPinned || entry.use_count() > 1 || entry->m_File->getHandleCount() > 0;
+			if (s_Budgets.find(type) != s_Budgets.end() && !isHeld)
+			{
+				candidates.push_back({ key, entry.get() });
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Pair<ResourceKey, ResourceEntry*>& a, const Pair<ResourceKey, ResourceEntry*>& b) {
+			return a.second->m_LastUsed < b.second->m_LastUsed;
+		});
+
+		for (auto& [key, entry] : candidates)
+		{
+			ResourceFile::Type type = GetKeyType(key);
+			if (residentBytes[type] <= s_Budgets[type])
+			{
+				continue;
+			}
+
+			residentBytes[type] -= entry->m_Data->getRawDataByteSize();
+			auto findIt = s_Resources.find(key);
+			evicted.push_back(findIt->second);
+			s_Resources.erase(findIt);
+		}
+	}
+
+	if (!evicted.empty())
+	{
+		PRINT("Evicted " + std::to_string(evicted.size()) + " resource files to fit budgets");
+	}
+	return evicted.size();
 }
@@ -5,6 +5,9 @@
 #include "core/resource_file.h"
 #include "os/os.h"
 
+#include <mutex>
+#include <thread>
+
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -40,35 +43,171 @@ static const inline HashMap<ResourceFile::Type, Vector<String>> SupportedFiles =
 	}
 };
 
+/// Names of the file types, as used for resource budgets in application settings.
+static const inline HashMap<String, ResourceFile::Type> ResourceTypeNames = {
+	{ "Lua", ResourceFile::Type::Lua },
+	{ "Audio", ResourceFile::Type::Audio },
+	{ "Text", ResourceFile::Type::Text },
+	{ "Model", ResourceFile::Type::Model },
+	{ "Image", ResourceFile::Type::Image },
+	{ "Font", ResourceFile::Type::Font }
+};
+
 bool IsFileSupported(const String& extension, ResourceFile::Type supportedFileType);
 
+/// ID given to a resource path the first time it is seen. Paths that normalize to the same string share an ID.
+typedef unsigned int ResourcePathID;
+/// Key of a loaded resource, made from the ID of its path and its type.
+typedef uint64_t ResourceKey;
+
+/// Registry entry of a resource file that has been requested.
+struct ResourceEntry
+{
+	enum class State : int
+	{
+		/// Being read on some thread or waiting for its device upload
+		Loading,
+		Ready,
+		Failed
+	};
+
+	Atomic<State> m_State { State::Loading };
+	Ptr<ResourceData> m_Data;
+	Ptr<ResourceFile> m_File;
+	/// Value of the use clock when the file was last requested. Entries used least recently are evicted first.
+	Atomic<uint64_t> m_LastUsed { 0 };
+	/// Set for preloaded files, which have no handles until something is made from them.
+	Atomic<bool> m_IsPinned { false };
+	/// Jobs to run once the entry stops loading. Guarded by the registry lock.
+	Vector<Function<void()>> m_Continuations;
+};
+
+struct ModelImport;
+struct FileContents;
+class PakArchive;
+struct PakEntry;
+
+/// Files that are only read are mapped instead of copied into a buffer once they are at least this many bytes.
+#define RESOURCE_MAPPING_MIN_SIZE (64 * 1024)
+
 /// Factory for ResourceFile objects. Implements creating, loading and saving files.                                \n
 /// Maintains an internal cache that doesn't let the same file to be loaded twice. Cache misses force file loading. \n
 /// This just means you can load the same file multiple times without worrying about unnecessary copies.            \n
+/// The cache is keyed by the interned normalized path and the type of a file, so lookups take constant time.       \n
+/// Files can be requested from any thread. Requests for a file that is already loading wait for that load to finish.
+/// Reading and decoding run on the requesting thread, while work that needs the rendering device is queued to the thread that
+/// owns the device and runs in RunPendingUploads().                                                                  \n
 /// All path arguments should be relative to Rootex root.
 class ResourceLoader
 {
-	static HashMap<Ptr<ResourceData>, Ptr<ResourceFile>> s_ResourcesDataFiles;
-	
+	static std::mutex s_Mutex;
+	static HashMap<String, ResourcePathID> s_PathIDs;
+	static HashMap<ResourceKey, Ref<ResourceEntry>> s_Resources;
+
+	static const std::thread::id s_OwningThread;
+	static std::mutex s_UploadsMutex;
+	static Vector<Function<void()>> s_Uploads;
+	/// Searched from the most recently mounted one.
+	static Vector<Ref<PakArchive>> s_Archives;
+	/// Ticks on every request.
+	static Atomic<uint64_t> s_UseClock;
+	/// Bytes of data allowed to stay resident for each type with a budget. Guarded by the registry lock.
+	static HashMap<ResourceFile::Type, size_t> s_Budgets;
+
+	/// Needs the registry lock.
+	static ResourcePathID InternPath(const String& path);
+	static ResourceKey GetKey(ResourcePathID pathID, ResourceFile::Type type);
+	static ResourceFile::Type GetKeyType(ResourceKey key);
+	static ResourceFile::Type GetType(const String& path);
+
+	static const PakEntry* FindInArchives(const String& path, PakArchive*& archive);
+	/// Find the contents of a file in the mounted archives, then on disk. Returns false if the file could not be read.
+	static bool OpenFile(const String& path, FileContents& contents);
+	/// Read a file that is only ever read, referring to its mapping if it is archived or large enough.
+	static ResourceData* ReadOnlyResourceData(const String& path);
+	/// Copy the data of loaded files that refer to the mapping of a path, so the file is no longer mapped by them.
+	static void ReleaseMappings(const String& path);
+
+	/// Find the entry of a file, or add one if it was not requested before. Returns true if the caller has to load the added entry.
+	static bool Acquire(const String& path, ResourceFile::Type type, Ref<ResourceEntry>& entry);
+	/// Start loading a file, or join the load in flight. The returned entry may still be loading.
+	static Ref<ResourceEntry> Request(const String& path, ResourceFile::Type type);
+	/// Wait for an entry to stop loading. Returns its file, nullptr if loading failed.
+	static ResourceFile* Wait(const Ref<ResourceEntry>& entry);
+	/// Run job once the entry stops loading. Runs it right away if it has already stopped.
+	static void Then(const Ref<ResourceEntry>& entry, const Function<void()>& job);
+	static void Finish(const Ref<ResourceEntry>& entry, ResourceData* resourceData, ResourceFile* resourceFile);
+	static void Fail(const Ref<ResourceEntry>& entry, ResourceFile::Type type, const String& path);
+	/// Run job on the owning thread. Runs it right away when called from there.
+	static void Upload(const Function<void()>& job);
+
+	static void Load(const Ref<ResourceEntry>& entry, const String& path, ResourceFile::Type type);
+	static void LoadTextFile(const Ref<ResourceEntry>& entry, const String& path, ResourceFile::Type type);
+	static void LoadAudioFile(const Ref<ResourceEntry>& entry, const String& path);
+	static void LoadModelFile(const Ref<ResourceEntry>& entry, const String& path);
+	static void LoadImageFile(const Ref<ResourceEntry>& entry, const String& path);
+	static void LoadFontFile(const Ref<ResourceEntry>& entry, const String& path);
+
 	static void UpdateFileTimes(ResourceFile* file);
-	static void LoadAssimp(ModelResourceFile* file);
+	/// Read the cooked form of a model, falling back to importing it with Assimp and cooking it if that is missing or stale. Does not use the rendering device.
+	static Ref<ModelImport> ImportModel(const String& path);
+	static bool ImportCookedModel(const String& path, ModelImport& import);
+	static bool ImportAssimp(const String& path, ModelImport& import);
+	/// Create the materials and buffers of an imported model. Needs the owning thread.
+	static void UploadModel(ModelResourceFile* file, ModelImport& import);
+	static Ref<Material> UploadAssimpMaterial(ModelResourceFile* file, ModelImport& import, unsigned int material, Vector<Ref<Texture>>& textures);
+	static void AddMesh(ModelResourceFile* file, const Ref<Material>& material, const Mesh& mesh);
 	static void LoadALUT(AudioResourceFile* audioRes, const char* audioBuffer, int format, int size, float frequency);
+	/// Fill the data of an audio file with its samples. PCM WAV samples are referenced in place inside the mapped file or archive
+	/// when ReadOnlyResourceData would keep the file mapped, and copied otherwise.
+	/// Other formats are decoded by ALUT. Returns false if the file could not be read.
+	static bool ReadAudio(AudioResourceFile* audioRes, const String& path);
 
 public:
 	static void RegisterAPI(sol::table& rootex);
 
-	static const HashMap<Ptr<ResourceData>, Ptr<ResourceFile>>& GetResources() { return s_ResourcesDataFiles; };
+	/// Snapshot of the files that have finished loading.
+	static Vector<ResourceFile*> GetResources();
+
+	/// Make equivalent spellings of a path equal. Paths are compared case insensitively like the file system does.
+	static String NormalizePath(const String& path);
+	/// Make the files in an archive available to all loads. Files are looked up in archives before the disk, and archives mounted later
+	/// take precedence. Mount archives before any file is requested. Returns false if the archive could not be opened.
+	static bool MountArchive(const String& pakPath);
+	/// Returns true if the file is in a mounted archive or on disk.
+	static bool IsExists(const String& path);
+	/// Files directly inside a directory, in the mounted archives or on disk.
+	static Vector<FilePath> GetFilesInDirectory(const String& directory);
 
-	static TextResourceFile* CreateTextResourceFile(const String& path);
-	static TextResourceFile* CreateNewTextResourceFile(const String& path);
-	static LuaTextResourceFile* CreateLuaTextResourceFile(const String& path);
-	static AudioResourceFile* CreateAudioResourceFile(const String& path);
-	static ModelResourceFile* CreateModelResourceFile(const String& path);
-	static ImageResourceFile* CreateImageResourceFile(const String& path);
-	static FontResourceFile* CreateFontResourceFile(const String& path);
+	/// Limit the bytes of data that files of a type keep resident. A budget of 0 removes the limit.
+	static void SetBudget(ResourceFile::Type type, size_t bytes);
+	/// Returns 0 if files of the type have no budget.
+	static size_t GetBudget(ResourceFile::Type type);
+	/// Bytes of data held by the loaded files of a type.
+	static size_t GetResidentBytes(ResourceFile::Type type);
+	/// Evict the least recently requested files of every type that is over its budget, until it fits.
+	/// Files with a ResourceHandle, files still being requested and preloaded files are never evicted.
+	/// Call from the owning thread while no plain pointers to files are in use.
+	/// Returns the number of files evicted.
+	static int EvictToBudgets();
+
+	/// Files are returned with a handle, so they cannot be evicted before the caller stores them.
+	static ResourceHandle<TextResourceFile> CreateTextResourceFile(const String& path);
+	static ResourceHandle<TextResourceFile> CreateNewTextResourceFile(const String& path);
+	static ResourceHandle<LuaTextResourceFile> CreateLuaTextResourceFile(const String& path);
+	static ResourceHandle<AudioResourceFile> CreateAudioResourceFile(const String& path);
+	static ResourceHandle<ModelResourceFile> CreateModelResourceFile(const String& path);
+	static ResourceHandle<ImageResourceFile> CreateImageResourceFile(const String& path);
+	static ResourceHandle<FontResourceFile> CreateFontResourceFile(const String& path);
 	
 	/// Use when you don't know what kind of a resource file will it be
-	static ResourceFile* CreateSomeResourceFile(const String& path);
+	static ResourceHandle<ResourceFile> CreateSomeResourceFile(const String& path);
+
+	/// Run the device work queued by loads on other threads. Call regularly from the owning thread. Returns the number of jobs run.
+	static int RunPendingUploads();
+	/// Run queued device work until budgetMilliseconds have passed. Jobs left over stay queued in order. Returns the number of jobs run.
+	static int RunPendingUploads(float budgetMilliseconds);
+	static bool IsOwningThread() { return std::this_thread::get_id() == s_OwningThread; }
 	
 	/// Write the data buffer inside a ResourceFile to disk.
 	static void SaveResourceFile(ResourceFile* resourceFile);
@@ -83,6 +222,8 @@ public:
 	static void Reload(FontResourceFile* file);
 
 	/// Load all the files passed in, in a parellel manner. Return total tasks generated.
+	/// progress counts the files that have finished loading, including their device uploads.
+	/// Preloaded files are not evicted until they are unloaded.
 	static int Preload(Vector<String> paths, Atomic<int>& progress);
 	static void Unload(const Vector<String>& paths);
 };
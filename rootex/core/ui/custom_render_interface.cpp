@@ -4,8 +4,6 @@
 #include "renderer/rendering_device.h"
 #include "renderer/shaders/register_locations_vertex_shader.h"
 
-unsigned int CustomRenderInterface::s_TextureCount = 1; // 0 is reserved for white texture
-
 Variant CustomRenderInterface::windowResized(const Event* event)
 {
 	const Vector2& newSize = Extract(Vector2, event->getData());
@@ -15,8 +13,21 @@ Variant CustomRenderInterface::windowResized(const Event* event)
 }
 
 CustomRenderInterface::CustomRenderInterface(int width, int height)
-    : m_Width(width)
+    : m_BoundTexture(nullptr)
+    , m_Width(width)
     , m_Height(height)
+    , m_TransientVertexArena(UI_TRANSIENT_VERTICES * sizeof(UIVertexData), sizeof(UIVertexData))
+    , m_TransientIndexArena(UI_TRANSIENT_VERTICES * 2 * sizeof(int), sizeof(int))
+    , m_IsVertexDiscardPending(true)
+    , m_IsIndexDiscardPending(true)
+    , m_MappedVertices(nullptr)
+    , m_MappedIndices(nullptr)
+    , m_BatchTexture(nullptr)
+    , m_BatchBaseVertex(0)
+    , m_BatchStartIndex(0)
+    , m_BatchIndexCount(0)
+    , m_LastFrameDraws(0)
+    , m_Draws(0)
 {
 	BufferFormat format;
 	format.push(VertexBufferElement::Type::FloatFloat, "POSITION");
@@ -25,79 +36,283 @@ CustomRenderInterface::CustomRenderInterface(int width, int height)
 
 	m_UIShader.reset(new BasicShader(L"rootex/assets/shaders/ui_vertex_shader.cso", L"rootex/assets/shaders/ui_pixel_shader.cso", format));
 
-	m_Textures[0].reset(new Texture(ResourceLoader::CreateImageResourceFile("rootex/assets/white.png")));
+	// Untextured geometry samples the middle of a white block in the atlas, so it can be merged with textured geometry
+	UITexture white;
+	Vector<char> whitePixels(4 * 4 * 4, (char)255);
+	m_Atlas.insert(whitePixels.data(), 4, 4, white.m_Region);
+	white.m_Region.m_UVOffset += white.m_Region.m_UVScale * 0.5f;
+	white.m_Region.m_UVScale = Vector2::Zero;
+	white.m_IsLive = true;
+	m_Textures.push_back(white);
 }
 
-void CustomRenderInterface::RenderGeometry(Rml::Vertex* vertices, int numVertices, int* indices, int numIndices, Rml::TextureHandle texture, const Rml::Vector2f& translation) 
+void CustomRenderInterface::createTransientBuffers()
+{
+	D3D11_BUFFER_DESC vbd = { 0 };
+	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vbd.Usage = D3D11_USAGE_DYNAMIC;
+	vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	vbd.MiscFlags = 0u;
+	vbd.ByteWidth = m_TransientVertexArena.getCapacity();
+	vbd.StructureByteStride = sizeof(UIVertexData);
+	const UINT stride = sizeof(UIVertexData);
+	const UINT offset = 0u;
+	m_TransientVertices = RenderingDevice::GetSingleton()->createVB(&vbd, nullptr, &stride, &offset);
+
+	D3D11_BUFFER_DESC ibd = { 0 };
+	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	ibd.Usage = D3D11_USAGE_DYNAMIC;
+	ibd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	ibd.MiscFlags = 0u;
+	ibd.ByteWidth = m_TransientIndexArena.getCapacity();
+	ibd.StructureByteStride = sizeof(int);
+	m_TransientIndices = RenderingDevice::GetSingleton()->createIB(&ibd, nullptr, DXGI_FORMAT_R32_UINT);
+
+	m_IsVertexDiscardPending = true;
+	m_IsIndexDiscardPending = true;
+}
+
+void CustomRenderInterface::beginFrame()
+{
+	if (m_TransientVertexArena.getOverflowBytes() > 0 || m_TransientIndexArena.getOverflowBytes() > 0)
+	{
+		m_TransientVertexArena.resize(std::max(m_TransientVertexArena.getFrameBytes() + m_TransientVertexArena.getOverflowBytes(), m_TransientVertexArena.getCapacity() * 2));
+		m_TransientIndexArena.resize(std::max(m_TransientIndexArena.getFrameBytes() + m_TransientIndexArena.getOverflowBytes(), m_TransientIndexArena.getCapacity() * 2));
+		m_TransientVertices.Reset();
+		m_TransientIndices.Reset();
+	}
+
+	m_IsVertexDiscardPending |= m_TransientVertexArena.beginFrame();
+	m_IsIndexDiscardPending |= m_TransientIndexArena.beginFrame();
+
+	m_BoundTexture = nullptr;
+	m_LastFrameDraws = m_Draws;
+	m_Draws = 0;
+}
+
+Rml::TextureHandle CustomRenderInterface::addTexture(const UITexture& texture)
+{
+	Rml::TextureHandle handle;
+	if (m_FreeTextures.empty())
+	{
+		handle = m_Textures.size();
+		m_Textures.push_back(texture);
+	}
+	else
+	{
+		handle = m_FreeTextures.back();
+		m_FreeTextures.pop_back();
+		m_Textures[handle] = texture;
+	}
+	m_Textures[handle].m_IsLive = true;
+	return handle;
+}
+
+ID3D11ShaderResourceView* CustomRenderInterface::getTextureResourceView(Rml::TextureHandle texture) const
+{
+	const UITexture& uiTexture = m_Textures[texture];
+	if (uiTexture.m_Region.m_Page != -1)
+	{
+		return m_Atlas.getTextureResourceView(uiTexture.m_Region.m_Page);
+	}
+	return uiTexture.m_Texture->getTextureResourceView();
+}
+
+void CustomRenderInterface::bindTexture(ID3D11ShaderResourceView* texture)
+{
+	if (texture != m_BoundTexture)
+	{
+		RenderingDevice::GetSingleton()->setInPixelShader(0, 1, texture);
+		m_BoundTexture = texture;
+	}
+}
+
+void CustomRenderInterface::copyVertices(UIVertexData* destination, const Rml::Vertex* vertices, int numVertices, Rml::TextureHandle texture, const Rml::Vector2f& translation) const
 {
-	Vector<UIVertexData> vertexData;
-	vertexData.assign((UIVertexData*)vertices, (UIVertexData*)vertices + numVertices);
-	for (auto& vertex : vertexData)
+	const UIAtlasRegion& region = m_Textures[texture].m_Region;
+	for (int i = 0; i < numVertices; i++)
 	{
-		vertex.m_Position.x += translation.x;
-		vertex.m_Position.y += translation.y;
+		const Rml::Vertex& vertex = vertices[i];
+		UIVertexData& uiVertex = destination[i];
+		uiVertex.m_Position = Vector2(vertex.position.x + translation.x, vertex.position.y + translation.y);
+		memcpy(uiVertex.m_Color, &vertex.colour, sizeof(uiVertex.m_Color));
+		uiVertex.m_TextureCoord = Vector2(
+		    region.m_UVOffset.x + vertex.tex_coord.x * region.m_UVScale.x,
+		    region.m_UVOffset.y + vertex.tex_coord.y * region.m_UVScale.y);
 	}
-	VertexBuffer vb(vertexData);
-	Vector<int> indicesBuffer;
-	indicesBuffer.assign(indices, indices + numIndices);
-	IndexBuffer ib(indicesBuffer);
+}
+
+void CustomRenderInterface::bindTransform(const Rml::Vector2f& translation)
+{
+	Material::SetTransientVSConstantBuffer(
+	    VSSolidConstantBuffer(Matrix::CreateTranslation(translation.x, translation.y, 0.0f) * m_UITransform * Matrix::CreateOrthographic(m_Width, m_Height, 0.0f, 10000.0f)),
+	    m_ModelMatrixBuffer,
+	    PER_OBJECT_VS_CPP);
+}
 
-	vb.bind();
-	ib.bind();
+void CustomRenderInterface::flush()
+{
+	if (!m_MappedVertices)
+	{
+		return;
+	}
+
+	RenderingDevice::GetSingleton()->unmapBuffer(m_TransientVertices.Get());
+	RenderingDevice::GetSingleton()->unmapBuffer(m_TransientIndices.Get());
+	m_MappedVertices = nullptr;
+	m_MappedIndices = nullptr;
+
+	const UINT stride = sizeof(UIVertexData);
+	const UINT offset = 0u;
+	RenderingDevice::GetSingleton()->bind(m_TransientVertices.Get(), &stride, &offset);
+	RenderingDevice::GetSingleton()->bind(m_TransientIndices.Get(), DXGI_FORMAT_R32_UINT);
 	m_UIShader->bind();
+	bindTransform({ 0.0f, 0.0f });
+	bindTexture(m_BatchTexture);
+
+	RenderingDevice::GetSingleton()->drawIndexed(m_BatchIndexCount, m_BatchStartIndex, m_BatchBaseVertex);
+	m_BatchIndexCount = 0;
+	m_BatchTexture = nullptr;
+	m_Draws++;
+}
+
+void CustomRenderInterface::RenderGeometry(Rml::Vertex* vertices, int numVertices, int* indices, int numIndices, Rml::TextureHandle texture, const Rml::Vector2f& translation) 
+{
+	ID3D11ShaderResourceView* textureView = getTextureResourceView(texture);
+	if (textureView != m_BatchTexture)
+	{
+		flush();
+	}
+
+	size_t vertexOffset = m_TransientVertexArena.allocate(numVertices * sizeof(UIVertexData));
+	size_t indexOffset = m_TransientIndexArena.allocate(numIndices * sizeof(int));
+	if (vertexOffset == RingAllocator::InvalidOffset || indexOffset == RingAllocator::InvalidOffset)
+	{
+		// The arena grows at the start of the next frame, draw through temporary buffers until then
+		flush();
+		Rml::CompiledGeometryHandle geometry = CompileGeometry(vertices, numVertices, indices, numIndices, texture);
+		RenderCompiledGeometry(geometry, translation);
+		ReleaseCompiledGeometry(geometry);
+		return;
+	}
+
+	if (!m_TransientVertices)
+	{
+		createTransientBuffers();
+	}
 
-	Material::SetVSConstantBuffer(
-	    VSSolidConstantBuffer(m_UITransform * Matrix::CreateOrthographic(m_Width, m_Height, 0.0f, 10000.0f)), 
-		m_ModelMatrixBuffer,
-		PER_OBJECT_VS_CPP);
+	UINT baseVertex = vertexOffset / sizeof(UIVertexData);
+	UINT startIndex = indexOffset / sizeof(int);
+	if (!m_MappedVertices)
+	{
+		D3D11_MAPPED_SUBRESOURCE subresource;
+		RenderingDevice::GetSingleton()->mapBuffer(m_TransientVertices.Get(), subresource, m_IsVertexDiscardPending ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE);
+		m_MappedVertices = (UIVertexData*)subresource.pData;
+		RenderingDevice::GetSingleton()->mapBuffer(m_TransientIndices.Get(), subresource, m_IsIndexDiscardPending ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE);
+		m_MappedIndices = (int*)subresource.pData;
+		m_IsVertexDiscardPending = false;
+		m_IsIndexDiscardPending = false;
 
-	RenderingDevice::GetSingleton()->setInPixelShader(0, 1, m_Textures[texture]->getTextureResourceView());
-	RenderingDevice::GetSingleton()->drawIndexed(ib.getCount());
+		m_BatchTexture = textureView;
+		m_BatchBaseVertex = baseVertex;
+		m_BatchStartIndex = startIndex;
+	}
+
+	// Translation is applied here so that geometry of different elements can share a draw
+	copyVertices(m_MappedVertices + baseVertex, vertices, numVertices, texture, translation);
+	int rebase = baseVertex - m_BatchBaseVertex;
+	int* destination = m_MappedIndices + startIndex;
+	for (int i = 0; i < numIndices; i++)
+	{
+		destination[i] = indices[i] + rebase;
+	}
+	m_BatchIndexCount += numIndices;
 }
 
 Rml::CompiledGeometryHandle CustomRenderInterface::CompileGeometry(Rml::Vertex* vertices, int numVertices, int* indices, int numIndices, Rml::TextureHandle texture)
 {
-	return (Rml::CompiledGeometryHandle) nullptr;
+	Vector<UIVertexData> uiVertices(numVertices);
+	copyVertices(uiVertices.data(), vertices, numVertices, texture, { 0.0f, 0.0f });
+
+	UICompiledGeometry* geometry = new UICompiledGeometry();
+	geometry->m_VertexBuffer.reset(new VertexBuffer(uiVertices));
+	geometry->m_IndexBuffer.reset(new IndexBuffer(Vector<int>(indices, indices + numIndices)));
+	geometry->m_Texture = texture;
+	return (Rml::CompiledGeometryHandle)geometry;
 }
 
 void CustomRenderInterface::RenderCompiledGeometry(Rml::CompiledGeometryHandle geometry, const Rml::Vector2f& translation)
 {
+	flush();
+
+	UICompiledGeometry* compiledGeometry = (UICompiledGeometry*)geometry;
+	compiledGeometry->m_VertexBuffer->bind();
+	compiledGeometry->m_IndexBuffer->bind();
+	m_UIShader->bind();
+	bindTransform(translation);
+	bindTexture(getTextureResourceView(compiledGeometry->m_Texture));
+
+	RenderingDevice::GetSingleton()->drawIndexed(compiledGeometry->m_IndexBuffer->getCount());
+	m_Draws++;
 }
 
 void CustomRenderInterface::ReleaseCompiledGeometry(Rml::CompiledGeometryHandle geometry)
 {
+	delete (UICompiledGeometry*)geometry;
 }
 
 bool CustomRenderInterface::LoadTexture(Rml::TextureHandle& textureHandle, Rml::Vector2i& textureDimensions, const String& source)
 {
 	ImageResourceFile* image = ResourceLoader::CreateImageResourceFile(source);
-
-	if (image)
+	if (!image)
 	{
-		textureHandle = s_TextureCount;
-		m_Textures[textureHandle].reset(new Texture(image));
-		s_TextureCount++;
+		return false;
+	}
 
-		return true;
+	UITexture uiTexture;
+	uiTexture.m_Texture.reset(new Texture(image));
+	textureDimensions.x = uiTexture.m_Texture->getWidth();
+	textureDimensions.y = uiTexture.m_Texture->getHeight();
+	if (m_Atlas.insert(uiTexture.m_Texture.get(), uiTexture.m_Region))
+	{
+		uiTexture.m_Texture.reset();
 	}
-	return false;
+
+	textureHandle = addTexture(uiTexture);
+	return true;
 }
 
 bool CustomRenderInterface::GenerateTexture(Rml::TextureHandle& textureHandle, const byte* source, const Rml::Vector2i& sourceDimensions)
 {
-	textureHandle = s_TextureCount;
-	m_Textures[textureHandle].reset(new Texture((const char*)source, sourceDimensions.x, sourceDimensions.y));
-	s_TextureCount++;
-	return m_Textures[textureHandle] != nullptr;
+	UITexture uiTexture;
+	if (!m_Atlas.insert((const char*)source, sourceDimensions.x, sourceDimensions.y, uiTexture.m_Region))
+	{
+		uiTexture.m_Texture.reset(new Texture((const char*)source, sourceDimensions.x, sourceDimensions.y));
+	}
+
+	textureHandle = addTexture(uiTexture);
+	return true;
 }
 
 void CustomRenderInterface::ReleaseTexture(Rml::TextureHandle texture)
 {
-	m_Textures[texture].reset();
+	if (texture == 0 || texture >= m_Textures.size() || !m_Textures[texture].m_IsLive)
+	{
+		return;
+	}
+
+	// Pending geometry may still sample this texture
+	flush();
+
+	UITexture& uiTexture = m_Textures[texture];
+	m_Atlas.release(uiTexture.m_Region);
+	uiTexture = UITexture();
+	m_FreeTextures.push_back(texture);
 }
 
 void CustomRenderInterface::EnableScissorRegion(bool enable)
 {
+	flush();
 	if (enable)
 	{
 		RenderingDevice::GetSingleton()->setTemporaryUIScissoredRS();
@@ -110,11 +325,13 @@ void CustomRenderInterface::EnableScissorRegion(bool enable)
 
 void CustomRenderInterface::SetScissorRegion(int x, int y, int width, int height)
 {
+	flush();
 	RenderingDevice::GetSingleton()->setScissorRectangle(x, y, width, height);
 }
 
 void CustomRenderInterface::SetTransform(const Rml::Matrix4f* transform)
 {
+	flush();
 	if (!transform)
 	{
 		m_UITransform = Matrix::Identity;
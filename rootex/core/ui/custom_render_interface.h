@@ -1,30 +1,88 @@
 #pragma once
 
 #include "core/renderer/material_library.h"
+#include "core/renderer/index_buffer.h"
+#include "core/renderer/ring_allocator.h"
+#include "core/renderer/vertex_buffer.h"
 #include "event_manager.h"
+#include "ui_texture_atlas.h"
 
 #undef interface
 #include "RmlUi/Core.h"
 #define interface __STRUCT__
 
-class CustomRenderInterface : public Rml::RenderInterface
+/// Initial number of vertices in the transient UI geometry arena. The arena holds twice as many indices.
+#define UI_TRANSIENT_VERTICES 16384
+
+/// Entry of the UI texture handle table. Textures in the atlas only keep their region, larger ones keep their own texture.
+struct UITexture
 {
-	static unsigned int s_TextureCount;
+	Ref<Texture> m_Texture;
+	UIAtlasRegion m_Region;
+	bool m_IsLive = false;
+};
 
+/// Geometry compiled by RmlUi, kept on the GPU until RmlUi releases it.
+struct UICompiledGeometry
+{
+	Ptr<VertexBuffer> m_VertexBuffer;
+	Ptr<IndexBuffer> m_IndexBuffer;
+	Rml::TextureHandle m_Texture;
+};
+
+class CustomRenderInterface : public Rml::RenderInterface
+{
 	Ref<Shader> m_UIShader;
-	HashMap<unsigned int, Ref<Texture>> m_Textures;
+	UITextureAtlas m_Atlas;
+	/// Indexed by texture handle. Handle 0 is the white texture used by untextured geometry.
+	Vector<UITexture> m_Textures;
+	/// Handles of released textures, reused before the table grows.
+	Vector<unsigned int> m_FreeTextures;
+	ID3D11ShaderResourceView* m_BoundTexture;
 	Microsoft::WRL::ComPtr<ID3D11Buffer> m_ModelMatrixBuffer;
 	Matrix m_UITransform;
 	int m_Width;
 	int m_Height;
 
+	/// Geometry that RmlUi does not compile is appended to these buffers and drawn from them until the end of the frame.
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_TransientVertices;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_TransientIndices;
+	RingAllocator m_TransientVertexArena;
+	RingAllocator m_TransientIndexArena;
+	bool m_IsVertexDiscardPending;
+	bool m_IsIndexDiscardPending;
+
+	/// Consecutive transient geometry using the same texture is merged into one draw, with the buffers kept mapped until it is flushed.
+	UIVertexData* m_MappedVertices;
+	int* m_MappedIndices;
+	ID3D11ShaderResourceView* m_BatchTexture;
+	UINT m_BatchBaseVertex;
+	UINT m_BatchStartIndex;
+	UINT m_BatchIndexCount;
+	int m_LastFrameDraws;
+	int m_Draws;
+
 	Variant windowResized(const Event* event);
 
+	void createTransientBuffers();
+	Rml::TextureHandle addTexture(const UITexture& texture);
+	ID3D11ShaderResourceView* getTextureResourceView(Rml::TextureHandle texture) const;
+	void bindTexture(ID3D11ShaderResourceView* texture);
+	/// Copy RmlUi vertices moving them by translation and mapping their texture coordinates into the region of texture.
+	void copyVertices(UIVertexData* destination, const Rml::Vertex* vertices, int numVertices, Rml::TextureHandle texture, const Rml::Vector2f& translation) const;
+	/// Upload the UI transform, moved by translation, for the next draw.
+	void bindTransform(const Rml::Vector2f& translation);
+
 public:
 	CustomRenderInterface(int width, int height);
 	CustomRenderInterface(const CustomRenderInterface&) = delete;
 	virtual ~CustomRenderInterface() = default;
 
+	/// Start appending transient geometry for a new frame. Grows the arena if the last frame did not fit.
+	void beginFrame();
+	/// Draw the merged geometry that is still pending.
+	void flush();
+
 	virtual void RenderGeometry(Rml::Vertex* vertices, int numVertices, int* indices, int numIndices, Rml::TextureHandle texture, const Rml::Vector2f& translation) override;
 	
 	virtual Rml::CompiledGeometryHandle CompileGeometry(Rml::Vertex* vertices, int numVertices, int* indices, int numIndices, Rml::TextureHandle texture) override;
@@ -39,4 +97,8 @@ public:
 	virtual void SetScissorRegion(int x, int y, int width, int height) override;
 
 	virtual void SetTransform(const Rml::Matrix4f* transform) override;
+
+	const UITextureAtlas& getAtlas() const { return m_Atlas; }
+	int getLiveTextureCount() const { return m_Textures.size() - m_FreeTextures.size(); }
+	int getLastFrameDraws() const { return m_LastFrameDraws; }
 };
@@ -0,0 +1,113 @@
+#include "rectangle_packer.h"
+
+#include <algorithm>
+
+RectanglePacker::RectanglePacker(int width, int height)
+    : m_Width(width)
+    , m_Height(height)
+{
+	clear();
+}
+
+int RectanglePacker::fit(int index, int width, int height) const
+{
+	int x = m_Skyline[index].m_X;
+	if (x + width > m_Width)
+	{
+		return -1;
+	}
+
+	// The rectangle rests on the highest segment it spans
+	int y = 0;
+	int remaining = width;
+	while (remaining > 0)
+	{
+		y = std::max(y, m_Skyline[index].m_Y);
+		if (y + height > m_Height)
+		{
+			return -1;
+		}
+		remaining -= m_Skyline[index].m_Width;
+		index++;
+	}
+	return y;
+}
+
+bool RectanglePacker::insert(int width, int height, int& x, int& y)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	int bestIndex = -1;
+	int bestTop = m_Height + 1;
+	int bestWidth = m_Width + 1;
+	for (int i = 0; i < m_Skyline.size(); i++)
+	{
+		int nodeY = fit(i, width, height);
+		if (nodeY < 0)
+		{
+			continue;
+		}
+		// Prefer the lowest top edge, then the narrowest segment to waste less space
+		if (nodeY + height < bestTop || (nodeY + height == bestTop && m_Skyline[i].m_Width < bestWidth))
+		{
+			bestIndex = i;
+			bestTop = nodeY + height;
+			bestWidth = m_Skyline[i].m_Width;
+			x = m_Skyline[i].m_X;
+			y = nodeY;
+		}
+	}
+
+	if (bestIndex == -1)
+	{
+		return false;
+	}
+
+	m_Skyline.insert(m_Skyline.begin() + bestIndex, { x, bestTop, width });
+
+	// Shrink or remove the segments now covered by the new one
+	for (int i = bestIndex + 1; i < m_Skyline.size();)
+	{
+		SkylineNode& previous = m_Skyline[i - 1];
+		SkylineNode& node = m_Skyline[i];
+		int overlap = previous.m_X + previous.m_Width - node.m_X;
+		if (overlap <= 0)
+		{
+			break;
+		}
+		if (overlap < node.m_Width)
+		{
+			node.m_X += overlap;
+			node.m_Width -= overlap;
+			break;
+		}
+		m_Skyline.erase(m_Skyline.begin() + i);
+	}
+
+	// Merge neighbouring segments at the same height
+	for (int i = 0; i + 1 < m_Skyline.size();)
+	{
+		if (m_Skyline[i].m_Y == m_Skyline[i + 1].m_Y)
+		{
+			m_Skyline[i].m_Width += m_Skyline[i + 1].m_Width;
+			m_Skyline.erase(m_Skyline.begin() + i + 1);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	m_UsedArea += width * height;
+	return true;
+}
+
+void RectanglePacker::clear()
+{
+	m_Skyline.clear();
+	m_Skyline.push_back({ 0, 0, m_Width });
+	m_UsedArea = 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+/// Packs rectangles into a fixed size area with the skyline bottom left heuristic.
+/// The top edge of the packed rectangles is kept as a list of horizontal segments and each rectangle is placed where its top edge ends up lowest.
+/// Only positions are handed out and only the standard library is used, so the packer can be built and tested on its own.
+class RectanglePacker
+{
+	/// Horizontal segment of the skyline, starting at m_X and covering m_Width.
+	struct SkylineNode
+	{
+		int m_X;
+		int m_Y;
+		int m_Width;
+	};
+
+	int m_Width;
+	int m_Height;
+	int m_UsedArea;
+	std::vector<SkylineNode> m_Skyline;
+
+	/// Returns the lowest y at which a rectangle of width and height fits starting at the node at index, -1 if it does not fit.
+	int fit(int index, int width, int height) const;
+
+public:
+	RectanglePacker(int width, int height);
+	RectanglePacker(const RectanglePacker&) = default;
+	~RectanglePacker() = default;
+
+	/// Find room for a rectangle. Returns false if it does not fit, otherwise x and y are set to its top left corner.
+	bool insert(int width, int height, int& x, int& y);
+	/// Release all rectangles.
+	void clear();
+
+	int getWidth() const { return m_Width; }
+	int getHeight() const { return m_Height; }
+	/// Fraction of the area covered by rectangles.
+	float getOccupancy() const { return (float)m_UsedArea / (m_Width * m_Height); }
+};
@@ -0,0 +1,122 @@
+#include "ui_texture_atlas.h"
+
+#include "core/renderer/rendering_device.h"
+
+bool UITextureAtlas::allocate(int width, int height, UIAtlasRegion& region, int& x, int& y)
+{
+	if (width <= 0 || height <= 0 || width > UI_ATLAS_MAX_IMAGE_SIZE || height > UI_ATLAS_MAX_IMAGE_SIZE)
+	{
+		return false;
+	}
+
+	int paddedWidth = width + 2 * UI_ATLAS_PADDING;
+	int paddedHeight = height + 2 * UI_ATLAS_PADDING;
+	int page = 0;
+	for (; page < m_Pages.size(); page++)
+	{
+		if (m_Pages[page].m_Packer.insert(paddedWidth, paddedHeight, x, y))
+		{
+			break;
+		}
+	}
+
+	if (page == m_Pages.size())
+	{
+		Vector<char> emptyPixels(UI_ATLAS_SIZE * UI_ATLAS_SIZE * 4, 0);
+		m_Pages.push_back({ Ref<Texture>(new Texture(emptyPixels.data(), UI_ATLAS_SIZE, UI_ATLAS_SIZE)), RectanglePacker(UI_ATLAS_SIZE, UI_ATLAS_SIZE), 0 });
+		m_Pages.back().m_Packer.insert(paddedWidth, paddedHeight, x, y);
+	}
+
+	x += UI_ATLAS_PADDING;
+	y += UI_ATLAS_PADDING;
+	m_Pages[page].m_LiveRegions++;
+
+	region.m_Page = page;
+	region.m_UVOffset = Vector2((float)x / UI_ATLAS_SIZE, (float)y / UI_ATLAS_SIZE);
+	region.m_UVScale = Vector2((float)width / UI_ATLAS_SIZE, (float)height / UI_ATLAS_SIZE);
+	return true;
+}
+
+void UITextureAtlas::padEdges(int page, int x, int y, ID3D11Texture2D* source, int width, int height)
+{
+	RenderingDevice* device = RenderingDevice::GetSingleton();
+	ID3D11Texture2D* atlas = m_Pages[page].m_Texture->getD3D11Texture2D();
+	for (int i = 1; i <= UI_ATLAS_PADDING; i++)
+	{
+		device->copyTextureRegion(atlas, x, y - i, source, 0, 0, width, 1);
+		device->copyTextureRegion(atlas, x, y + height - 1 + i, source, 0, height - 1, width, 1);
+		device->copyTextureRegion(atlas, x - i, y, source, 0, 0, 1, height);
+		device->copyTextureRegion(atlas, x + width - 1 + i, y, source, width - 1, 0, 1, height);
+		for (int j = 1; j <= UI_ATLAS_PADDING; j++)
+		{
+			device->copyTextureRegion(atlas, x - i, y - j, source, 0, 0, 1, 1);
+			device->copyTextureRegion(atlas, x + width - 1 + i, y - j, source, width - 1, 0, 1, 1);
+			device->copyTextureRegion(atlas, x - i, y + height - 1 + j, source, 0, height - 1, 1, 1);
+			device->copyTextureRegion(atlas, x + width - 1 + i, y + height - 1 + j, source, width - 1, height - 1, 1, 1);
+		}
+	}
+}
+
+bool UITextureAtlas::insert(const char* pixels, int width, int height, UIAtlasRegion& region)
+{
+	int x;
+	int y;
+	if (!allocate(width, height, region, x, y))
+	{
+		return false;
+	}
+
+	// Pad on the CPU by clamping to the edges of the image, then upload the padded image in one go
+	int paddedWidth = width + 2 * UI_ATLAS_PADDING;
+	int paddedHeight = height + 2 * UI_ATLAS_PADDING;
+	Vector<char> paddedPixels(paddedWidth * paddedHeight * 4);
+	for (int row = 0; row < paddedHeight; row++)
+	{
+		int sourceRow = std::clamp(row - UI_ATLAS_PADDING, 0, height - 1);
+		for (int column = 0; column < paddedWidth; column++)
+		{
+			int sourceColumn = std::clamp(column - UI_ATLAS_PADDING, 0, width - 1);
+			memcpy(&paddedPixels[(row * paddedWidth + column) * 4], &pixels[(sourceRow * width + sourceColumn) * 4], 4);
+		}
+	}
+
+	RenderingDevice::GetSingleton()->updateTextureRegion(m_Pages[region.m_Page].m_Texture->getD3D11Texture2D(), x - UI_ATLAS_PADDING, y - UI_ATLAS_PADDING, paddedWidth, paddedHeight, paddedPixels.data());
+	return true;
+}
+
+bool UITextureAtlas::insert(const Texture* texture, UIAtlasRegion& region)
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	texture->getD3D11Texture2D()->GetDesc(&textureDesc);
+	// Regions can only be copied between textures of the same format
+	if (textureDesc.Format != DXGI_FORMAT_R8G8B8A8_UNORM || textureDesc.SampleDesc.Count != 1 || textureDesc.ArraySize != 1)
+	{
+		return false;
+	}
+
+	int x;
+	int y;
+	if (!allocate(texture->getWidth(), texture->getHeight(), region, x, y))
+	{
+		return false;
+	}
+
+	RenderingDevice::GetSingleton()->copyTextureRegion(m_Pages[region.m_Page].m_Texture->getD3D11Texture2D(), x, y, texture->getD3D11Texture2D());
+	padEdges(region.m_Page, x, y, texture->getD3D11Texture2D(), texture->getWidth(), texture->getHeight());
+	return true;
+}
+
+void UITextureAtlas::release(const UIAtlasRegion& region)
+{
+	if (region.m_Page < 0)
+	{
+		return;
+	}
+
+	Page& page = m_Pages[region.m_Page];
+	page.m_LiveRegions--;
+	if (page.m_LiveRegions == 0)
+	{
+		page.m_Packer.clear();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "common/common.h"
+#include "core/renderer/texture.h"
+#include "rectangle_packer.h"
+
+/// Width and height of an atlas page in pixels.
+#define UI_ATLAS_SIZE 2048
+/// Images larger than this along either side get their own texture instead of a place in an atlas page.
+#define UI_ATLAS_MAX_IMAGE_SIZE 256
+/// Pixels kept around every image so that filtering does not sample its neighbours. They repeat the edge pixels of the image.
+#define UI_ATLAS_PADDING 1
+
+/// Place of an image inside a UITextureAtlas. Texture coordinates of the image map to m_UVOffset + uv * m_UVScale.
+struct UIAtlasRegion
+{
+	/// Index of the atlas page, -1 if the image is not in the atlas.
+	int m_Page = -1;
+	Vector2 m_UVOffset = { 0.0f, 0.0f };
+	Vector2 m_UVScale = { 1.0f, 1.0f };
+};
+
+/// Packs small UI images and glyph pages into a few large textures, so UI geometry using different images can share one texture bind.
+/// Pages are added when the existing ones are full. The space of a page is reused once every image in it has been released.
+class UITextureAtlas
+{
+	struct Page
+	{
+		Ref<Texture> m_Texture;
+		RectanglePacker m_Packer;
+		int m_LiveRegions;
+	};
+
+	Vector<Page> m_Pages;
+
+	/// Find room for an image in a page, adding a page if needed. Returns false if the image is too large for the atlas.
+	bool allocate(int width, int height, UIAtlasRegion& region, int& x, int& y);
+	/// Fill the padding around the image at x, y with copies of the edge pixels of source, so bilinear filtering at its edges does not blend in empty pixels.
+	/// Copies are read from source because Direct3D 11 cannot copy between regions of the same texture.
+	void padEdges(int page, int x, int y, ID3D11Texture2D* source, int width, int height);
+
+public:
+	UITextureAtlas() = default;
+	UITextureAtlas(UITextureAtlas&) = delete;
+	~UITextureAtlas() = default;
+
+	/// Copy tightly packed RGBA pixels into the atlas. Returns false if the image does not belong in the atlas.
+	bool insert(const char* pixels, int width, int height, UIAtlasRegion& region);
+	/// Copy the top mip of an RGBA texture into the atlas. Returns false if the texture does not belong in the atlas.
+	bool insert(const Texture* texture, UIAtlasRegion& region);
+	void release(const UIAtlasRegion& region);
+
+	ID3D11ShaderResourceView* getTextureResourceView(int page) const { return m_Pages[page].m_Texture->getTextureResourceView(); }
+	int getPageCount() const { return m_Pages.size(); }
+	float getOccupancy(int page) const { return m_Pages[page].m_Packer.getOccupancy(); }
+};
@@ -2,6 +2,7 @@
 
 Component::Component()
     : m_Owner(nullptr)
+    , m_SystemIndex(-1)
 {
 }
 
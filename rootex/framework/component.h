@@ -3,6 +3,7 @@
 #include "common/common.h"
 #include "script/interpreter.h"
 #include "components/component_ids.h"
+#include "component_pool.h"
 
 typedef unsigned int ComponentID;
 
@@ -12,6 +13,10 @@ class Component
 	void setOwner(Ref<Entity>& newOwner) { m_Owner = newOwner; }
 	friend class EntityFactory;
 
+	/// Position of this component in System::s_Components. -1 if not registered.
+	int m_SystemIndex;
+	friend class System;
+
 protected:
 	Ref<Entity> m_Owner;
 	
@@ -30,6 +35,8 @@ public:
 	virtual void onTrigger();
 
 	Ref<Entity> getOwner() const;
+	/// Returns true if systems update this component.
+	bool isRegistered() const { return m_SystemIndex != -1; }
 	virtual ComponentID getComponentID() const = 0;
 	virtual String getName() const = 0;
 	/// Get JSON representation of the component data needed to re-construct component from memory.
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "common/common.h"
+
+/// Number of components stored contiguously in one chunk of a ComponentPool.
+#define COMPONENT_POOL_CHUNK_SIZE 1024
+
+/// Allocator that packs components of the same class next to each other in chunks of contiguous memory.
+/// Chunks are never moved while the pool lives so pointers to pooled components stay valid.
+/// Freed slots are reused before new chunks are allocated, and a component is found in its chunk in logarithmic time.
+/// Components should be created and destroyed on the main thread only.
+template <class ComponentType>
+class ComponentPool
+{
+	struct Chunk
+	{
+		alignas(ComponentType) char m_Data[sizeof(ComponentType) * COMPONENT_POOL_CHUNK_SIZE];
+		bool m_IsAlive[COMPONENT_POOL_CHUNK_SIZE];
+		/// Position of the chunk in m_Chunks.
+		int m_Index;
+
+		ComponentType* at(int slot) { return reinterpret_cast<ComponentType*>(m_Data) + slot; }
+		int slotOf(const void* component) const { return (static_cast<const char*>(component) - m_Data) / sizeof(ComponentType); }
+		bool contains(const void* component) const { return !std::less<const void*>()(component, m_Data) && std::less<const void*>()(component, m_Data + sizeof(m_Data)); }
+	};
+
+	Vector<Ptr<Chunk>> m_Chunks;
+	/// Chunks sorted by address, to find the chunk of a component with a binary search.
+	Vector<Chunk*> m_ChunksByAddress;
+	/// Min heap of free slots, numbered across chunks in creation order.
+	/// The lowest numbered slot is reused first so live components stay packed at the front of the pool.
+	Vector<int> m_FreeSlots;
+	int m_Count = 0;
+	bool m_IsBypassed = false;
+
+	void addChunk()
+	{
+		Chunk* chunk = new Chunk();
+		std::fill(std::begin(chunk->m_IsAlive), std::end(chunk->m_IsAlive), false);
+		chunk->m_Index = m_Chunks.size();
+		m_Chunks.emplace_back(chunk);
+		m_ChunksByAddress.insert(std::upper_bound(m_ChunksByAddress.begin(), m_ChunksByAddress.end(), chunk, std::less<Chunk*>()), chunk);
+
+		for (int slot = 0; slot < COMPONENT_POOL_CHUNK_SIZE; slot++)
+		{
+			m_FreeSlots.push_back(chunk->m_Index * COMPONENT_POOL_CHUNK_SIZE + slot);
+			std::push_heap(m_FreeSlots.begin(), m_FreeSlots.end(), std::greater<int>());
+		}
+	}
+
+	Chunk* findChunk(const void* component) const
+	{
+		auto chunkIt = std::upper_bound(m_ChunksByAddress.begin(), m_ChunksByAddress.end(), component, [](const void* component, const Chunk* chunk) {
+			return std::less<const void*>()(component, chunk->m_Data);
+		});
+		if (chunkIt == m_ChunksByAddress.begin() || !(*(chunkIt - 1))->contains(component))
+		{
+			return nullptr;
+		}
+		return *(chunkIt - 1);
+	}
+
+public:
+	ComponentPool() = default;
+	ComponentPool(ComponentPool&) = delete;
+	~ComponentPool() = default;
+
+	/// Reserve uninitialized memory for one component.
+	void* allocate()
+	{
+		if (m_FreeSlots.empty())
+		{
+			addChunk();
+		}
+
+		std::pop_heap(m_FreeSlots.begin(), m_FreeSlots.end(), std::greater<int>());
+		int freeSlot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+
+		Chunk* chunk = m_Chunks[freeSlot / COMPONENT_POOL_CHUNK_SIZE].get();
+		int slot = freeSlot % COMPONENT_POOL_CHUNK_SIZE;
+		chunk->m_IsAlive[slot] = true;
+		m_Count++;
+
+		return chunk->at(slot);
+	}
+
+	/// Return memory reserved by allocate(). The component should already be destructed.
+	void deallocate(void* memory)
+	{
+		Chunk* chunk = findChunk(memory);
+		if (!chunk)
+		{
+			ERR("Tried to free a component which does not belong to the pool");
+			return;
+		}
+
+		int slot = chunk->slotOf(memory);
+		chunk->m_IsAlive[slot] = false;
+		m_FreeSlots.push_back(chunk->m_Index * COMPONENT_POOL_CHUNK_SIZE + slot);
+		std::push_heap(m_FreeSlots.begin(), m_FreeSlots.end(), std::greater<int>());
+		m_Count--;
+	}
+
+	bool isOwned(const void* memory) const { return findChunk(memory) != nullptr; }
+
+	/// Allocate new components from the heap instead, to compare the pool against the heap in benchmarks.
+	void setBypassed(bool enabled) { m_IsBypassed = enabled; }
+	bool isBypassed() const { return m_IsBypassed; }
+
+	/// Call function on every live component, in the order they are laid out in memory.
+	template <class FunctionType>
+	void forEach(FunctionType&& function)
+	{
+		for (auto& chunk : m_Chunks)
+		{
+			for (int slot = 0; slot < COMPONENT_POOL_CHUNK_SIZE; slot++)
+			{
+				if (chunk->m_IsAlive[slot])
+				{
+					function(chunk->at(slot));
+				}
+			}
+		}
+	}
+
+	int getCount() const { return m_Count; }
+	int getCapacity() const { return m_Chunks.size() * COMPONENT_POOL_CHUNK_SIZE; }
+};
+
+/// Allocate objects of ComponentClass from ComponentClass::GetPool() instead of the heap. 
+/// Derived classes of a different size keep using the heap.
+#define DEFINE_COMPONENT_POOL(ComponentClass)                                               \
+public:                                                                                     \
+	static ComponentPool<ComponentClass>& GetPool()                                         \
+	{                                                                                       \
+		/* Never destructed, components may be released after static destruction starts */ \
+		static ComponentPool<ComponentClass>* pool = new ComponentPool<ComponentClass>();   \
+		return *pool;                                                                       \
+	}                                                                                       \
+	static void* operator new(size_t size)                                                  \
+	{                                                                                       \
+		if (size == sizeof(ComponentClass) && !GetPool().isBypassed())                      \
+		{                                                                                   \
+			return GetPool().allocate();                                                    \
+		}                                                                                   \
+		return ::operator new(size);                                                        \
+	}                                                                                       \
+	static void operator delete(void* memory, size_t size)                                  \
+	{                                                                                       \
+		if (size == sizeof(ComponentClass) && GetPool().isOwned(memory))                    \
+		{                                                                                   \
+			GetPool().deallocate(memory);                                                   \
+			return;                                                                         \
+		}                                                                                   \
+		::operator delete(memory);                                                          \
+	}
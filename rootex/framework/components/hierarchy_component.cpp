@@ -1,6 +1,7 @@
 #include "hierarchy_component.h"
 #include "entity_factory.h"
 #include "event_manager.h"
+#include "systems/hierarchy_system.h"
 
 Component* HierarchyComponent::Create(const JSON::json& componentData)
 {
@@ -42,6 +43,7 @@ bool HierarchyComponent::addChild(Ref<Entity> child)
 		m_ChildrenIDs.push_back(child->getID());
 		child->getComponent<HierarchyComponent>()->m_Parent = this;
 		child->getComponent<HierarchyComponent>()->m_ParentID = this->m_Owner->getID();
+		HierarchySystem::InvalidateTransformOrder();
 		return true;
 	}
 	return false;
@@ -49,6 +51,7 @@ bool HierarchyComponent::addChild(Ref<Entity> child)
 
 bool HierarchyComponent::setupEntities()
 {
+	HierarchySystem::InvalidateTransformOrder();
 	if (m_Owner->getID() != ROOT_ENTITY_ID)
 	{
 		Ref<Entity> parent = EntityFactory::GetSingleton()->findEntity(m_ParentID);
@@ -102,6 +105,7 @@ bool HierarchyComponent::removeChild(Ref<Entity> node)
 
 		m_Children.erase(findItPtr);
 		m_ChildrenIDs.erase(findIt);
+		HierarchySystem::InvalidateTransformOrder();
 
 		return true;
 	}
@@ -122,6 +126,7 @@ void HierarchyComponent::clear()
 	m_ParentID = INVALID_ID;
 	m_Children.clear();
 	m_ChildrenIDs.clear();
+	HierarchySystem::InvalidateTransformOrder();
 }
 
 void HierarchyComponent::onRemove()
@@ -22,6 +22,7 @@ protected:
 public:
 	static void RegisterAPI(sol::table& rootex);
 	static const ComponentID s_ID = (ComponentID)ComponentIDs::HierarchyComponent;
+	DEFINE_COMPONENT_POOL(HierarchyComponent);
 
 	HierarchyComponent(EntityID parentID, const Vector<EntityID>& childrenIDs);
 	HierarchyComponent(HierarchyComponent&) = delete;
@@ -14,7 +14,7 @@ class MusicComponent : public AudioComponent
 
 	Ref<StreamingAudioSource> m_StreamingAudioSource;
 	Ref<StreamingAudioBuffer> m_StreamingAudioBuffer;
-	AudioResourceFile* m_AudioFile;
+	ResourceHandle<AudioResourceFile> m_AudioFile;
 
 	MusicComponent(AudioResourceFile* audioFile, bool playOnStart, bool attenuation, AudioSource::AttenuationModel model, ALfloat rolloffFactor, ALfloat referenceDistance, ALfloat maxDistance);
 	virtual ~MusicComponent();
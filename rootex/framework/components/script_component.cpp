@@ -19,7 +19,7 @@ ScriptComponent::ScriptComponent(const Vector<String>& luaFilePaths)
 {
 	for (auto& path : luaFilePaths)
 	{
-		if (!OS::IsExists(path))
+		if (!ResourceLoader::IsExists(path))
 		{
 			ERR("Could not find script file: " + path);
 			continue;
@@ -40,7 +40,15 @@ bool ScriptComponent::setup()
 	{
 		for (int i = 0; i < m_ScriptFiles.size(); i++)
 		{
-			LuaInterpreter::GetSingleton()->getLuaState().script_file(m_ScriptFiles[i], m_ScriptEnvironments[i]);
+			// Scripts may be packed in an archive, so they are read through the resource loader instead of from disk
+			ResourceHandle<LuaTextResourceFile> script = ResourceLoader::CreateLuaTextResourceFile(m_ScriptFiles[i]);
+			if (!script)
+			{
+				ERR("Could not load script file: " + m_ScriptFiles[i]);
+				status = false;
+				continue;
+			}
+			LuaInterpreter::GetSingleton()->getLuaState().script(script->getString(), m_ScriptEnvironments[i], "@" + m_ScriptFiles[i]);
 		}
 	}
 	catch (std::exception e)
@@ -14,7 +14,7 @@ class ShortMusicComponent : public AudioComponent
 
 	Ref<StaticAudioSource> m_StaticAudioSource;
 	Ref<StaticAudioBuffer> m_StaticAudioBuffer;
-	AudioResourceFile* m_AudioFile;
+	ResourceHandle<AudioResourceFile> m_AudioFile;
 
 	ShortMusicComponent(AudioResourceFile* audioFile, bool playOnStart, bool attenuation, AudioSource::AttenuationModel model, ALfloat rolloffFactor, ALfloat referenceDistance, ALfloat maxDistance);
 	virtual ~ShortMusicComponent();
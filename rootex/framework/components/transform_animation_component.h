@@ -56,6 +56,7 @@ private:
 
 public:
 	static const ComponentID s_ID = (ComponentID)ComponentIDs::TransformAnimationComponent;
+	DEFINE_COMPONENT_POOL(TransformAnimationComponent);
 
 	virtual bool setup() override;
 
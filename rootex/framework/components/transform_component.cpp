@@ -4,6 +4,7 @@
 #include <math.h>
 
 #include "entity.h"
+#include "systems/spatial_system.h"
 
 Component* TransformComponent::Create(const JSON::json& componentData)
 {
@@ -35,15 +36,20 @@ Component* TransformComponent::CreateDefault()
 
 void TransformComponent::updateTransformFromPositionRotationScale()
 {
-	m_TransformBuffer.m_Transform = Matrix::Identity;
-	m_TransformBuffer.m_Transform = Matrix::CreateTranslation(m_TransformBuffer.m_Position) * m_TransformBuffer.m_Transform;
-	m_TransformBuffer.m_Transform = Matrix::CreateFromQuaternion(m_TransformBuffer.m_Rotation) * m_TransformBuffer.m_Transform;
-	m_TransformBuffer.m_Transform = Matrix::CreateScale(m_TransformBuffer.m_Scale) * m_TransformBuffer.m_Transform;
+	// Fused Scale * Rotation * Translation. Scaling only touches the rotation rows and translation only the last row
+	DirectX::XMMATRIX transform = DirectX::XMMatrixRotationQuaternion(DirectX::XMLoadFloat4(&m_TransformBuffer.m_Rotation));
+	transform.r[0] = DirectX::XMVectorScale(transform.r[0], m_TransformBuffer.m_Scale.x);
+	transform.r[1] = DirectX::XMVectorScale(transform.r[1], m_TransformBuffer.m_Scale.y);
+	transform.r[2] = DirectX::XMVectorScale(transform.r[2], m_TransformBuffer.m_Scale.z);
+	transform.r[3] = DirectX::XMVectorSetW(DirectX::XMLoadFloat3(&m_TransformBuffer.m_Position), 1.0f);
+	DirectX::XMStoreFloat4x4(&m_TransformBuffer.m_Transform, transform);
+	m_IsDirty = true;
 }
 
 void TransformComponent::updatePositionRotationScaleFromTransform(Matrix& transform)
 {
 	transform.Decompose(m_TransformBuffer.m_Scale, m_TransformBuffer.m_Rotation, m_TransformBuffer.m_Position);
+	m_IsDirty = true;
 }
 
 TransformComponent::TransformComponent(const Vector3& position, const Vector4& rotation, const Vector3& scale, const BoundingBox& bounds)
@@ -60,6 +66,11 @@ TransformComponent::TransformComponent(const Vector3& position, const Vector4& r
 #endif // ROOTEX_EDITOR
 }
 
+void TransformComponent::onRemove()
+{
+	SpatialSystem::GetSingleton()->removeTransform(this);
+}
+
 void TransformComponent::RegisterAPI(sol::table& rootex)
 {
 	sol::usertype<TransformComponent> transformComponent = rootex.new_usertype<TransformComponent>(
@@ -114,6 +125,7 @@ void TransformComponent::setTransform(const Matrix& transform)
 void TransformComponent::setBounds(const BoundingBox& bounds)
 {
 	m_TransformBuffer.m_BoundingBox = bounds;
+	m_IsDirty = true;
 }
 
 void TransformComponent::setRotationPosition(const Matrix& transform)
@@ -28,6 +28,10 @@ private:
 	TransformBuffer m_TransformBuffer;
 	
 	Matrix m_ParentAbsoluteTransform;
+	/// Set when the local transform changes, cleared by HierarchySystem after propagating it to the children.
+	bool m_IsDirty = true;
+	/// Proxy of the world bounds in the SpatialSystem. -1 while not indexed.
+	int m_SpatialProxy = -1;
 	bool m_LockScale = false;
 
 	const TransformBuffer* getTransformBuffer() const { return &m_TransformBuffer; };
@@ -40,6 +44,8 @@ private:
 
 	friend class ModelComponent;
 	friend class RenderSystem;
+	friend class HierarchySystem;
+	friend class SpatialSystem;
 	friend class EntityFactory;
 
 #ifdef ROOTEX_EDITOR
@@ -52,9 +58,12 @@ public:
 	static void RegisterAPI(sol::table& rootex);
 
 	static const ComponentID s_ID = (ComponentID)ComponentIDs::TransformComponent;
+	DEFINE_COMPONENT_POOL(TransformComponent);
 
 	virtual ~TransformComponent() = default;
 
+	void onRemove() override;
+
 	void setPosition(const Vector3& position);
 	void setRotation(const float& yaw, const float& pitch, const float& roll);
 	void setRotationQuaternion(const Quaternion& rotation);
@@ -73,6 +82,8 @@ public:
 	const Matrix& getLocalTransform() const { return m_TransformBuffer.m_Transform; }
 	Matrix getRotationPosition() const { return Matrix::CreateFromQuaternion(m_TransformBuffer.m_Rotation) * Matrix::CreateTranslation(m_TransformBuffer.m_Position) * m_ParentAbsoluteTransform; }
 	Matrix getAbsoluteTransform() const { return m_TransformBuffer.m_Transform * m_ParentAbsoluteTransform; }
+	/// Translation of the absolute transform, without multiplying the full matrices.
+	Vector3 getAbsolutePosition() const { return Vector3::Transform(m_TransformBuffer.m_Transform.Translation(), m_ParentAbsoluteTransform); }
 	Matrix getParentAbsoluteTransform() const { return m_ParentAbsoluteTransform; }
 	ComponentID getComponentID() const override { return s_ID; }
 	virtual String getName() const override { return "TransformComponent"; }
@@ -57,6 +57,8 @@ public:
 	TransformComponent* getTransformComponent() { return m_TransformComponent; }
 	virtual const Matrix& getViewMatrix();
 	virtual const Matrix& getProjectionMatrix();
+	float getNear() const { return m_Near; }
+	float getFar() const { return m_Far; }
 	Vector3 getAbsolutePosition() const { return m_TransformComponent->getAbsoluteTransform().Translation(); }
 	virtual String getName() const override { return "CameraComponent"; }
 
@@ -1,11 +1,22 @@
 #include "cpu_particles_component.h"
 
+#include "app/application.h"
 #include "random.h"
 #include "resource_loader.h"
 #include "systems/render_system.h"
 #include "timer.h"
 
 #include "renderer/material_library.h"
+#include "renderer/shader_library.h"
+
+/// Xorshift generator used while emitting, so that emission tasks do not share any random state.
+static float NextFloat(unsigned int& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return (state >> 8) * (1.0f / 16777216.0f);
+}
 
 Component* CPUParticlesComponent::Create(const JSON::json& componentData)
 {
@@ -66,12 +77,13 @@ Component* CPUParticlesComponent::CreateDefault()
 }
 
 CPUParticlesComponent::CPUParticlesComponent(size_t poolSize, const String& particleModelPath, const String& materialPath, const ParticleTemplate& particleTemplate, bool visibility, unsigned int renderPass, EmitMode emitMode, const Vector3& emitterDimensions)
-    : ModelComponent(renderPass, ResourceLoader::CreateModelResourceFile(particleModelPath), {}, visibility, {})
+    : ModelComponent(renderPass, ResourceLoader::CreateModelResourceFile(particleModelPath), {}, visibility, {}, true)
     , m_BasicMaterial(std::dynamic_pointer_cast<BasicMaterial>(MaterialLibrary::GetMaterial(materialPath)))
     , m_ParticleTemplate(particleTemplate)
     , m_TransformComponent(nullptr)
     , m_CurrentEmitMode(emitMode)
     , m_EmitterDimensions(emitterDimensions)
+    , m_InstanceBuffer(new InstanceBuffer(sizeof(ParticleInstanceData)))
 {
 	m_AllowedMaterials = { BasicMaterial::s_MaterialName };
 	expandPool(poolSize);
@@ -93,101 +105,163 @@ bool CPUParticlesComponent::preRender(float deltaMilliseconds)
 {
 	ModelComponent::preRender(deltaMilliseconds);
 
-	int i = m_EmitRate;
-	while (i >= 0)
+	emit(m_ParticleTemplate, m_EmitRate + 1);
+
+	float delta = deltaMilliseconds * 1e-3f;
+	size_t liveCount = m_ParticlePool.m_LiveCount;
+	if (liveCount <= PARTICLES_BATCH_SIZE)
 	{
-		emit(m_ParticleTemplate);
-		i--;
+		m_ParticlePool.integrate(0, liveCount, delta);
 	}
-
-	for (auto& particle : m_ParticlePool)
+	else
 	{
-		if (particle.m_LifeRemaining <= 0.0f)
+		ThreadPool& threadPool = Application::GetSingleton()->getThreadPool();
+		Vector<Ref<Task>> tasks;
+		for (size_t batch = 0; batch < liveCount; batch += PARTICLES_BATCH_SIZE)
 		{
-			particle.m_IsActive = false;
-			continue;
+			size_t batchEnd = std::min(batch + PARTICLES_BATCH_SIZE, liveCount);
+			tasks.emplace_back(new Task([this, batch, batchEnd, delta]() {
+				m_ParticlePool.integrate(batch, batchEnd, delta);
+			}));
 		}
-		if (!particle.m_IsActive)
-		{
-			continue;
-		}
-		float delta = deltaMilliseconds * 1e-3;
-		particle.m_LifeRemaining -= delta;
-		particle.m_Transform = Matrix::CreateTranslation(particle.m_Velocity * delta) * Matrix::CreateFromYawPitchRoll(particle.m_AngularVelocity.x * delta, particle.m_AngularVelocity.y * delta, particle.m_AngularVelocity.z * delta) * particle.m_Transform;
+		threadPool.wait(threadPool.submit(tasks));
 	}
 
+	m_ParticlePool.compact();
+
 	return true;
 }
 
-void CPUParticlesComponent::render()
+void CPUParticlesComponent::packInstances()
 {
-	for (auto& particle : m_ParticlePool)
+	size_t liveCount = m_ParticlePool.m_LiveCount;
+	m_InstanceData.resize(liveCount);
+	if (liveCount <= PARTICLES_BATCH_SIZE)
 	{
-		if (!particle.m_IsActive)
-		{
-			continue;
-		}
+		m_ParticlePool.pack(m_InstanceData, 0, liveCount);
+		return;
+	}
 
-		float life = particle.m_LifeRemaining / particle.m_LifeTime;
-		float size = particle.m_SizeBegin * (life) + particle.m_SizeEnd * (1.0f - life);
-		
-		RenderSystem::GetSingleton()->pushMatrixOverride(Matrix::CreateScale(size) * particle.m_Transform);
-		
-		m_BasicMaterial->setColor(Color::Lerp(particle.m_ColorEnd, particle.m_ColorBegin, life));
-		RenderSystem::GetSingleton()->getRenderer()->bind(m_BasicMaterial.get());
-		
-		for (auto& [material, meshes] : m_ModelResourceFile->getMeshes())
-		{
-			for (auto& mesh : meshes)
-			{
-				RenderSystem::GetSingleton()->getRenderer()->draw(mesh.m_VertexBuffer.get(), mesh.m_IndexBuffer.get());
-			}
-		}
-		RenderSystem::GetSingleton()->popMatrix();
+	ThreadPool& threadPool = Application::GetSingleton()->getThreadPool();
+	Vector<Ref<Task>> tasks;
+	for (size_t batch = 0; batch < liveCount; batch += PARTICLES_BATCH_SIZE)
+	{
+		size_t batchEnd = std::min(batch + PARTICLES_BATCH_SIZE, liveCount);
+		tasks.emplace_back(new Task([this, batch, batchEnd]() {
+			m_ParticlePool.pack(m_InstanceData, batch, batchEnd);
+		}));
 	}
+	threadPool.wait(threadPool.submit(tasks));
 }
 
-void CPUParticlesComponent::emit(const ParticleTemplate& particleTemplate)
+void CPUParticlesComponent::render()
 {
-	Particle& particle = m_ParticlePool[m_PoolIndex];
-
-	particle.m_IsActive = true;
-
-	static Matrix initialTransform;
-	initialTransform = Matrix::Identity;
-	switch (m_CurrentEmitMode)
+	if (m_ParticlePool.m_LiveCount == 0)
 	{
-	case CPUParticlesComponent::EmitMode::Point:
-		break;
-	case CPUParticlesComponent::EmitMode::Square:
-		initialTransform = Matrix::CreateTranslation({ Random::Float() * m_EmitterDimensions.x, 0, Random::Float() * m_EmitterDimensions.z });
-		break;
-	case CPUParticlesComponent::EmitMode::Cube:
-		initialTransform = Matrix::CreateTranslation({ Random::Float() * m_EmitterDimensions.x, Random::Float() * m_EmitterDimensions.y, Random::Float() * m_EmitterDimensions.z });
-		break;
-	default:
-		break;
+		return;
 	}
 
-	particle.m_Transform = initialTransform * m_TransformComponent->getAbsoluteTransform();
+	packInstances();
+	m_InstanceBuffer->setData(m_InstanceData.data(), m_InstanceData.size());
 
-	particle.m_Velocity = particleTemplate.m_Velocity;
-	particle.m_Velocity.x += particleTemplate.m_VelocityVariation * (Random::Float() - 0.5f);
-	particle.m_Velocity.y += particleTemplate.m_VelocityVariation * (Random::Float() - 0.5f);
-	particle.m_Velocity.z += particleTemplate.m_VelocityVariation * (Random::Float() - 0.5f);
+	bindPerModel();
+	const Renderer* renderer = RenderSystem::GetSingleton()->getRenderer();
+	renderer->bindInstanced(m_BasicMaterial.get(), ShaderLibrary::GetCPUParticlesShader());
+	for (auto& [material, meshes] : m_ModelResourceFile->getMeshes())
+	{
+		for (auto& mesh : meshes)
+		{
+			renderer->drawInstanced(mesh.m_VertexBuffer.get(), mesh.m_IndexBuffer.get(), m_InstanceBuffer.get(), m_InstanceData.size(), 0);
+		}
+	}
+}
 
-	particle.m_AngularVelocity = Vector3(Random::Float() - 0.5f, Random::Float() - 0.5f, Random::Float() - 0.5f) * particleTemplate.m_AngularVelocityVariation;
-	particle.m_AngularVelocity.Normalize();
+void CPUParticlesComponent::emit(const ParticleTemplate& particleTemplate, size_t count)
+{
+	size_t begin = m_ParticlePool.m_LiveCount;
+	size_t end = std::min(begin + count, m_ParticlePool.m_Capacity);
+	if (end <= begin)
+	{
+		return;
+	}
 
-	particle.m_ColorBegin = particleTemplate.m_ColorBegin;
-	particle.m_ColorEnd = particleTemplate.m_ColorEnd;
+	Matrix emitterTransform = m_TransformComponent->getAbsoluteTransform();
+	if (end - begin <= PARTICLES_BATCH_SIZE)
+	{
+		emitRange(begin, end, particleTemplate, emitterTransform, (unsigned int)(Random::Float() * 16777216.0f));
+	}
+	else
+	{
+		// Emitted ranges do not overlap, so they can be filled in parallel
+		ThreadPool& threadPool = Application::GetSingleton()->getThreadPool();
+		Vector<Ref<Task>> tasks;
+		for (size_t batch = begin; batch < end; batch += PARTICLES_BATCH_SIZE)
+		{
+			size_t batchEnd = std::min(batch + PARTICLES_BATCH_SIZE, end);
+			unsigned int seed = (unsigned int)(Random::Float() * 16777216.0f);
+			tasks.emplace_back(new Task([this, batch, batchEnd, particleTemplate, emitterTransform, seed]() {
+				emitRange(batch, batchEnd, particleTemplate, emitterTransform, seed);
+			}));
+		}
+		threadPool.wait(threadPool.submit(tasks));
+	}
 
-	particle.m_LifeTime = particleTemplate.m_LifeTime;
-	particle.m_LifeRemaining = particleTemplate.m_LifeTime;
-	particle.m_SizeBegin = particleTemplate.m_SizeBegin + particleTemplate.m_SizeVariation * (Random::Float() - 0.5f);
-	particle.m_SizeEnd = particleTemplate.m_SizeEnd;
+	m_ParticlePool.m_LiveCount = end;
+}
 
-	m_PoolIndex = --m_PoolIndex % m_ParticlePool.size();
+void CPUParticlesComponent::emitRange(size_t begin, size_t end, const ParticleTemplate& particleTemplate, const Matrix& emitterTransform, unsigned int seed)
+{
+	ParticlePool& pool = m_ParticlePool;
+	// Xorshift is stuck at 0
+	unsigned int state = seed | 1;
+	for (size_t i = begin; i < end; i++)
+	{
+		Vector3 offset = Vector3::Zero;
+		switch (m_CurrentEmitMode)
+		{
+		case CPUParticlesComponent::EmitMode::Point:
+			break;
+		case CPUParticlesComponent::EmitMode::Square:
+			offset = { NextFloat(state) * m_EmitterDimensions.x, 0, NextFloat(state) * m_EmitterDimensions.z };
+			break;
+		case CPUParticlesComponent::EmitMode::Cube:
+			offset = { NextFloat(state) * m_EmitterDimensions.x, NextFloat(state) * m_EmitterDimensions.y, NextFloat(state) * m_EmitterDimensions.z };
+			break;
+		default:
+			break;
+		}
+		Vector3 position = Vector3::Transform(offset, emitterTransform);
+
+		Vector3 velocity = particleTemplate.m_Velocity;
+		velocity.x += particleTemplate.m_VelocityVariation * (NextFloat(state) - 0.5f);
+		velocity.y += particleTemplate.m_VelocityVariation * (NextFloat(state) - 0.5f);
+		velocity.z += particleTemplate.m_VelocityVariation * (NextFloat(state) - 0.5f);
+		velocity = Vector3::TransformNormal(velocity, emitterTransform);
+
+		Vector3 angularVelocity = Vector3(NextFloat(state) - 0.5f, NextFloat(state) - 0.5f, NextFloat(state) - 0.5f) * particleTemplate.m_AngularVelocityVariation;
+		angularVelocity.Normalize();
+
+		pool.m_PositionX[i] = position.x;
+		pool.m_PositionY[i] = position.y;
+		pool.m_PositionZ[i] = position.z;
+		pool.m_VelocityX[i] = velocity.x;
+		pool.m_VelocityY[i] = velocity.y;
+		pool.m_VelocityZ[i] = velocity.z;
+		pool.m_Yaw[i] = 0.0f;
+		pool.m_Pitch[i] = 0.0f;
+		pool.m_Roll[i] = 0.0f;
+		pool.m_YawVelocity[i] = angularVelocity.x;
+		pool.m_PitchVelocity[i] = angularVelocity.y;
+		pool.m_RollVelocity[i] = angularVelocity.z;
+
+		pool.m_ColorBegin[i] = particleTemplate.m_ColorBegin;
+		pool.m_ColorEnd[i] = particleTemplate.m_ColorEnd;
+
+		pool.m_LifeTime[i] = particleTemplate.m_LifeTime;
+		pool.m_LifeRemaining[i] = particleTemplate.m_LifeTime;
+		pool.m_SizeBegin[i] = particleTemplate.m_SizeBegin + particleTemplate.m_SizeVariation * (NextFloat(state) - 0.5f);
+		pool.m_SizeEnd[i] = particleTemplate.m_SizeEnd;
+	}
 }
 
 void CPUParticlesComponent::expandPool(const size_t& poolSize)
@@ -198,7 +272,6 @@ void CPUParticlesComponent::expandPool(const size_t& poolSize)
 	}
 
 	m_ParticlePool.resize(poolSize);
-	m_PoolIndex = poolSize - 1;
 }
 
 JSON::json CPUParticlesComponent::getJSON() const
@@ -207,7 +280,7 @@ JSON::json CPUParticlesComponent::getJSON() const
 
 	j["materialPath"] = m_BasicMaterial->getFileName();
 
-	j["poolSize"] = m_ParticlePool.size();
+	j["poolSize"] = m_ParticlePool.m_Capacity;
 	j["velocity"]["x"] = m_ParticleTemplate.m_Velocity.x;
 	j["velocity"]["y"] = m_ParticleTemplate.m_Velocity.y;
 	j["velocity"]["z"] = m_ParticleTemplate.m_Velocity.z;
@@ -255,11 +328,12 @@ void CPUParticlesComponent::draw()
 	};
 	ImGui::Combo("Emit Mode", (int*)&m_CurrentEmitMode, emitModes, 3);
 	ImGui::DragFloat3("Emitter Dimensions", &m_EmitterDimensions.x);
-	int poolSize = m_ParticlePool.size();
-	if (ImGui::DragInt("Pool Size", &poolSize, 1.0f, 1, 100000)) 
+	int poolSize = m_ParticlePool.m_Capacity;
+	if (ImGui::DragInt("Pool Size", &poolSize, 1.0f, 1, 1000000)) 
 	{
 		expandPool(poolSize);
 	}
+	ImGui::Text("Live Particles: %d", (int)m_ParticlePool.m_LiveCount);
 	ImGui::DragInt("Emit Rate", &m_EmitRate);
 	
 	ImGui::Separator();
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "model_component.h"
+#include "particle_pool.h"
+
+/// Number of particles emitted or integrated by a single task. Smaller workloads run on the calling thread.
+#define PARTICLES_BATCH_SIZE 8192
 
 struct ParticleTemplate
 {
@@ -20,24 +24,11 @@ class CPUParticlesComponent : public ModelComponent
 	static Component* Create(const JSON::json& componentData);
 	static Component* CreateDefault();
 	
-	struct Particle
-	{
-		bool m_IsActive = false;
-		float m_SizeBegin;
-		float m_SizeEnd;
-		float m_LifeTime;
-		float m_LifeRemaining;
-		Color m_ColorBegin;
-		Color m_ColorEnd;
-		Vector3 m_Velocity;
-		Vector3 m_AngularVelocity;
-		Matrix m_Transform;
-	};
-
 	ParticleTemplate m_ParticleTemplate;
-	Vector<Particle> m_ParticlePool;
+	ParticlePool m_ParticlePool;
 	Ref<BasicMaterial> m_BasicMaterial;
-	size_t m_PoolIndex;
+	Vector<ParticleInstanceData> m_InstanceData;
+	Ptr<InstanceBuffer> m_InstanceBuffer;
 	int m_EmitRate;
 	TransformComponent* m_TransformComponent;
 	
@@ -53,6 +44,11 @@ class CPUParticlesComponent : public ModelComponent
 
 	friend class EntityFactory;
 
+	/// Initialize particles in [begin, end) of the pool. seed drives the random variations of the range.
+	void emitRange(size_t begin, size_t end, const ParticleTemplate& particleTemplate, const Matrix& emitterTransform, unsigned int seed);
+	/// Fill m_InstanceData with the instance data of all live particles.
+	void packInstances();
+
 public:
 	static const ComponentID s_ID = (ComponentID)ComponentIDs::CPUParticlesComponent;
 
@@ -63,9 +59,15 @@ public:
 	virtual bool setup() override;
 	virtual bool preRender(float deltaMilliseconds) override;
 	virtual void render() override;
+	/// Drawn immediately with render().
+	virtual bool submit(RenderQueue& queue, int object, float depth) override { return false; }
+	/// Particles leave the emitter bounds as soon as they are emitted.
+	virtual bool isFrustumCulled() const override { return false; }
 
-	void emit(const ParticleTemplate& particleTemplate);
+	/// Emit count particles, or as many as there are free slots in the pool.
+	void emit(const ParticleTemplate& particleTemplate, size_t count);
 	void expandPool(const size_t& poolSize);
+	size_t getLiveCount() const { return m_ParticlePool.m_LiveCount; }
 
 	virtual String getName() const override { return "CPUParticlesComponent"; }
 	ComponentID getComponentID() const override { return s_ID; }
@@ -29,6 +29,10 @@ public:
 
 	virtual bool setup() override;
 	void render() override;
+	/// Drawn immediately with render().
+	bool submit(RenderQueue& queue, int object, float depth) override { return false; }
+	/// The grid spans far beyond the bounds of its transform component.
+	bool isFrustumCulled() const override { return false; }
 
 	virtual String getName() const override { return "GridModelComponent"; }
 	ComponentID getComponentID() const override { return s_ID; }
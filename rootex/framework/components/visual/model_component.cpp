@@ -29,12 +29,19 @@ Component* ModelComponent::Create(const JSON::json& componentData)
 			affectingStaticLights.push_back(lightEntityID);
 		}
 	}
+	// Lists written by hand before lights were baked are kept as they are
+	bool isStaticLightsBaked = !affectingStaticLights.empty();
+	if (componentData.find("isStaticLightsBaked") != componentData.end())
+	{
+		isStaticLightsBaked = componentData["isStaticLightsBaked"];
+	}
 	ModelComponent* modelComponent = new ModelComponent(
 	    componentData["renderPass"],
 	    ResourceLoader::CreateModelResourceFile(componentData["resFile"]),
 	    materialOverrides,
 	    componentData["isVisible"],
-	    affectingStaticLights);
+	    affectingStaticLights,
+	    isStaticLightsBaked);
 
 	return modelComponent;
 }
@@ -46,17 +53,19 @@ Component* ModelComponent::CreateDefault()
 	    ResourceLoader::CreateModelResourceFile("rootex/assets/cube.obj"),
 	    {},
 	    true,
-	    {});
+	    {},
+	    false);
 
 	return modelComponent;
 }
 
-ModelComponent::ModelComponent(unsigned int renderPass, ModelResourceFile* resFile, const HashMap<String, String>& materialOverrides, bool visibility, const Vector<EntityID>& affectingStaticLightIDs)
+ModelComponent::ModelComponent(unsigned int renderPass, ModelResourceFile* resFile, const HashMap<String, String>& materialOverrides, bool visibility, const Vector<EntityID>& affectingStaticLightIDs, bool isStaticLightsBaked)
     : m_IsVisible(visibility)
     , m_RenderPass(renderPass)
     , m_TransformComponent(nullptr)
     , m_HierarchyComponent(nullptr)
     , m_AffectingStaticLightEntityIDs(affectingStaticLightIDs)
+    , m_IsStaticLightsBaked(isStaticLightsBaked)
 {
 	setVisualModel(resFile, materialOverrides);
 }
@@ -108,28 +117,27 @@ bool ModelComponent::setupEntities()
 
 bool ModelComponent::addAffectingStaticLight(EntityID ID)
 {
-	Ref<Entity> entity = EntityFactory::GetSingleton()->findEntity(ID);
-	if (!entity)
+	int lightIndex = LightSystem::GetSingleton()->getStaticLightIndex(ID);
+	if (lightIndex == -1)
 	{
-		WARN("Static light entity referred to not found: " + std::to_string(ID));
+		Ref<Entity> entity = EntityFactory::GetSingleton()->findEntity(ID);
+		if (!entity)
 		{
+			WARN("Static light entity referred to not found: " + std::to_string(ID));
 			return false;
-		};
-	}
-
-	int lightID = 0;
-	for (auto& component : System::GetComponents(StaticPointLightComponent::s_ID))
-	{
-		if (entity->getComponent<StaticPointLightComponent>().get() == component)
-		{
-			m_AffectingStaticLightEntityIDs.push_back(ID);
-			m_AffectingStaticLights.push_back(lightID);
-			return true;
 		}
-		lightID++;
+		WARN("Provided static light entity does not have a static light: " + entity->getFullName());
+		return false;
 	}
-	WARN("Provided static light entity does not have a static light: " + entity->getFullName());
-	return false;
+
+	addAffectingStaticLight(ID, lightIndex);
+	return true;
+}
+
+void ModelComponent::addAffectingStaticLight(EntityID ID, int lightIndex)
+{
+	m_AffectingStaticLightEntityIDs.push_back(ID);
+	m_AffectingStaticLights.push_back(lightIndex);
 }
 
 void ModelComponent::removeAffectingStaticLight(EntityID ID)
@@ -149,6 +157,12 @@ void ModelComponent::removeAffectingStaticLight(EntityID ID)
 	}
 }
 
+void ModelComponent::clearAffectingStaticLights()
+{
+	m_AffectingStaticLightEntityIDs.clear();
+	m_AffectingStaticLights.clear();
+}
+
 bool ModelComponent::preRender(float deltaMilliseconds)
 {
 	if (m_TransformComponent)
@@ -164,33 +178,50 @@ bool ModelComponent::preRender(float deltaMilliseconds)
 
 bool ModelComponent::isVisible() const
 {
-	// TODO: Add culling
 	return m_IsVisible;
 }
 
-bool CompareMaterials(const Pair<Ref<Material>, Vector<Mesh>>& a, const Pair<Ref<Material>, Vector<Mesh>>& b)
+bool ModelComponent::submit(RenderQueue& queue, int object, float depth)
 {
-	// Alpha materials final last
-	return !a.first->isAlpha() && b.first->isAlpha();
+	for (RenderPass pass : { RenderPass::Basic, RenderPass::Editor, RenderPass::Alpha })
+	{
+		unsigned int renderPass = (unsigned int)pass;
+		if (!(m_RenderPass & renderPass))
+		{
+			continue;
+		}
+
+		for (auto& [material, meshes] : m_ModelResourceFile->getMeshes())
+		{
+			Material* boundMaterial = m_MaterialOverrides[material].get();
+			uint64_t key = RenderQueue::MakeKey(renderPass, boundMaterial->isAlpha(), boundMaterial->getShader()->getID(), boundMaterial->getID(), depth);
+			for (auto& mesh : meshes)
+			{
+				queue.push({ key, boundMaterial, mesh.m_VertexBuffer.get(), mesh.m_IndexBuffer.get(), object });
+			}
+		}
+	}
+	return true;
 }
 
-void ModelComponent::render()
+void ModelComponent::bindPerModel()
 {
-	std::sort(m_ModelResourceFile->getMeshes().begin(), m_ModelResourceFile->getMeshes().end(), CompareMaterials);
-	int i = 0;
-
 	PerModelPSCB perModel;
 	for (int i = 0; i < m_AffectingStaticLights.size(); i++)
 	{
 		perModel.staticPointsLightsAffecting[i].id = m_AffectingStaticLights[i];
 	}
 	perModel.staticPointsLightsAffectingCount = m_AffectingStaticLights.size();
-	Material::SetPSConstantBuffer(perModel, m_PerModelCB, PER_MODEL_PS_CPP);
+	Material::SetTransientPSConstantBuffer(perModel, m_PerModelCB, PER_MODEL_PS_CPP);
+}
+
+void ModelComponent::render()
+{
+	bindPerModel();
 	
 	for (auto& [material, meshes] : m_ModelResourceFile->getMeshes())
 	{
 		RenderSystem::GetSingleton()->getRenderer()->bind(m_MaterialOverrides[material].get());
-		i++;
 
 		for (auto& mesh : meshes)
 		{
@@ -248,6 +279,7 @@ JSON::json ModelComponent::getJSON() const
 		j["materialOverrides"][oldMaterial->getFileName()] = newMaterial->getFileName();
 	}
 	j["affectingStaticLights"] = m_AffectingStaticLightEntityIDs;
+	j["isStaticLightsBaked"] = m_IsStaticLightsBaked;
 
 	return j;
 }
@@ -311,6 +343,11 @@ void ModelComponent::draw()
 	if (ImGui::TreeNodeEx("Static Lights"))
 	{
 		ImGui::Indent();
+		ImGui::Checkbox("Baked", &m_IsStaticLightsBaked);
+		if (ImGui::IsItemHovered())
+		{
+			ImGui::SetTooltip("Unbaked lists are filled with the nearest static lights when the level is opened");
+		}
 		int slot = 0;
 		EntityID toRemove = -1;
 		for (auto& slotEntityID : m_AffectingStaticLightEntityIDs)
@@ -331,6 +368,7 @@ void ModelComponent::draw()
 		if (toRemove != -1)
 		{
 			removeAffectingStaticLight(toRemove);
+			m_IsStaticLightsBaked = true;
 		}
 
 		if (slot < MAX_STATIC_POINT_LIGHTS_AFFECTING_1_OBJECT)
@@ -342,6 +380,7 @@ void ModelComponent::draw()
 					if (ImGui::Selectable(component->getOwner()->getFullName().c_str()))
 					{
 						addAffectingStaticLight(component->getOwner()->getID());
+						m_IsStaticLightsBaked = true;
 					}
 				}
 				ImGui::EndCombo();
@@ -4,6 +4,7 @@
 #include "components/hierarchy_component.h"
 #include "components/transform_component.h"
 #include "renderer/material.h"
+#include "renderer/render_queue.h"
 #include "core/resource_file.h"
 
 class ModelComponent : public Component
@@ -14,20 +15,22 @@ class ModelComponent : public Component
 	friend class EntityFactory;
 
 protected:
-	ModelResourceFile* m_ModelResourceFile;
+	ResourceHandle<ModelResourceFile> m_ModelResourceFile;
 	bool m_IsVisible;
 	int m_RenderPass;
 
 	HashMap<Ref<Material>, Ref<Material>> m_MaterialOverrides;
 	Vector<EntityID> m_AffectingStaticLightEntityIDs;
 	Vector<int> m_AffectingStaticLights;
+	/// Whether the static light list is final and should not be baked again on level load.
+	bool m_IsStaticLightsBaked;
 
 	Microsoft::WRL::ComPtr<ID3D11Buffer> m_PerModelCB;
 
 	HierarchyComponent* m_HierarchyComponent;
 	TransformComponent* m_TransformComponent;
 
-	ModelComponent(unsigned int renderPass, ModelResourceFile* resFile, const HashMap<String, String>& materialOverrides, bool isVisible, const Vector<EntityID>& affectingStaticLightIDs);
+	ModelComponent(unsigned int renderPass, ModelResourceFile* resFile, const HashMap<String, String>& materialOverrides, bool isVisible, const Vector<EntityID>& affectingStaticLightIDs, bool isStaticLightsBaked);
 	ModelComponent(ModelComponent&) = delete;
 	virtual ~ModelComponent() = default;
 
@@ -38,17 +41,33 @@ protected:
 public:
 	static void RegisterAPI(sol::table& rootex);
 	static const ComponentID s_ID = (ComponentID)ComponentIDs::ModelComponent;
+	DEFINE_COMPONENT_POOL(ModelComponent);
 
 	virtual bool setup() override;
 	virtual bool setupEntities() override;
 
 	virtual bool preRender(float deltaMilliseconds);
+	/// Push a draw command for every mesh in every render pass of this model. object is the index passed back to the renderer.
+	/// Returns false if the model has to be drawn immediately with render() instead.
+	virtual bool submit(RenderQueue& queue, int object, float depth);
+	/// Upload the constant buffers shared by all meshes of this model.
+	void bindPerModel();
 	virtual bool isVisible() const;
+	/// Whether the bounds of the transform component cover everything this model draws, so it can be skipped when they are off screen.
+	virtual bool isFrustumCulled() const { return true; }
 	virtual void render();
 	virtual void postRender();
 
 	bool addAffectingStaticLight(EntityID ID);
+	/// Add a static light whose index in the static light array is already known.
+	void addAffectingStaticLight(EntityID ID, int lightIndex);
 	void removeAffectingStaticLight(EntityID ID);
+	void clearAffectingStaticLights();
+	int getAffectingStaticLightCount() const { return m_AffectingStaticLights.size(); }
+	/// Indices of the static lights affecting this model in the static light array.
+	const Vector<int>& getAffectingStaticLights() const { return m_AffectingStaticLights; }
+	bool isStaticLightsBaked() const { return m_IsStaticLightsBaked; }
+	void setStaticLightsBaked(bool enabled) { m_IsStaticLightsBaked = enabled; }
 	
 	void setVisualModel(ModelResourceFile* newModel, const HashMap<String, String>& materialOverrides);
 	void setIsVisible(bool enabled);
@@ -57,6 +76,7 @@ public:
 	unsigned int getRenderPass() const { return m_RenderPass; }
 	const Vector<Pair<Ref<Material>, Vector<Mesh>>>& getMeshes() const { return m_ModelResourceFile->getMeshes(); }
 	ModelResourceFile* getModelResourceFile() const { return m_ModelResourceFile; }
+	TransformComponent* getTransformComponent() const { return m_TransformComponent; }
 
 	virtual String getName() const override { return "ModelComponent"; }
 	ComponentID getComponentID() const override { return s_ID; }
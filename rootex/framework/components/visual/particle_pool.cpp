@@ -0,0 +1,88 @@
+#include "particle_pool.h"
+
+#include <algorithm>
+
+/// Advance 4 consecutive values by their rates of change over delta.
+static void Integrate4(float* values, const float* rates, DirectX::FXMVECTOR delta)
+{
+	DirectX::XMVECTOR value = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)values);
+	DirectX::XMVECTOR rate = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)rates);
+	DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)values, DirectX::XMVectorMultiplyAdd(rate, delta, value));
+}
+
+void ParticlePool::resize(size_t capacity)
+{
+	size_t paddedCapacity = (capacity + 3) & ~(size_t)3;
+	for (std::vector<float>* stream : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Yaw, &m_Pitch, &m_Roll, &m_YawVelocity, &m_PitchVelocity, &m_RollVelocity, &m_LifeRemaining, &m_LifeTime, &m_SizeBegin, &m_SizeEnd })
+	{
+		stream->resize(paddedCapacity, 0.0f);
+	}
+	m_ColorBegin.resize(capacity);
+	m_ColorEnd.resize(capacity);
+
+	m_Capacity = capacity;
+	m_LiveCount = std::min(m_LiveCount, capacity);
+}
+
+void ParticlePool::copy(size_t from, size_t to)
+{
+	for (std::vector<float>* stream : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ, &m_Yaw, &m_Pitch, &m_Roll, &m_YawVelocity, &m_PitchVelocity, &m_RollVelocity, &m_LifeRemaining, &m_LifeTime, &m_SizeBegin, &m_SizeEnd })
+	{
+		(*stream)[to] = (*stream)[from];
+	}
+	m_ColorBegin[to] = m_ColorBegin[from];
+	m_ColorEnd[to] = m_ColorEnd[from];
+}
+
+void ParticlePool::integrate(size_t begin, size_t end, float delta)
+{
+	// The arrays are padded, so the last group of 4 can be processed whole
+	end = (end + 3) & ~(size_t)3;
+
+	DirectX::XMVECTOR deltaVector = DirectX::XMVectorReplicate(delta);
+	for (size_t i = begin; i < end; i += 4)
+	{
+		Integrate4(&m_PositionX[i], &m_VelocityX[i], deltaVector);
+		Integrate4(&m_PositionY[i], &m_VelocityY[i], deltaVector);
+		Integrate4(&m_PositionZ[i], &m_VelocityZ[i], deltaVector);
+		Integrate4(&m_Yaw[i], &m_YawVelocity[i], deltaVector);
+		Integrate4(&m_Pitch[i], &m_PitchVelocity[i], deltaVector);
+		Integrate4(&m_Roll[i], &m_RollVelocity[i], deltaVector);
+
+		DirectX::XMVECTOR life = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&m_LifeRemaining[i]);
+		DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&m_LifeRemaining[i], DirectX::XMVectorSubtract(life, deltaVector));
+	}
+}
+
+void ParticlePool::compact()
+{
+	size_t i = 0;
+	while (i < m_LiveCount)
+	{
+		if (m_LifeRemaining[i] > 0.0f)
+		{
+			i++;
+			continue;
+		}
+		m_LiveCount--;
+		copy(m_LiveCount, i);
+	}
+}
+
+void ParticlePool::pack(std::vector<ParticleInstanceData>& instances, size_t begin, size_t end) const
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		float life = m_LifeRemaining[i] / m_LifeTime[i];
+		float size = m_SizeBegin[i] * life + m_SizeEnd[i] * (1.0f - life);
+
+		DirectX::XMMATRIX rotation = DirectX::XMMatrixRotationRollPitchYaw(m_Pitch[i], m_Yaw[i], m_Roll[i]);
+		DirectX::XMVECTOR scale = DirectX::XMVectorReplicate(size);
+
+		ParticleInstanceData& instance = instances[i];
+		DirectX::XMStoreFloat4(&instance.m_TransformRows[0], DirectX::XMVectorSetW(DirectX::XMVectorMultiply(rotation.r[0], scale), m_PositionX[i]));
+		DirectX::XMStoreFloat4(&instance.m_TransformRows[1], DirectX::XMVectorSetW(DirectX::XMVectorMultiply(rotation.r[1], scale), m_PositionY[i]));
+		DirectX::XMStoreFloat4(&instance.m_TransformRows[2], DirectX::XMVectorSetW(DirectX::XMVectorMultiply(rotation.r[2], scale), m_PositionZ[i]));
+		DirectX::XMStoreFloat4(&instance.m_Color, DirectX::XMVectorLerp(DirectX::XMLoadFloat4(&m_ColorEnd[i]), DirectX::XMLoadFloat4(&m_ColorBegin[i]), life));
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <vector>
+
+/// Data sent once per particle of an instanced particle draw.
+/// The rotation and scale rows of the world transform are stored in xyz, with the translation spread over their w components.
+struct ParticleInstanceData
+{
+	DirectX::XMFLOAT4 m_TransformRows[3];
+	DirectX::XMFLOAT4 m_Color;
+};
+
+/// Particles stored as a structure of arrays, so that they can be integrated 4 at a time.
+/// Live particles are kept packed in [0, m_LiveCount). Arrays are padded to a multiple of 4 elements.
+/// Depends on DirectXMath alone, so simulating and packing instance data can run and be tested without a GPU.
+class ParticlePool
+{
+public:
+	std::vector<float> m_PositionX;
+	std::vector<float> m_PositionY;
+	std::vector<float> m_PositionZ;
+	std::vector<float> m_VelocityX;
+	std::vector<float> m_VelocityY;
+	std::vector<float> m_VelocityZ;
+	std::vector<float> m_Yaw;
+	std::vector<float> m_Pitch;
+	std::vector<float> m_Roll;
+	std::vector<float> m_YawVelocity;
+	std::vector<float> m_PitchVelocity;
+	std::vector<float> m_RollVelocity;
+	std::vector<float> m_LifeRemaining;
+	std::vector<float> m_LifeTime;
+	std::vector<float> m_SizeBegin;
+	std::vector<float> m_SizeEnd;
+	std::vector<DirectX::XMFLOAT4> m_ColorBegin;
+	std::vector<DirectX::XMFLOAT4> m_ColorEnd;
+
+	size_t m_Capacity = 0;
+	size_t m_LiveCount = 0;
+
+	void resize(size_t capacity);
+	/// Overwrite the particle at to with the particle at from.
+	void copy(size_t from, size_t to);
+
+	/// Advance positions, rotations and remaining lives of particles in [begin, end) by delta seconds.
+	/// begin must be a multiple of 4. Different ranges can be integrated in parallel.
+	void integrate(size_t begin, size_t end, float delta);
+	/// Move the last live particles into the slots of dead ones.
+	void compact();
+	/// Write the scaled world transform and current color of live particles in [begin, end) to instances, at the same indices.
+	/// instances must hold at least end elements.
+	void pack(std::vector<ParticleInstanceData>& instances, size_t begin, size_t end) const;
+};
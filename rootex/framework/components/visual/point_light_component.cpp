@@ -32,6 +32,7 @@ Component* PointLightComponent::CreateDefault()
 
 PointLightComponent::PointLightComponent(const float constAtt, const float linAtt, const float quadAtt,
     const float range, const float diffuseIntensity, const Color& diffuseColor, const Color& ambientColor)
+    : m_TransformComponent(nullptr)
 {
 	m_PointLight.ambientColor = ambientColor;
 	m_PointLight.attConst = constAtt;
@@ -42,6 +43,17 @@ PointLightComponent::PointLightComponent(const float constAtt, const float linAt
 	m_PointLight.range = range;
 }
 
+bool PointLightComponent::setup()
+{
+	m_TransformComponent = m_Owner->getComponent<TransformComponent>().get();
+	if (!m_TransformComponent)
+	{
+		ERR("Transform Component not found on entity with a point light: " + m_Owner->getFullName());
+		return false;
+	}
+	return true;
+}
+
 JSON::json PointLightComponent::getJSON() const
 {
 	JSON::json j;
@@ -2,6 +2,7 @@
 
 #include "component.h"
 #include "common/common.h"
+#include "components/transform_component.h"
 
 #include "core/renderer/point_light.h"
 
@@ -14,6 +15,8 @@ class PointLightComponent : public Component
 	PointLight m_PointLight;
 
 protected:
+	TransformComponent* m_TransformComponent;
+
 	PointLightComponent::PointLightComponent(const float constAtt, const float linAtt, const float quadAtt,
 	    const float range, const float diffuseIntensity, const Color& diffuseColor, const Color& ambientColor);
 	PointLightComponent(PointLightComponent&) = delete;
@@ -24,7 +27,10 @@ protected:
 public:
 	static const ComponentID s_ID = (ComponentID)ComponentIDs::PointLightComponent;
 
+	virtual bool setup() override;
+
 	const PointLight& getPointLight() const { return m_PointLight; }
+	TransformComponent* getTransformComponent() const { return m_TransformComponent; }
 
 	virtual String getName() const override { return "PointLightComponent"; }
 	ComponentID getComponentID() const override { return s_ID; }
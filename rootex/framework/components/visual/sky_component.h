@@ -3,6 +3,7 @@
 #include "component.h"
 
 #include "renderer/materials/sky_material.h"
+#include "core/resource_file.h"
 
 class SkyComponent : public Component
 {
@@ -11,7 +12,7 @@ class SkyComponent : public Component
 
 	friend class EntityFactory;
 
-	ModelResourceFile* m_SkySphere;
+	ResourceHandle<ModelResourceFile> m_SkySphere;
 	Ref<SkyMaterial> m_SkyMaterial;
 
 	SkyComponent(const String& skyMaterialPath, const String& skySpherePath);
@@ -36,6 +36,7 @@ Component* SpotLightComponent::CreateDefault()
 SpotLightComponent::SpotLightComponent(const float constAtt, const float linAtt, const float quadAtt,
     const float range, const float diffuseIntensity, const Color& diffuseColor, const Color& ambientColor,
 	float spot, float angleRange)
+    : m_TransformComponent(nullptr)
 {
 	m_SpotLight.ambientColor = ambientColor;
 	m_SpotLight.angleRange = angleRange;
@@ -48,6 +49,17 @@ SpotLightComponent::SpotLightComponent(const float constAtt, const float linAtt,
 	m_SpotLight.range = range;
 }
 
+bool SpotLightComponent::setup()
+{
+	m_TransformComponent = m_Owner->getComponent<TransformComponent>().get();
+	if (!m_TransformComponent)
+	{
+		ERR("Transform Component not found on entity with a spot light: " + m_Owner->getFullName());
+		return false;
+	}
+	return true;
+}
+
 JSON::json SpotLightComponent::getJSON() const
 {
 	JSON::json j;
@@ -2,6 +2,7 @@
 
 #include "component.h"
 #include "common/common.h"
+#include "components/transform_component.h"
 
 #include "core/renderer/spot_light.h"
 
@@ -20,11 +21,15 @@ class SpotLightComponent : public Component
 	friend class EntityFactory;
 
 	SpotLight m_SpotLight;
+	TransformComponent* m_TransformComponent;
 
 public:
 	static const ComponentID s_ID = (ComponentID)ComponentIDs::SpotLightComponent;
 	
+	virtual bool setup() override;
+
 	const SpotLight& getSpotLight() const { return m_SpotLight; }
+	TransformComponent* getTransformComponent() const { return m_TransformComponent; }
 
 	virtual String getName() const override { return "SpotLightComponent"; }
 	ComponentID getComponentID() const override { return s_ID; }
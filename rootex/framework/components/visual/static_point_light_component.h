@@ -6,8 +6,8 @@
 #include "point_light_component.h"
 
 /// Component to apply static point lights to the scene. These type of lights are rendered in larger
-/// numbers with the limitation that they are static i.e. movement of these lights will not show up
-/// inside the final render.
+/// numbers with the limitation that they are static i.e. models only receive the static lights baked
+/// into them on level load. Moving or editing one re-uploads the data of all static lights.
 class StaticPointLightComponent : public PointLightComponent
 {
 	static Component* Create(const JSON::json& componentData);
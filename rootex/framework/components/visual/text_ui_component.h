@@ -20,7 +20,7 @@ public:
 	static Component* CreateDefault();
 
 	/// Font file
-	FontResourceFile* m_FontFile;
+	ResourceHandle<FontResourceFile> m_FontFile;
 	/// Text to display
 	String m_Text;
 	/// Color of text
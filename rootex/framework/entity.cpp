@@ -4,6 +4,7 @@
 #include "framework/component.h"
 #include "framework/components/hierarchy_component.h"
 #include "framework/system.h"
+#include "framework/systems/hierarchy_system.h"
 
 void Entity::RegisterAPI(sol::table& rootex)
 {
@@ -29,6 +30,7 @@ Entity::~Entity()
 void Entity::addComponent(const Ref<Component>& component)
 {
 	m_Components.insert(std::make_pair(component->getComponentID(), component));
+	HierarchySystem::InvalidateTransformOrder();
 }
 
 Entity::Entity(EntityID id, const String& name, const HashMap<ComponentID, Ref<Component>>& components)
@@ -82,6 +84,7 @@ void Entity::destroy()
 		component.second.reset();
 	}
 	m_Components.clear();
+	HierarchySystem::InvalidateTransformOrder();
 }
 
 void Entity::removeComponent(Ref<Component> component)
@@ -89,6 +92,7 @@ void Entity::removeComponent(Ref<Component> component)
 	component->onRemove();
 	m_Components.erase(component->getComponentID());
 	System::DeregisterComponent(component.get());
+	HierarchySystem::InvalidateTransformOrder();
 }
 
 EntityID Entity::getID() const
@@ -297,13 +297,19 @@ void EntityFactory::addComponent(Ref<Entity> entity, Ref<Component> component)
 
 void EntityFactory::destroyEntities()
 {
+	auto isSurviving = [](const Entity* entity) {
+		return entity->getID() == ROOT_ENTITY_ID || entity->getID() == INVALID_ID || entity->isEditorOnly();
+	};
+
 	Vector<Ref<Entity>> markedForRemoval;
+	Vector<Ref<Entity>> survivors;
 	for (auto& entity : m_Entities)
 	{
 		if (entity.second)
 		{
-			if (entity.second->getID() == ROOT_ENTITY_ID || entity.second->getID() == INVALID_ID || entity.second->isEditorOnly())
+			if (isSurviving(entity.second.get()))
 			{
+				survivors.push_back(entity.second);
 				continue;
 			}
 
@@ -315,14 +321,57 @@ void EntityFactory::destroyEntities()
 		}
 	}
 
+	// Tear everything down wholesale. Removing entities one by one costs a search through the parent's children per entity
+	System::DeregisterComponents([&isSurviving](Component* component) {
+		return component->getOwner() && !isSurviving(component->getOwner().get());
+	});
+
+	Ref<HierarchyComponent> rootHierarchy = m_Entities[ROOT_ENTITY_ID]->getComponent<HierarchyComponent>();
+	for (auto& survivor : survivors)
+	{
+		Ref<HierarchyComponent> hierarchy = survivor->getComponent<HierarchyComponent>();
+		if (!hierarchy)
+		{
+			continue;
+		}
+
+		int kept = 0;
+		for (int i = 0; i < hierarchy->m_Children.size(); i++)
+		{
+			if (isSurviving(hierarchy->m_Children[i]->getOwner().get()))
+			{
+				hierarchy->m_ChildrenIDs[kept] = hierarchy->m_ChildrenIDs[i];
+				hierarchy->m_Children[kept] = hierarchy->m_Children[i];
+				kept++;
+			}
+		}
+		hierarchy->m_Children.resize(kept);
+		hierarchy->m_ChildrenIDs.resize(kept);
+
+		if (hierarchy->m_Parent && !isSurviving(hierarchy->m_Parent->getOwner().get()))
+		{
+			hierarchy->m_Parent = nullptr;
+			rootHierarchy->addChild(survivor);
+		}
+	}
+
 	for (auto&& entity : markedForRemoval)
 	{
-		deleteEntity(entity, true);
+		for (auto& [componentID, component] : entity->m_Components)
+		{
+			// Hierarchies have already been detached above
+			if (componentID != HierarchyComponent::s_ID)
+			{
+				component->onRemove();
+			}
+		}
+		entity->m_Components.clear();
 	}
 
 	Ref<Entity> root = m_Entities[ROOT_ENTITY_ID];
 	m_Entities.clear();
 	m_Entities[ROOT_ENTITY_ID] = root;
+	HierarchySystem::InvalidateTransformOrder();
 }
 
 void EntityFactory::deleteEntity(Ref<Entity> entity, bool silentDelete)
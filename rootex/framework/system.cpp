@@ -5,27 +5,63 @@ Map<System::UpdateOrder, Vector<System*>> System::s_Systems;
 
 void System::RegisterComponent(Component* component)
 {
-	s_Components[component->getComponentID()].push_back(component);
+	if (component->m_SystemIndex != -1)
+	{
+		WARN("Component is already registered: " + component->getName());
+		return;
+	}
+
+	Vector<Component*>& components = s_Components[component->getComponentID()];
+	component->m_SystemIndex = components.size();
+	components.push_back(component);
 }
 
 void System::DeregisterComponent(Component* component)
 {
 	Vector<Component*>& components = s_Components[component->getComponentID()];
 
-	auto findIt = std::find(components.begin(), components.end(), component);
-	if (findIt != components.end())
+	int index = component->m_SystemIndex;
+	if (index < 0 || index >= components.size() || components[index] != component)
 	{
-		components.erase(findIt);
+		ERR("Found an unregistered component queued for deregisteration: " + component->getName());
+		return;
 	}
-	else
+
+	Component* last = components.back();
+	components[index] = last;
+	last->m_SystemIndex = index;
+	components.pop_back();
+	component->m_SystemIndex = -1;
+}
+
+void System::DeregisterComponents(const Function<bool(Component*)>& shouldRemove)
+{
+	for (auto& [componentID, components] : s_Components)
 	{
-		ERR("Found an unregistered component queued for deregisteration: " + component->getName());
+		int kept = 0;
+		for (int i = 0; i < components.size(); i++)
+		{
+			Component* component = components[i];
+			if (shouldRemove(component))
+			{
+				component->m_SystemIndex = -1;
+			}
+			else
+			{
+				component->m_SystemIndex = kept;
+				components[kept++] = component;
+			}
+		}
+		components.resize(kept);
 	}
 }
 
 System::System(const String& name, const UpdateOrder& order, bool isGameplay)
     : m_SystemName(name)
     , m_UpdateOrder(order)
+    , m_IsAccessDeclared(false)
+    , m_IsMainThreadOnly(true)
+    , m_IsLevelIndependent(false)
 {
 	s_Systems[order].push_back(this);
 	setActive(isGameplay);
@@ -67,6 +103,44 @@ void System::setActive(bool enabled)
 	m_IsActive = enabled;
 }
 
+void System::declareRead(ComponentID componentID)
+{
+	m_IsAccessDeclared = true;
+	m_ReadComponents.push_back(componentID);
+}
+
+void System::declareWrite(ComponentID componentID)
+{
+	m_IsAccessDeclared = true;
+	m_WriteComponents.push_back(componentID);
+}
+
+bool System::isConflicting(const System* other) const
+{
+	if (!m_IsAccessDeclared || !other->m_IsAccessDeclared)
+	{
+		return true;
+	}
+
+	for (auto& written : m_WriteComponents)
+	{
+		if (std::find(other->m_WriteComponents.begin(), other->m_WriteComponents.end(), written) != other->m_WriteComponents.end()
+		    || std::find(other->m_ReadComponents.begin(), other->m_ReadComponents.end(), written) != other->m_ReadComponents.end())
+		{
+			return true;
+		}
+	}
+	for (auto& read : m_ReadComponents)
+	{
+		if (std::find(other->m_WriteComponents.begin(), other->m_WriteComponents.end(), read) != other->m_WriteComponents.end())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 #ifdef ROOTEX_EDITOR
 #include "imgui.h"
 void System::draw()
@@ -25,7 +25,10 @@ protected:
 	static Map<UpdateOrder, Vector<System*>> s_Systems;
 	static HashMap<ComponentID, Vector<Component*>> s_Components;
 	static void RegisterComponent(Component* component);
+	/// Deregister in constant time. The last component of the same type takes the place of the removed one.
 	static void DeregisterComponent(Component* component);
+	/// Deregister all components for which shouldRemove returns true, in a single pass over all registered components.
+	static void DeregisterComponents(const Function<bool(Component*)>& shouldRemove);
 	
 	friend class Entity;
 	friend class EntityFactory;
@@ -34,6 +37,24 @@ protected:
 	UpdateOrder m_UpdateOrder;
 	bool m_IsActive;
 
+	Vector<ComponentID> m_ReadComponents;
+	Vector<ComponentID> m_WriteComponents;
+	bool m_IsAccessDeclared;
+	bool m_IsMainThreadOnly;
+	bool m_IsLevelIndependent;
+
+	/// Declare that update() reads components of this type.
+	/// Systems that declare their component access may be updated in parallel with systems they do not conflict with.
+	void declareRead(ComponentID componentID);
+	/// Declare that update() writes components of this type.
+	void declareWrite(ComponentID componentID);
+	/// Set whether update() needs to run on the main thread. Systems using the rendering device or UI should stay on it.
+	/// Systems that run Lua should not declare any access, since scripts may touch any component.
+	void setMainThreadOnly(bool enabled) { m_IsMainThreadOnly = enabled; }
+	/// Set whether update() can run without touching any entity or component, like input and UI.
+	/// Only these systems are updated while a streaming level creates and sets up its entities.
+	void setLevelIndependent(bool enabled) { m_IsLevelIndependent = enabled; }
+
 public:
 	static const Map<UpdateOrder, Vector<System*>>& GetSystems() { return s_Systems; }
 	static const Vector<Component*>& GetComponents(ComponentID ID) { return s_Components[ID]; }
@@ -51,6 +72,11 @@ public:
 	String getName() const { return m_SystemName; }
 	const UpdateOrder& getUpdateOrder() const { return m_UpdateOrder; }
 	bool isActive() const { return m_IsActive; }
+	/// Systems that have not declared their component access are run on the main thread, alone.
+	bool isMainThreadOnly() const { return m_IsMainThreadOnly || !m_IsAccessDeclared; }
+	bool isLevelIndependent() const { return m_IsLevelIndependent; }
+	/// Returns true if both systems can't be updated at the same time.
+	bool isConflicting(const System* other) const;
 
 	void setActive(bool enabled);
 
@@ -0,0 +1,157 @@
+#include "system_scheduler.h"
+
+#include "core/resource_loader.h"
+
+SystemScheduler::SystemScheduler(ThreadPool& threadPool)
+    : m_ThreadPool(threadPool)
+    , m_Remaining(0)
+    , m_DeltaMilliseconds(0.0f)
+    , m_Running(0)
+    , m_PeakRunning(0)
+    , m_Overlapped(0)
+    , m_LastPeakRunning(0)
+    , m_LastOverlapped(0)
+{
+}
+
+void SystemScheduler::buildGraph(bool isLevelIndependentOnly)
+{
+	m_Systems.clear();
+	for (auto& [order, systems] : System::GetSystems())
+	{
+		for (auto& system : systems)
+		{
+			if (system->isActive() && (!isLevelIndependentOnly || system->isLevelIndependent()))
+			{
+				m_Systems.push_back(system);
+			}
+		}
+	}
+
+	m_Dependencies.assign(m_Systems.size(), 0);
+	m_Successors.resize(m_Systems.size());
+	for (int i = 0; i < m_Systems.size(); i++)
+	{
+		m_Successors[i].clear();
+		for (int j = i + 1; j < m_Systems.size(); j++)
+		{
+			if (m_Systems[i]->isConflicting(m_Systems[j]))
+			{
+				m_Successors[i].push_back(j);
+				m_Dependencies[j]++;
+			}
+		}
+	}
+
+	m_MainThreadReady.clear();
+	m_Remaining = m_Systems.size();
+}
+
+void SystemScheduler::dispatch(int systemIndex)
+{
+	if (m_Systems[systemIndex]->isMainThreadOnly())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_MainThreadReady.push_back(systemIndex);
+		}
+		m_Condition.notify_one();
+	}
+	else
+	{
+		m_ThreadPool.submit([this, systemIndex]() { run(systemIndex); });
+	}
+}
+
+void SystemScheduler::release(int systemIndex)
+{
+	Vector<int> ready;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (int successor : m_Successors[systemIndex])
+		{
+			if (--m_Dependencies[successor] == 0)
+			{
+				ready.push_back(successor);
+			}
+		}
+		m_Remaining--;
+	}
+	m_Condition.notify_one();
+
+	for (int successor : ready)
+	{
+		dispatch(successor);
+	}
+}
+
+void SystemScheduler::run(int systemIndex)
+{
+	int running = ++m_Running;
+	if (running > 1)
+	{
+		m_Overlapped++;
+	}
+	int peak = m_PeakRunning.load();
+	while (running > peak && !m_PeakRunning.compare_exchange_weak(peak, running))
+	{
+	}
+
+	m_Systems[systemIndex]->update(m_DeltaMilliseconds);
+	m_Running--;
+	release(systemIndex);
+}
+
+void SystemScheduler::update(float deltaMilliseconds, bool isLevelIndependentOnly)
+{
+	m_DeltaMilliseconds = deltaMilliseconds;
+	buildGraph(isLevelIndependentOnly);
+
+	// Collect roots before dispatching any, released systems start changing dependency counts right away
+	Vector<int> roots;
+	for (int i = 0; i < m_Systems.size(); i++)
+	{
+		if (m_Dependencies[i] == 0)
+		{
+			roots.push_back(i);
+		}
+	}
+	for (int root : roots)
+	{
+		dispatch(root);
+	}
+
+	while (true)
+	{
+		int next = -1;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!m_MainThreadReady.empty())
+			{
+				// Keep main thread systems in their declared order
+				auto nextIt = std::min_element(m_MainThreadReady.begin(), m_MainThreadReady.end());
+				next = *nextIt;
+				m_MainThreadReady.erase(nextIt);
+			}
+			else if (m_Remaining == 0)
+			{
+				break;
+			}
+		}
+
+		if (next != -1)
+		{
+			run(next);
+		}
+		// A system on a worker may be waiting for a model or font upload, which only this thread can run
+		else if (ResourceLoader::RunPendingUploads() == 0 && !m_ThreadPool.help())
+		{
+			// Sleep until a system finishes, waking up every millisecond since uploads are queued without notifying
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait_for(lock, std::chrono::milliseconds(1), [this]() { return !m_MainThreadReady.empty() || m_Remaining == 0; });
+		}
+	}
+
+	m_LastPeakRunning = m_PeakRunning.exchange(0);
+	m_LastOverlapped = m_Overlapped.exchange(0);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/common.h"
+#include "os/thread.h"
+#include "system.h"
+
+/// Runs the update of all active systems every frame.
+/// Systems are ordered by UpdateOrder, then by creation. A system waits only for the earlier systems it conflicts with,
+/// so systems that declare disjoint component access are updated in parallel on the ThreadPool.
+/// Main thread only systems are updated on the calling thread, which runs pending resource uploads and tasks while it waits.
+class SystemScheduler
+{
+	ThreadPool& m_ThreadPool;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	Vector<System*> m_Systems;
+	Vector<int> m_Dependencies;
+	Vector<Vector<int>> m_Successors;
+	Vector<int> m_MainThreadReady;
+	int m_Remaining;
+	float m_DeltaMilliseconds;
+
+	Atomic<int> m_Running;
+	Atomic<int> m_PeakRunning;
+	Atomic<int> m_Overlapped;
+	int m_LastPeakRunning;
+	int m_LastOverlapped;
+
+	void buildGraph(bool isLevelIndependentOnly);
+	void release(int systemIndex);
+	void dispatch(int systemIndex);
+	void run(int systemIndex);
+
+public:
+	SystemScheduler(ThreadPool& threadPool);
+	SystemScheduler(SystemScheduler&) = delete;
+	~SystemScheduler() = default;
+
+	/// Update all active systems, or only the level independent ones. Returns when all of them have been updated.
+	void update(float deltaMilliseconds, bool isLevelIndependentOnly = false);
+
+	/// Most systems that were updating at the same time during the last frame.
+	int getPeakParallelSystems() const { return m_LastPeakRunning; }
+	/// Systems that started updating during the last frame while another system was still updating.
+	int getOverlappedSystems() const { return m_LastOverlapped; }
+};
@@ -0,0 +1,27 @@
+#include "audio_stream_system.h"
+
+#include "components/audio_component.h"
+#include "core/audio/audio_source.h"
+
+AudioStreamSystem::AudioStreamSystem()
+    : System("AudioStreamSystem", UpdateOrder::Update, true)
+{
+	declareWrite(AudioComponent::s_ID);
+	setMainThreadOnly(false);
+}
+
+AudioStreamSystem* AudioStreamSystem::GetSingleton()
+{
+	static AudioStreamSystem singleton;
+	return &singleton;
+}
+
+void AudioStreamSystem::update(float deltaMilliseconds)
+{
+	AudioComponent* audioComponent = nullptr;
+	for (Component* component : s_Components[AudioComponent::s_ID])
+	{
+		audioComponent = (AudioComponent*)component;
+		audioComponent->getAudioSource()->queueNewBuffers();
+	}
+}
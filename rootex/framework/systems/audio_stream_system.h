@@ -0,0 +1,17 @@
+#pragma once
+
+#include "system.h"
+
+/// Refills the buffers of streaming audio sources. Kept apart from AudioSystem because it does not read transforms,
+/// so it can be updated in parallel with the systems that move entities.
+class AudioStreamSystem : public System
+{
+	AudioStreamSystem();
+	AudioStreamSystem(AudioStreamSystem&) = delete;
+	virtual ~AudioStreamSystem() = default;
+
+public:
+	static AudioStreamSystem* GetSingleton();
+
+	void update(float deltaMilliseconds) override;
+};
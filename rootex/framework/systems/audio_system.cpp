@@ -107,7 +107,6 @@ void AudioSystem::update(float deltaMilliseconds)
 	for (Component* component : s_Components[AudioComponent::s_ID])
 	{
 		audioComponent = (AudioComponent*)component;
-		audioComponent->getAudioSource()->queueNewBuffers();
 		audioComponent->update();
 	}
 	
@@ -169,4 +168,8 @@ AudioSystem::AudioSystem()
     , m_Device(nullptr)
     , m_Listener(nullptr)
 {
+	declareWrite(AudioComponent::s_ID);
+	declareRead(AudioListenerComponent::s_ID);
+	declareRead(TransformComponent::s_ID);
+	setMainThreadOnly(false);
 }
@@ -1,5 +1,9 @@
 #include "hierarchy_system.h"
 
+#include "app/application.h"
+
+bool HierarchySystem::s_IsTransformOrderDirty = true;
+
 HierarchySystem::HierarchySystem()
     : System("HierarchySystem", UpdateOrder::Async, false)
 {
@@ -15,3 +19,96 @@ void HierarchySystem::addChild(Ref<Entity> child)
 {
 	m_HierarchyGraph.addChild(child);
 }
+
+void HierarchySystem::rebuildTransformOrder()
+{
+	m_TransformOrder.clear();
+	m_LevelOffsets.clear();
+
+	// Breadth first order keeps every depth level contiguous
+	Vector<HierarchyComponent*> queue = { getRootHierarchyComponent().get() };
+	Vector<int> parents = { -1 };
+	Vector<int> depths = { 0 };
+	for (int i = 0; i < queue.size(); i++)
+	{
+		HierarchyComponent* node = queue[i];
+		if (m_LevelOffsets.size() == depths[i])
+		{
+			m_LevelOffsets.push_back(i);
+		}
+		m_TransformOrder.push_back({ node->getOwner()->getComponent<TransformComponent>().get(), parents[i] });
+		for (auto&& child : node->getChildren())
+		{
+			queue.push_back(child);
+			parents.push_back(i);
+			depths.push_back(depths[i] + 1);
+		}
+	}
+	m_LevelOffsets.push_back(m_TransformOrder.size());
+
+	m_AbsoluteTransforms.resize(m_TransformOrder.size());
+	m_IsChanged.resize(m_TransformOrder.size());
+}
+
+void HierarchySystem::updateTransformRange(int begin, int end, bool isRebuilt)
+{
+	for (int i = begin; i < end; i++)
+	{
+		const TransformNode& node = m_TransformOrder[i];
+		bool isParentChanged = node.m_Parent != -1 && m_IsChanged[node.m_Parent];
+		bool isChanged = isRebuilt || isParentChanged || (node.m_Transform && node.m_Transform->m_IsDirty);
+		m_IsChanged[i] = isChanged;
+		if (!isChanged)
+		{
+			continue;
+		}
+
+		DirectX::XMMATRIX parentAbsolute = node.m_Parent == -1 ? DirectX::XMMatrixIdentity() : DirectX::XMLoadFloat4x4(&m_AbsoluteTransforms[node.m_Parent]);
+		if (node.m_Transform)
+		{
+			DirectX::XMStoreFloat4x4(&node.m_Transform->m_ParentAbsoluteTransform, parentAbsolute);
+			node.m_Transform->m_IsDirty = false;
+			DirectX::XMMATRIX local = DirectX::XMLoadFloat4x4(&node.m_Transform->getLocalTransform());
+			DirectX::XMStoreFloat4x4(&m_AbsoluteTransforms[i], DirectX::XMMatrixMultiply(local, parentAbsolute));
+		}
+		else
+		{
+			// Entities without a transform pass their parent's transform through
+			DirectX::XMStoreFloat4x4(&m_AbsoluteTransforms[i], parentAbsolute);
+		}
+	}
+}
+
+void HierarchySystem::updateTransforms()
+{
+	bool isRebuilt = s_IsTransformOrderDirty;
+	if (s_IsTransformOrderDirty)
+	{
+		rebuildTransformOrder();
+		s_IsTransformOrderDirty = false;
+	}
+
+	ThreadPool& threadPool = Application::GetSingleton()->getThreadPool();
+	Vector<Ref<Task>> tasks;
+	for (int level = 0; level + 1 < m_LevelOffsets.size(); level++)
+	{
+		int begin = m_LevelOffsets[level];
+		int end = m_LevelOffsets[level + 1];
+		if (end - begin <= TRANSFORM_BATCH_SIZE)
+		{
+			updateTransformRange(begin, end, isRebuilt);
+			continue;
+		}
+
+		// Nodes in a level only read the level above, so batches of a level are independent
+		tasks.clear();
+		for (int batch = begin; batch < end; batch += TRANSFORM_BATCH_SIZE)
+		{
+			int batchEnd = std::min(batch + TRANSFORM_BATCH_SIZE, end);
+			tasks.emplace_back(new Task([this, batch, batchEnd, isRebuilt]() {
+				updateTransformRange(batch, batchEnd, isRebuilt);
+			}));
+		}
+		threadPool.wait(threadPool.submit(tasks));
+	}
+}
@@ -3,14 +3,41 @@
 #include "framework/system.h"
 #include "components/hierarchy_component.h"
 #include "components/hierarchy_graph.h"
+#include "components/transform_component.h"
+
+/// Number of transforms updated by a single job when a hierarchy level is split across threads.
+#define TRANSFORM_BATCH_SIZE 1024
 
 /// Generates hierarchy system out of hierarchy graph, entities and components.
 class HierarchySystem : public System
 {
+public:
+	struct TransformNode
+	{
+		TransformComponent* m_Transform;
+		/// Index of the parent node in the transform order. -1 for the root.
+		int m_Parent;
+	};
+
+private:
+	static bool s_IsTransformOrderDirty;
+
 	HierarchyGraph m_HierarchyGraph;
 
+	/// Entity transforms flattened breadth first, parents are always placed before their children.
+	Vector<TransformNode> m_TransformOrder;
+	/// Cached absolute transforms of the nodes in m_TransformOrder.
+	Vector<Matrix> m_AbsoluteTransforms;
+	/// Nodes whose absolute transform was recomputed in the last update.
+	Vector<char> m_IsChanged;
+	/// Index of the first node of each depth level in m_TransformOrder, followed by the total node count.
+	Vector<int> m_LevelOffsets;
+
 	HierarchySystem();
 
+	void rebuildTransformOrder();
+	void updateTransformRange(int begin, int end, bool isRebuilt);
+
 public:
 	static HierarchySystem* GetSingleton();
 
@@ -22,4 +49,16 @@ public:
 	/// Points to Root Hierarchy Component.
 	Ref<HierarchyComponent> getRootHierarchyComponent() const { return m_HierarchyGraph.getRootHierarchyComponent(); }
 	HierarchyGraph* getHierarchyGraph() { return &m_HierarchyGraph; }
+
+	/// Mark the flattened transform order for rebuilding. Call when the hierarchy or the components of an entity change.
+	static void InvalidateTransformOrder() { s_IsTransformOrderDirty = true; }
+	/// Recompute parent absolute transforms of the subtrees whose transforms have changed since the last call.
+	/// Levels of the hierarchy are processed one after another, wide levels are split across the ThreadPool.
+	void updateTransforms();
+
+	/// Entity transforms in the order they were last updated. Transforms are nullptr for entities without one.
+	const Vector<TransformNode>& getTransformOrder() const { return m_TransformOrder; }
+	/// Returns true if the absolute transform of the node was recomputed in the last update.
+	bool isTransformChanged(int node) const { return m_IsChanged[node]; }
+	const Matrix& getAbsoluteTransform(int node) const { return m_AbsoluteTransforms[node]; }
 };
@@ -5,6 +5,7 @@
 InputSystem::InputSystem()
     : System("InputSystem", UpdateOrder::Input, true)
 {
+	setLevelIndependent(true);
 	BIND_EVENT_MEMBER_FUNCTION("WindowResized", InputSystem::windowResized);
 }
 
@@ -1,15 +1,20 @@
 #include "light_system.h"
 
+#include "app/application.h"
 #include "core/renderer/shaders/register_locations_pixel_shader.h"
 #include "components/visual/point_light_component.h"
 #include "components/visual/static_point_light_component.h"
 #include "components/visual/directional_light_component.h"
 #include "components/visual/spot_light_component.h"
+#include "components/visual/model_component.h"
 #include "components/transform_component.h"
+#include "framework/systems/hierarchy_system.h"
 #include "framework/systems/render_system.h"
+#include "framework/systems/spatial_system.h"
 
 LightSystem::LightSystem()
     : System("LightSystem", UpdateOrder::Async, false)
+    , m_StaticLightCount(0)
 {
 }
 
@@ -19,65 +24,199 @@ LightSystem* LightSystem::GetSingleton()
 	return &singleton;
 }
 
-StaticPointLightsInfo LightSystem::getStaticPointLights()
+bool LightSystem::updateStaticPointLights()
 {
-	StaticPointLightsInfo staticLights;
-	Vector<Component*>& staticPointLightComponents = s_Components[StaticPointLightComponent::s_ID];
+	const Vector<Component*>& staticPointLightComponents = s_Components[StaticPointLightComponent::s_ID];
+	int count = std::min((int)staticPointLightComponents.size(), MAX_STATIC_POINT_LIGHTS);
+	bool isChanged = count != m_StaticLightCount;
 
-	int i = 0;
-	for (; i < staticPointLightComponents.size() && i < MAX_STATIC_POINT_LIGHTS; i++)
+	for (int i = 0; i < count; i++)
 	{
 		StaticPointLightComponent* staticLight = (StaticPointLightComponent*)staticPointLightComponents[i];
-		TransformComponent* transform = staticLight->getOwner()->getComponent<TransformComponent>().get();
-		Vector3 transformedPosition = transform->getAbsoluteTransform().Translation();
 		const PointLight& pointLight = staticLight->getPointLight();
 
-		staticLights.pointLightInfos[i].ambientColor = pointLight.ambientColor;
-		staticLights.pointLightInfos[i].diffuseColor = pointLight.diffuseColor;
-		staticLights.pointLightInfos[i].diffuseIntensity = pointLight.diffuseIntensity;
-		staticLights.pointLightInfos[i].attConst = pointLight.attConst;
-		staticLights.pointLightInfos[i].attLin = pointLight.attLin;
-		staticLights.pointLightInfos[i].attQuad = pointLight.attQuad;
-		staticLights.pointLightInfos[i].lightPos = transformedPosition;
-		staticLights.pointLightInfos[i].range = pointLight.range;
+		PointLightInfo pointLightInfo;
+		pointLightInfo.ambientColor = pointLight.ambientColor;
+		pointLightInfo.diffuseColor = pointLight.diffuseColor;
+		pointLightInfo.diffuseIntensity = pointLight.diffuseIntensity;
+		pointLightInfo.attConst = pointLight.attConst;
+		pointLightInfo.attLin = pointLight.attLin;
+		pointLightInfo.attQuad = pointLight.attQuad;
+		pointLightInfo.lightPos = staticLight->getTransformComponent()->getAbsolutePosition();
+		pointLightInfo.range = pointLight.range;
+
+		if (memcmp(&pointLightInfo, &m_StaticLights.pointLightInfos[i], sizeof(PointLightInfo)) != 0)
+		{
+			m_StaticLights.pointLightInfos[i] = pointLightInfo;
+			isChanged = true;
+		}
+	}
+	// Clear the slots of removed lights
+	for (int i = count; i < m_StaticLightCount; i++)
+	{
+		m_StaticLights.pointLightInfos[i] = PointLightInfo();
+	}
+	m_StaticLightCount = count;
+
+	return isChanged;
+}
+
+void LightSystem::rebuildStaticLightIndices()
+{
+	m_StaticLightIndices.clear();
+	const Vector<Component*>& staticPointLightComponents = s_Components[StaticPointLightComponent::s_ID];
+	for (int i = 0; i < staticPointLightComponents.size(); i++)
+	{
+		m_StaticLightIndices[staticPointLightComponents[i]->getOwner()->getID()] = i;
+	}
+}
+
+int LightSystem::getStaticLightIndex(EntityID ID)
+{
+	const Vector<Component*>& staticPointLightComponents = s_Components[StaticPointLightComponent::s_ID];
+	auto isValid = [&](const HashMap<EntityID, int>::iterator& findIt) {
+		return findIt != m_StaticLightIndices.end()
+		    && findIt->second < staticPointLightComponents.size()
+		    && staticPointLightComponents[findIt->second]->getOwner()->getID() == ID;
+	};
+
+	auto findIt = m_StaticLightIndices.find(ID);
+	if (isValid(findIt))
+	{
+		return findIt->second;
+	}
+
+	// Static lights have been added or removed since the indices were built
+	rebuildStaticLightIndices();
+	findIt = m_StaticLightIndices.find(ID);
+	return isValid(findIt) ? findIt->second : -1;
+}
+
+/// Intensity of a point light reaching the closest point of bounds.
+static float GetStaticLightContribution(const PointLight& pointLight, const Vector3& position, const BoundingBox& bounds)
+{
+	Vector3 min = Vector3(bounds.Center) - Vector3(bounds.Extents);
+	Vector3 max = Vector3(bounds.Center) + Vector3(bounds.Extents);
+	float distance = Vector3::Distance(position, Vector3::Min(Vector3::Max(position, min), max));
+	float attenuation = pointLight.attConst + pointLight.attLin * distance + pointLight.attQuad * distance * distance;
+	return pointLight.diffuseIntensity / std::max(attenuation, 0.0001f);
+}
+
+int LightSystem::bakeStaticLights(bool rebakeAll)
+{
+	const Vector<Component*>& modelComponents = s_Components[ModelComponent::s_ID];
+	int bakedModels = 0;
+	for (auto& component : modelComponents)
+	{
+		ModelComponent* model = (ModelComponent*)component;
+		if (rebakeAll || !model->isStaticLightsBaked())
+		{
+			model->clearAffectingStaticLights();
+			model->setStaticLightsBaked(false);
+			bakedModels++;
+		}
+	}
+	if (bakedModels == 0)
+	{
+		return 0;
+	}
+
+	// Bounds are only refreshed once per frame, bring them up to date with the newly loaded entities
+	HierarchySystem::GetSingleton()->updateTransforms();
+	SpatialSystem::GetSingleton()->updateBounds();
+	const BoundingVolumeHierarchy& tree = SpatialSystem::GetSingleton()->getTree();
+
+	struct Candidate
+	{
+		ModelComponent* m_Model;
+		float m_Contribution;
+		int m_Light;
+	};
+	Vector<Candidate> candidates;
+
+	const Vector<Component*>& staticPointLightComponents = s_Components[StaticPointLightComponent::s_ID];
+	for (int i = 0; i < staticPointLightComponents.size() && i < MAX_STATIC_POINT_LIGHTS; i++)
+	{
+		StaticPointLightComponent* staticLight = (StaticPointLightComponent*)staticPointLightComponents[i];
+		Vector3 position = staticLight->getTransformComponent()->getAbsolutePosition();
+		const PointLight& pointLight = staticLight->getPointLight();
+
+		m_BakeQueryResults.clear();
+		tree.querySphere(BoundingSphere(position, pointLight.range), m_BakeQueryResults);
+		for (int proxy : m_BakeQueryResults)
+		{
+			ModelComponent* model = ((TransformComponent*)tree.getUserData(proxy))->getOwner()->getComponent<ModelComponent>().get();
+			if (model && !model->isStaticLightsBaked())
+			{
+				candidates.push_back({ model, GetStaticLightContribution(pointLight, position, tree.getBounds(proxy)), i });
+			}
+		}
 	}
-	return staticLights;
+
+	// Group candidates by model, then only order the strongest lights of each model
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.m_Model < b.m_Model; });
+	auto isStronger = [](const Candidate& a, const Candidate& b) { return a.m_Contribution > b.m_Contribution; };
+	for (auto begin = candidates.begin(); begin != candidates.end();)
+	{
+		ModelComponent* model = begin->m_Model;
+		auto end = std::find_if(begin, candidates.end(), [&](const Candidate& candidate) { return candidate.m_Model != model; });
+		auto kept = begin + std::min<ptrdiff_t>(end - begin, MAX_STATIC_POINT_LIGHTS_AFFECTING_1_OBJECT);
+		std::partial_sort(begin, kept, end, isStronger);
+		for (auto it = begin; it != kept; it++)
+		{
+			model->addAffectingStaticLight(staticPointLightComponents[it->m_Light]->getOwner()->getID(), it->m_Light);
+		}
+		begin = end;
+	}
+
+	for (auto& component : modelComponents)
+	{
+		((ModelComponent*)component)->setStaticLightsBaked(true);
+	}
+
+	PRINT("Baked static lights of " + std::to_string(bakedModels) + " models");
+	return bakedModels;
 }
 
 LightsInfo LightSystem::getDynamicLights()
 {
+	static_assert(sizeof(PointLightInfo) == POINT_LIGHT_DATA_SIZE * sizeof(Vector4), "Point light data does not match the shader");
+	static_assert(sizeof(SpotLightInfo) == SPOT_LIGHT_DATA_SIZE * sizeof(Vector4), "Spot light data does not match the shader");
+
 	LightsInfo lights;
 	
-	Vector3 cameraPos = RenderSystem::GetSingleton()->getCamera()->getAbsolutePosition();
-	lights.cameraPos = cameraPos;
+	CameraComponent* camera = RenderSystem::GetSingleton()->getCamera();
+	lights.cameraPos = camera->getAbsolutePosition();
+	const Matrix& view = camera->getViewMatrix();
 
-	static auto sortingLambda = [&cameraPos](const Component* a, const Component* b) -> bool {
-		Vector3& aa = a->getOwner()->getComponent<TransformComponent>()->getAbsoluteTransform().Translation();
-		Vector3& bb = b->getOwner()->getComponent<TransformComponent>()->getAbsoluteTransform().Translation();
-		return Vector3::DistanceSquared(cameraPos, aa) < Vector3::DistanceSquared(cameraPos, bb);
-	};
-
-	Vector<Component*>& pointLightComponents = s_Components[PointLightComponent::s_ID];
-	sort(pointLightComponents.begin(), pointLightComponents.end(), sortingLambda);
+	// Cleared without releasing memory, so that gathering does not allocate once the light counts settle
+	const Vector<Component*>& pointLightComponents = s_Components[PointLightComponent::s_ID];
+	const Vector<Component*>& spotLightComponents = s_Components[SpotLightComponent::s_ID];
+	m_LightData.clear();
+	m_LightData.reserve(pointLightComponents.size() * POINT_LIGHT_DATA_SIZE + spotLightComponents.size() * SPOT_LIGHT_DATA_SIZE);
+	m_ClusteredPointLights.clear();
+	m_ClusteredSpotLights.clear();
 
-	int i = 0;
-	for (; i < pointLightComponents.size() && i < MAX_DYNAMIC_POINT_LIGHTS; i++)
+	for (auto& component : pointLightComponents)
 	{
-		PointLightComponent* light = (PointLightComponent*)pointLightComponents[i];
-		TransformComponent* transform = light->getOwner()->getComponent<TransformComponent>().get();
-		Vector3 transformedPosition = transform->getAbsoluteTransform().Translation();
+		PointLightComponent* light = (PointLightComponent*)component;
+		Vector3 transformedPosition = light->getTransformComponent()->getAbsolutePosition();
 		const PointLight& pointLight = light->getPointLight();
-		
-		lights.pointLightInfos[i].ambientColor = pointLight.ambientColor;
-		lights.pointLightInfos[i].diffuseColor = pointLight.diffuseColor;
-		lights.pointLightInfos[i].diffuseIntensity = pointLight.diffuseIntensity;
-		lights.pointLightInfos[i].attConst = pointLight.attConst;
-		lights.pointLightInfos[i].attLin = pointLight.attLin;
-		lights.pointLightInfos[i].attQuad = pointLight.attQuad;
-		lights.pointLightInfos[i].lightPos = transformedPosition;
-		lights.pointLightInfos[i].range = pointLight.range;
+
+		PointLightInfo pointLightInfo;
+		pointLightInfo.ambientColor = pointLight.ambientColor;
+		pointLightInfo.diffuseColor = pointLight.diffuseColor;
+		pointLightInfo.diffuseIntensity = pointLight.diffuseIntensity;
+		pointLightInfo.attConst = pointLight.attConst;
+		pointLightInfo.attLin = pointLight.attLin;
+		pointLightInfo.attQuad = pointLight.attQuad;
+		pointLightInfo.lightPos = transformedPosition;
+		pointLightInfo.range = pointLight.range;
+
+		m_ClusteredPointLights.push_back({ Vector3::Transform(transformedPosition, view), pointLight.range, (unsigned int)m_LightData.size() });
+		const Vector4* data = (const Vector4*)&pointLightInfo;
+		m_LightData.insert(m_LightData.end(), data, data + POINT_LIGHT_DATA_SIZE);
 	}
-	lights.pointLightCount = i;
 
 	const Vector<Component*>& directionalLightComponents = s_Components[DirectionalLightComponent::s_ID];
 
@@ -101,17 +240,13 @@ LightsInfo LightSystem::getDynamicLights()
 		lights.directionalLightPresent = 1;
 	}
 
-	Vector<Component*>& spotLightComponents = s_Components[SpotLightComponent::s_ID];
-	sort(spotLightComponents.begin(), spotLightComponents.end(), sortingLambda);
-
-	i = 0;
-	for (; i < spotLightComponents.size() && i < MAX_DYNAMIC_SPOT_LIGHTS; i++)
+	for (auto& component : spotLightComponents)
 	{
-		SpotLightComponent* light = (SpotLightComponent*)spotLightComponents[i];
-		Matrix transform = light->getOwner()->getComponent<TransformComponent>()->getAbsoluteTransform();
+		SpotLightComponent* light = (SpotLightComponent*)component;
+		Matrix transform = light->getTransformComponent()->getAbsoluteTransform();
 		const SpotLight& spotLight = light->getSpotLight();
 
-		lights.spotLightInfos[i] = {
+		SpotLightInfo spotLightInfo = {
 			spotLight.ambientColor,
 			spotLight.diffuseColor, 
 			spotLight.diffuseIntensity,
@@ -124,8 +259,33 @@ LightsInfo LightSystem::getDynamicLights()
 			spotLight.spot,
 			cos(spotLight.angleRange)
 		};
+
+		BoundingSphere bounds = LightClusters::GetSpotLightBounds(transform.Translation(), transform.Forward(), spotLight.range, spotLight.angleRange);
+		m_ClusteredSpotLights.push_back({ Vector3::Transform(bounds.Center, view), bounds.Radius, (unsigned int)m_LightData.size() });
+		const Vector4* data = (const Vector4*)&spotLightInfo;
+		m_LightData.insert(m_LightData.end(), data, data + SPOT_LIGHT_DATA_SIZE);
 	}
-	lights.spotLightCount = i;
+
+	m_LightClusters.setProjection(camera->getProjectionMatrix(), camera->getNear(), camera->getFar());
+	m_LightClusters.bin(m_ClusteredPointLights, m_ClusteredSpotLights);
+
+	Window* window = Application::GetSingleton()->getWindow();
+	lights.clusterScale = { (float)LIGHT_CLUSTERS_X / window->getWidth(), (float)LIGHT_CLUSTERS_Y / window->getHeight() };
+	lights.clusterDepthScale = m_LightClusters.getDepthScale();
+	lights.clusterDepthBias = m_LightClusters.getDepthBias();
 
 	return lights;
 }
+
+#ifdef ROOTEX_EDITOR
+#include "imgui.h"
+void LightSystem::draw()
+{
+	System::draw();
+
+	if (ImGui::Button("Bake Static Lights"))
+	{
+		bakeStaticLights(true);
+	}
+}
+#endif // ROOTEX_EDITOR
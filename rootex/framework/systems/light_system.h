@@ -2,15 +2,48 @@
 
 #include "system.h"
 #include "renderer/constant_buffer.h"
+#include "renderer/light_clusters.h"
 
 /// Interface for setting up point, directional and spot lights.
 class LightSystem : public System
 {
+	LightClusters m_LightClusters;
+	Vector<ClusteredLight> m_ClusteredPointLights;
+	Vector<ClusteredLight> m_ClusteredSpotLights;
+	/// PointLightInfo and SpotLightInfo of all dynamic lights, packed as float4 registers.
+	Vector<Vector4> m_LightData;
+
+	/// Static light data last uploaded, compared against on every update to detect changes.
+	StaticPointLightsInfo m_StaticLights;
+	int m_StaticLightCount;
+
+	/// Index of each static light in the static light array, by entity ID.
+	HashMap<EntityID, int> m_StaticLightIndices;
+	/// Reused between bakes to avoid allocations.
+	Vector<int> m_BakeQueryResults;
+
 	LightSystem();
 
+	void rebuildStaticLightIndices();
+
 public:
 	static LightSystem* GetSingleton();
 
-	StaticPointLightsInfo getStaticPointLights();
+	/// Repack the static point lights into the cached array. Returns true if anything changed since the last update.
+	bool updateStaticPointLights();
+	const StaticPointLightsInfo& getStaticPointLights() const { return m_StaticLights; }
+	/// Returns the index of the static light of an entity in the static light array, -1 if the entity has no static light.
+	int getStaticLightIndex(EntityID ID);
+	/// Assign the static lights whose range touches the world bounds of each model, strongest first and capped at MAX_STATIC_POINT_LIGHTS_AFFECTING_1_OBJECT.
+	/// Models that already have baked lists keep them unless rebakeAll is set. Returns the number of models baked.
+	int bakeStaticLights(bool rebakeAll);
+	/// Returns the per frame lighting constants and bins dynamic point and spot lights into the light clusters of the current camera.
 	LightsInfo getDynamicLights();
+
+	const LightClusters& getLightClusters() const { return m_LightClusters; }
+	const Vector<Vector4>& getLightData() const { return m_LightData; }
+
+#ifdef ROOTEX_EDITOR
+	void draw() override;
+#endif // ROOTEX_EDITOR
 };
@@ -21,6 +21,7 @@ PhysicsSystem* PhysicsSystem::GetSingleton()
 PhysicsSystem::PhysicsSystem()
     : System("PhysicsSystem", UpdateOrder::Update, true)
 {
+	// No component access is declared, hit callbacks run Lua scripts during the step and those may touch any component
 }
 
 bool PhysicsSystem::initialize(const JSON::json& systemData)
@@ -4,6 +4,7 @@
 #include "renderer/shaders/register_locations_vertex_shader.h"
 #include "renderer/shaders/register_locations_pixel_shader.h"
 #include "light_system.h"
+#include "spatial_system.h"
 #include "renderer/material_library.h"
 #include "components/visual/sky_component.h"
 #include "application.h"
@@ -17,10 +18,15 @@ RenderSystem* RenderSystem::GetSingleton()
 RenderSystem::RenderSystem()
     : System("RenderSystem", UpdateOrder::Render, true)
 	, m_Renderer(new Renderer())
+    , m_InstanceBuffer(new InstanceBuffer(sizeof(InstanceData)))
+    , m_InstanceStaticLightsBuffer(new ShaderResourceBuffer(DXGI_FORMAT_R32_UINT, sizeof(unsigned int)))
     , m_VSProjectionConstantBuffer(nullptr)
     , m_VSPerFrameConstantBuffer(nullptr)
     , m_PSPerFrameConstantBuffer(nullptr)
     , m_PSPerLevelConstantBuffer(nullptr)
+    , m_LightClustersBuffer(new ShaderResourceBuffer(DXGI_FORMAT_R32G32B32A32_UINT, sizeof(LightCluster)))
+    , m_LightIndicesBuffer(new ShaderResourceBuffer(DXGI_FORMAT_R32_UINT, sizeof(unsigned int)))
+    , m_LightDataBuffer(new ShaderResourceBuffer(DXGI_FORMAT_R32G32B32A32_FLOAT, sizeof(Vector4)))
     , m_IsEditorRenderPassEnabled(false)
 {
 	BIND_EVENT_MEMBER_FUNCTION("OpenedLevel", onOpenedLevel);
@@ -65,37 +71,217 @@ void RenderSystem::setConfig(const JSON::json& configData, bool openInEditor)
 	}
 }
 
-void RenderSystem::calculateTransforms(HierarchyComponent* hierarchyComponent)
+void RenderSystem::cullModels()
 {
-	pushMatrix(hierarchyComponent->getOwner()->getComponent<TransformComponent>()->getLocalTransform());
-	for (auto&& child : hierarchyComponent->getChildren())
+	m_VisibleModels.clear();
+	m_CulledModels.clear();
+	m_CullingCandidates.clear();
+	m_CullingBounds.clear();
+
+	auto addModel = [this](ModelComponent* mc) {
+		if (!mc->isVisible())
+		{
+			m_CulledModels.push_back(mc);
+			return;
+		}
+
+		TransformComponent* transform = mc->getTransformComponent();
+		if (!mc->isFrustumCulled() || !transform)
+		{
+			m_VisibleModels.push_back(mc);
+			return;
+		}
+		m_CullingCandidates.push_back(mc);
+		m_CullingBounds.push_back(Frustum::TransformBounds(transform->getBounds(), transform->getAbsoluteTransform()));
+	};
+
+	// Pooled models are walked in memory order. Derived classes of another size, like particles, live on the heap
+	// and are picked from the registered pointers without touching the pooled ones
+	ModelComponent::GetPool().forEach([&addModel](ModelComponent* mc) {
+		if (mc->isRegistered())
+		{
+			addModel(mc);
+		}
+	});
+	const ComponentPool<ModelComponent>& modelPool = ModelComponent::GetPool();
+	for (auto& component : s_Components[ModelComponent::s_ID])
 	{
-		child->getOwner()->getComponent<TransformComponent>()->m_ParentAbsoluteTransform = getCurrentMatrix();
-		calculateTransforms(child);
+		if (!modelPool.isOwned(component))
+		{
+			addModel((ModelComponent*)component);
+		}
+	}
+
+	Frustum frustum(m_Camera->getViewMatrix() * m_Camera->getProjectionMatrix());
+	frustum.cull(m_CullingBounds, m_IsInsideFrustum);
+	for (int i = 0; i < m_CullingCandidates.size(); i++)
+	{
+		if (m_IsInsideFrustum[i])
+		{
+			m_VisibleModels.push_back(m_CullingCandidates[i]);
+		}
+		else
+		{
+			m_CulledModels.push_back(m_CullingCandidates[i]);
+		}
+	}
+}
+
+void RenderSystem::buildRenderQueue()
+{
+	m_RenderQueue.clear();
+	m_QueuedModels.clear();
+	m_ImmediateModels.clear();
+
+	Vector3 cameraPosition = m_Camera->getAbsolutePosition();
+	for (auto& mc : m_VisibleModels)
+	{
+		TransformComponent* transform = mc->getTransformComponent();
+		float depth = transform ? Vector3::DistanceSquared(cameraPosition, transform->getAbsoluteTransform().Translation()) : 0.0f;
+		if (mc->submit(m_RenderQueue, m_QueuedModels.size(), depth))
+		{
+			m_QueuedModels.push_back(mc);
+		}
+		else
+		{
+			m_ImmediateModels.push_back(mc);
+		}
+	}
+
+	m_RenderQueue.sort();
+}
+
+void RenderSystem::findInstanceBatches(int begin, int end)
+{
+	m_InstanceBatches.clear();
+	m_InstanceData.clear();
+	m_InstanceStaticLights.clear();
+
+	const Vector<DrawCommand>& commands = m_RenderQueue.getCommands();
+	int runBegin = begin;
+	while (runBegin < end)
+	{
+		const DrawCommand& first = commands[runBegin];
+		int runEnd = runBegin + 1;
+		bool isInstanceable = first.m_Material->getInstancedShader() && !RenderQueue::IsAlpha(first.m_Key);
+		if (isInstanceable)
+		{
+			// Static light lists travel with each instance, so models lit by different static lights still share a draw
+			while (runEnd < end
+			    && commands[runEnd].m_Material == first.m_Material
+			    && commands[runEnd].m_VertexBuffer == first.m_VertexBuffer
+			    && commands[runEnd].m_IndexBuffer == first.m_IndexBuffer)
+			{
+				runEnd++;
+			}
+		}
+
+		if (runEnd - runBegin >= INSTANCING_MINIMUM_BATCH)
+		{
+			m_InstanceBatches.push_back({ runBegin, runEnd, (int)m_InstanceData.size() });
+			for (int i = runBegin; i < runEnd; i++)
+			{
+				ModelComponent* queuedModel = m_QueuedModels[commands[i].m_Object];
+				TransformComponent* transform = queuedModel->getTransformComponent();
+				Matrix model = transform ? transform->getAbsoluteTransform() : Matrix::Identity;
+				const Vector<int>& staticLights = queuedModel->getAffectingStaticLights();
+				m_InstanceData.push_back({ model, model.Invert().Transpose(), (unsigned int)m_InstanceStaticLights.size(), (unsigned int)staticLights.size() });
+				m_InstanceStaticLights.insert(m_InstanceStaticLights.end(), staticLights.begin(), staticLights.end());
+			}
+		}
+		else if (isInstanceable)
+		{
+			m_Renderer->countUnbatchedDraws(runEnd - runBegin);
+		}
+		runBegin = runEnd;
 	}
-	popMatrix();
+
+	m_InstanceBuffer->setData(m_InstanceData.data(), m_InstanceData.size());
+	m_InstanceStaticLightsBuffer->setData(m_InstanceStaticLights.data(), m_InstanceStaticLights.size());
+	m_InstanceStaticLightsBuffer->bind(STATIC_LIGHT_INDICES_PS_CPP);
 }
 
 void RenderSystem::renderPassRender(float deltaMilliseconds, RenderPass renderPass)
 {
-	ModelComponent* mc = nullptr;
-	for (auto& component : s_Components[ModelComponent::s_ID])
+	// Culling only skips drawing, models update in preRender whether they are seen or not
+	for (auto& mc : m_CulledModels)
+	{
+		if (mc->getRenderPass() & (unsigned int)renderPass)
+		{
+			mc->preRender(deltaMilliseconds);
+			mc->postRender();
+		}
+	}
+
+	m_Renderer->resetBindCache();
+	for (auto& mc : m_ImmediateModels)
 	{
-		mc = (ModelComponent*)component;
 		if (mc->getRenderPass() & (unsigned int)renderPass)
 		{
 			mc->preRender(deltaMilliseconds);
-			if (mc->isVisible())
+			mc->render();
+			mc->postRender();
+		}
+	}
+	m_Renderer->resetBindCache();
+
+	const Vector<DrawCommand>& commands = m_RenderQueue.getCommands();
+	auto [begin, end] = m_RenderQueue.getPassRange((unsigned int)renderPass);
+	findInstanceBatches(begin, end);
+
+	ModelComponent* currentModel = nullptr;
+	Material* currentMaterial = nullptr;
+	int nextBatch = 0;
+	for (int i = begin; i < end; i++)
+	{
+		const DrawCommand& command = commands[i];
+		if (nextBatch < m_InstanceBatches.size() && m_InstanceBatches[nextBatch].m_Begin == i)
+		{
+			const InstanceBatch& batch = m_InstanceBatches[nextBatch++];
+			if (currentModel)
 			{
-				mc->render();
+				currentModel->postRender();
+				currentModel = nullptr;
 			}
-			mc->postRender();
+			// The transform and static lights of every instance come from the instance buffers, no per model state is bound
+			m_Renderer->bindInstanced(command.m_Material);
+			currentMaterial = nullptr;
+			m_Renderer->drawInstanced(command.m_VertexBuffer, command.m_IndexBuffer, m_InstanceBuffer.get(), batch.m_End - batch.m_Begin, batch.m_StartInstance);
+			i = batch.m_End - 1;
+			continue;
+		}
+
+		ModelComponent* model = m_QueuedModels[command.m_Object];
+		bool isModelChanged = model != currentModel;
+		if (isModelChanged)
+		{
+			if (currentModel)
+			{
+				currentModel->postRender();
+			}
+			currentModel = model;
+			currentModel->preRender(deltaMilliseconds);
+			currentModel->bindPerModel();
 		}
+
+		// Meshes of the same model sharing a material need no binds at all
+		if (isModelChanged || command.m_Material != currentMaterial)
+		{
+			m_Renderer->bindIfChanged(command.m_Material);
+			currentMaterial = command.m_Material;
+		}
+		m_Renderer->draw(command.m_VertexBuffer, command.m_IndexBuffer);
+	}
+	if (currentModel)
+	{
+		currentModel->postRender();
 	}
 }
 
 void RenderSystem::update(float deltaMilliseconds)
 {
+	m_Renderer->resetCounters();
+	ConstantBufferRing::GetSingleton()->beginFrame();
 	RenderingDevice::GetSingleton()->setOffScreenRT();
 
 	Color clearColor = { 0.15f, 0.15f, 0.15f, 1.0f };
@@ -118,9 +304,11 @@ void RenderSystem::update(float deltaMilliseconds)
 	}
 	Application::GetSingleton()->getWindow()->clearOffScreen(clearColor);
 
-	// Pre-calculate absolute transforms
-	Ref<HierarchyComponent> rootHC = HierarchySystem::GetSingleton()->getRootEntity()->getComponent<HierarchyComponent>();
-	calculateTransforms(rootHC.get());
+	// Propagate changed transforms down the hierarchy
+	HierarchySystem::GetSingleton()->updateTransforms();
+	SpatialSystem::GetSingleton()->updateBounds();
+	cullModels();
+	buildRenderQueue();
 
 	// Render geometry
 	RenderingDevice::GetSingleton()->setPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -131,6 +319,10 @@ void RenderSystem::update(float deltaMilliseconds)
 	perFrameVSCBBinds(fogStart, fogEnd);
 	const Color& fogColor = clearColor;
 	perFramePSCBBinds(fogColor);
+	if (LightSystem::GetSingleton()->updateStaticPointLights())
+	{
+		perLevelPSCBBinds();
+	}
 
 #ifdef ROOTEX_EDITOR
 	if (m_IsEditorRenderPassEnabled)
@@ -290,6 +482,15 @@ void RenderSystem::update(float deltaMilliseconds)
 	RenderingDevice::GetSingleton()->setOffScreenRTResolved();
 }
 
+void RenderSystem::clearFrame()
+{
+	RenderingDevice::GetSingleton()->setOffScreenRT();
+	Application::GetSingleton()->getWindow()->clearOffScreen({ 0.0f, 0.0f, 0.0f, 1.0f });
+	RenderingDevice::GetSingleton()->resolveSRV(RenderingDevice::GetSingleton()->getOffScreenRTSRV(), RenderingDevice::GetSingleton()->getOffScreenRTSRVResolved());
+	RenderingDevice::GetSingleton()->unbindRTSRVs();
+	RenderingDevice::GetSingleton()->setOffScreenRTResolved();
+}
+
 void RenderSystem::renderLines()
 {
 	if (m_CurrentFrameLines.m_Endpoints.size())
@@ -358,7 +559,7 @@ void RenderSystem::setProjectionConstantBuffers()
 void RenderSystem::perFrameVSCBBinds(float fogStart, float fogEnd)
 {
 	const Matrix& view = getCamera()->getViewMatrix();
-	Material::SetVSConstantBuffer(PerFrameVSCB({ view.Transpose(), -fogStart, -fogEnd }), m_VSPerFrameConstantBuffer, PER_FRAME_VS_CPP);
+	Material::SetTransientVSConstantBuffer(PerFrameVSCB({ view.Transpose(), -fogStart, -fogEnd }), m_VSPerFrameConstantBuffer, PER_FRAME_VS_CPP);
 }
 
 void RenderSystem::perFramePSCBBinds(const Color& fogColor)
@@ -366,7 +567,16 @@ void RenderSystem::perFramePSCBBinds(const Color& fogColor)
 	PerFramePSCB perFrame;
 	perFrame.lights = LightSystem::GetSingleton()->getDynamicLights();
 	perFrame.fogColor = fogColor;
-	Material::SetPSConstantBuffer(perFrame, m_PSPerFrameConstantBuffer, PER_FRAME_PS_CPP);
+	Material::SetTransientPSConstantBuffer(perFrame, m_PSPerFrameConstantBuffer, PER_FRAME_PS_CPP);
+
+	const LightClusters& lightClusters = LightSystem::GetSingleton()->getLightClusters();
+	const Vector<Vector4>& lightData = LightSystem::GetSingleton()->getLightData();
+	m_LightClustersBuffer->setData(lightClusters.getClusters().data(), lightClusters.getClusters().size());
+	m_LightIndicesBuffer->setData(lightClusters.getLightIndices().data(), lightClusters.getLightIndices().size());
+	m_LightDataBuffer->setData(lightData.data(), lightData.size());
+	m_LightClustersBuffer->bind(LIGHT_CLUSTERS_PS_CPP);
+	m_LightIndicesBuffer->bind(LIGHT_INDICES_PS_CPP);
+	m_LightDataBuffer->bind(LIGHT_DATA_PS_CPP);
 }
 
 void RenderSystem::perLevelPSCBBinds()
@@ -378,6 +588,7 @@ void RenderSystem::perLevelPSCBBinds()
 
 void RenderSystem::updatePerLevelBinds()
 {
+	LightSystem::GetSingleton()->updateStaticPointLights();
 	perLevelPSCBBinds();
 }
 
@@ -412,6 +623,7 @@ const Matrix& RenderSystem::getCurrentMatrix() const
 
 Variant RenderSystem::onOpenedLevel(const Event* event)
 {
+	LightSystem::GetSingleton()->bakeStaticLights(false);
 	updatePerLevelBinds();
 	return true;
 }
@@ -445,5 +657,13 @@ void RenderSystem::draw()
 	{
 		updatePerLevelBinds();
 	}
+
+	const RenderCounters& counters = m_Renderer->getCounters();
+	ImGui::Text("Draws: %d (%d instanced, %d instances)", counters.m_Draws, counters.m_InstancedDraws, counters.m_Instances);
+	ImGui::Text("Unbatched Instanceable Draws: %d", counters.m_UnbatchedDraws);
+	ImGui::Text("Material Binds: %d (%d skipped)", counters.m_MaterialBinds, counters.m_SkippedMaterialBinds);
+	ImGui::Text("Buffer Binds: %d (%d skipped)", counters.m_BufferBinds, counters.m_SkippedBufferBinds);
+	const ConstantBufferRing* constantBufferRing = ConstantBufferRing::GetSingleton();
+	ImGui::Text("Constant Buffer Ring: %d uploads, %d of %d KB", constantBufferRing->getLastFrameUploads(), (int)constantBufferRing->getAllocator().getLastFrameBytes() / 1024, (int)constantBufferRing->getAllocator().getCapacity() / 1024);
 }
 #endif
@@ -7,10 +7,14 @@
 #include "main/window.h"
 #include "components/visual/model_component.h"
 #include "renderer/render_pass.h"
+#include "renderer/frustum.h"
+#include "renderer/shader_resource_buffer.h"
 
 #include "PostProcess.h"
 
 #define LINE_INITIAL_RENDER_CACHE 1000
+/// Smallest number of consecutive draws of the same mesh and material that are merged into an instanced draw.
+#define INSTANCING_MINIMUM_BATCH 2
 
 class RenderSystem : public System
 {
@@ -20,11 +24,41 @@ class RenderSystem : public System
 		Vector<unsigned short> m_Indices;
 	};
 
+	/// Run of draw commands in the render queue drawn with a single instanced draw.
+	struct InstanceBatch
+	{
+		int m_Begin;
+		int m_End;
+		/// Index of the first instance of the run in m_InstanceData.
+		int m_StartInstance;
+	};
+
 	CameraComponent* m_Camera;
 	
 	Ptr<Renderer> m_Renderer;
 	Vector<Matrix> m_TransformationStack;
 
+	/// Models that passed culling this frame.
+	Vector<ModelComponent*> m_VisibleModels;
+	/// Invisible models and models outside the camera frustum. They are not drawn but still run preRender, so particles keep simulating.
+	Vector<ModelComponent*> m_CulledModels;
+	Vector<ModelComponent*> m_CullingCandidates;
+	Vector<BoundingBox> m_CullingBounds;
+	Vector<char> m_IsInsideFrustum;
+
+	RenderQueue m_RenderQueue;
+	/// Models referred to by the draw commands in m_RenderQueue.
+	Vector<ModelComponent*> m_QueuedModels;
+	/// Visible models that draw themselves.
+	Vector<ModelComponent*> m_ImmediateModels;
+
+	Vector<InstanceBatch> m_InstanceBatches;
+	Vector<InstanceData> m_InstanceData;
+	Ptr<InstanceBuffer> m_InstanceBuffer;
+	/// Static light lists of all instances, one after the other. Each instance refers to its own range.
+	Vector<unsigned int> m_InstanceStaticLights;
+	Ptr<ShaderResourceBuffer> m_InstanceStaticLightsBuffer;
+
 	Ref<BasicMaterial> m_LineMaterial;
 	LineRequests m_CurrentFrameLines;
 
@@ -32,6 +66,9 @@ class RenderSystem : public System
 	Microsoft::WRL::ComPtr<ID3D11Buffer> m_VSProjectionConstantBuffer;
 	Microsoft::WRL::ComPtr<ID3D11Buffer> m_PSPerFrameConstantBuffer;
 	Microsoft::WRL::ComPtr<ID3D11Buffer> m_PSPerLevelConstantBuffer;
+	Ptr<ShaderResourceBuffer> m_LightClustersBuffer;
+	Ptr<ShaderResourceBuffer> m_LightIndicesBuffer;
+	Ptr<ShaderResourceBuffer> m_LightDataBuffer;
 
 	bool m_IsEditorRenderPassEnabled;
 
@@ -59,6 +96,12 @@ class RenderSystem : public System
 	RenderSystem(RenderSystem&) = delete;
 	virtual ~RenderSystem() = default;
 
+	/// Fill m_VisibleModels with the visible models whose world bounds intersect the camera frustum, and m_CulledModels with the rest.
+	void cullModels();
+	/// Collect the draws of all visible models in m_RenderQueue and sort them.
+	void buildRenderQueue();
+	/// Find the runs of instanceable draws in a range of the render queue and upload their transforms and static light lists.
+	void findInstanceBatches(int begin, int end);
 	void renderPassRender(float deltaMilliseconds, RenderPass renderPass);
 
 	Variant onOpenedLevel(const Event* event);
@@ -68,6 +111,8 @@ public:
 	
 	void setConfig(const JSON::json& configData, bool openInEditor) override;
 	void update(float deltaMilliseconds) override;
+	/// Clear the frame without drawing any entity and bind it for UI to draw over. Used in place of update() while a level is being entered.
+	void clearFrame();
 	void renderLines();
 	void submitLine(const Vector3& from, const Vector3& to);
 	void recoverLostDevice();
@@ -75,7 +120,6 @@ public:
 	void setCamera(CameraComponent* camera);
 	void restoreCamera();
 
-	void calculateTransforms(HierarchyComponent* hierarchyComponent);
 	void pushMatrix(const Matrix& transform);
 	void pushMatrixOverride(const Matrix& transform);
 	void popMatrix();
@@ -95,8 +139,11 @@ public:
 	void resetRenderMode();
 
 	CameraComponent* getCamera() const { return m_Camera; }
+	int getVisibleModelCount() const { return m_VisibleModels.size(); }
 	const Matrix& getCurrentMatrix() const;
 	const Renderer* getRenderer() const { return m_Renderer.get(); }
+	/// Binds and draws issued by the renderer in the last completed frame.
+	const RenderCounters& getRenderCounters() const { return m_Renderer->getCounters(); }
 
 #ifdef ROOTEX_EDITOR
 	void draw() override;
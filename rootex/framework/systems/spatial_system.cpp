@@ -0,0 +1,114 @@
+#include "spatial_system.h"
+
+#include "systems/hierarchy_system.h"
+
+SpatialSystem::SpatialSystem()
+    : System("SpatialSystem", UpdateOrder::Async, false)
+{
+}
+
+SpatialSystem* SpatialSystem::GetSingleton()
+{
+	// Never destructed, transforms may still be removed while static objects are destroyed on exit
+	static SpatialSystem* singleton = new SpatialSystem();
+	return singleton;
+}
+
+void SpatialSystem::RegisterAPI(sol::table& rootex)
+{
+	sol::usertype<SpatialSystem> spatialSystem = rootex.new_usertype<SpatialSystem>("SpatialSystem");
+	spatialSystem["Get"] = &SpatialSystem::GetSingleton;
+	spatialSystem["queryBox"] = [](SpatialSystem* s, const Vector3& center, const Vector3& extents) { return s->queryBounds(BoundingBox(center, extents)); };
+	spatialSystem["querySphere"] = &SpatialSystem::querySphere;
+	spatialSystem["queryFrustum"] = [](SpatialSystem* s, const Matrix& viewProjection) { return s->queryFrustum(Frustum(viewProjection)); };
+	spatialSystem["queryRay"] = [](SpatialSystem* s, const Vector3& origin, const Vector3& direction, float maxDistance) { return s->queryRay(Ray(origin, direction), maxDistance); };
+}
+
+void SpatialSystem::updateBounds()
+{
+	HierarchySystem* hierarchy = HierarchySystem::GetSingleton();
+	const auto& transformOrder = hierarchy->getTransformOrder();
+	// The root entity is the world origin and is not indexed
+	for (int i = 1; i < transformOrder.size(); i++)
+	{
+		TransformComponent* transform = transformOrder[i].m_Transform;
+		if (!transform || !hierarchy->isTransformChanged(i))
+		{
+			continue;
+		}
+
+		BoundingBox bounds = Frustum::TransformBounds(transform->getBounds(), hierarchy->getAbsoluteTransform(i));
+		if (transform->m_SpatialProxy == BVH_NULL_NODE)
+		{
+			transform->m_SpatialProxy = m_Tree.createProxy(bounds, transform);
+		}
+		else
+		{
+			m_Tree.moveProxy(transform->m_SpatialProxy, bounds);
+		}
+	}
+}
+
+void SpatialSystem::removeTransform(TransformComponent* transform)
+{
+	if (transform->m_SpatialProxy != BVH_NULL_NODE)
+	{
+		m_Tree.destroyProxy(transform->m_SpatialProxy);
+		transform->m_SpatialProxy = BVH_NULL_NODE;
+	}
+}
+
+Vector<Ref<Entity>> SpatialSystem::collectEntities() const
+{
+	Vector<Ref<Entity>> entities;
+	entities.reserve(m_QueryResults.size());
+	for (int proxy : m_QueryResults)
+	{
+		entities.push_back(((TransformComponent*)m_Tree.getUserData(proxy))->getOwner());
+	}
+	return entities;
+}
+
+Vector<Ref<Entity>> SpatialSystem::queryBounds(const BoundingBox& bounds) const
+{
+	m_QueryResults.clear();
+	m_Tree.queryBounds(bounds, m_QueryResults);
+	return collectEntities();
+}
+
+Vector<Ref<Entity>> SpatialSystem::querySphere(const Vector3& center, float radius) const
+{
+	m_QueryResults.clear();
+	m_Tree.querySphere(BoundingSphere(center, radius), m_QueryResults);
+	return collectEntities();
+}
+
+Vector<Ref<Entity>> SpatialSystem::queryFrustum(const Frustum& frustum) const
+{
+	m_QueryResults.clear();
+	m_Tree.queryFrustum(frustum, m_QueryResults);
+	return collectEntities();
+}
+
+Vector<Ref<Entity>> SpatialSystem::queryRay(const Ray& ray, float maxDistance) const
+{
+	m_QueryResults.clear();
+	m_Tree.queryRay(ray, maxDistance, m_QueryResults);
+
+	Vector3 direction = ray.direction;
+	direction.Normalize();
+	Vector<Pair<float, int>> hits;
+	for (int proxy : m_QueryResults)
+	{
+		float distance = 0.0f;
+		m_Tree.getBounds(proxy).Intersects(ray.position, direction, distance);
+		hits.push_back({ distance, proxy });
+	}
+	std::sort(hits.begin(), hits.end());
+
+	for (int i = 0; i < hits.size(); i++)
+	{
+		m_QueryResults[i] = hits[i].second;
+	}
+	return collectEntities();
+}
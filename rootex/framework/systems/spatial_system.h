@@ -0,0 +1,37 @@
+#pragma once
+
+#include "framework/system.h"
+#include "components/transform_component.h"
+#include "core/bounding_volume_hierarchy.h"
+
+/// Spatial index of the world bounds of all entities with a TransformComponent.
+/// Bounds are refreshed incrementally from the transforms HierarchySystem changed, once per frame after transforms are propagated.
+class SpatialSystem : public System
+{
+	BoundingVolumeHierarchy m_Tree;
+	/// Reused between queries to avoid allocations.
+	mutable Vector<int> m_QueryResults;
+
+	SpatialSystem();
+	SpatialSystem(SpatialSystem&) = delete;
+	virtual ~SpatialSystem() = default;
+
+	Vector<Ref<Entity>> collectEntities() const;
+
+public:
+	static SpatialSystem* GetSingleton();
+	static void RegisterAPI(sol::table& rootex);
+
+	/// Refresh the bounds of the transforms changed in the last HierarchySystem::updateTransforms().
+	void updateBounds();
+	/// Stop tracking a transform. Called when the component is removed.
+	void removeTransform(TransformComponent* transform);
+
+	Vector<Ref<Entity>> queryBounds(const BoundingBox& bounds) const;
+	Vector<Ref<Entity>> querySphere(const Vector3& center, float radius) const;
+	Vector<Ref<Entity>> queryFrustum(const Frustum& frustum) const;
+	/// Returns the entities hit by the ray within maxDistance, closest first.
+	Vector<Ref<Entity>> queryRay(const Ray& ray, float maxDistance) const;
+
+	const BoundingVolumeHierarchy& getTree() const { return m_Tree; }
+};
@@ -1,6 +1,7 @@
 #include "transform_animation_system.h"
 
 #include "components/transform_animation_component.h"
+#include "components/transform_component.h"
 
 TransformAnimationSystem* TransformAnimationSystem::GetSingleton()
 {
@@ -11,32 +12,28 @@ TransformAnimationSystem* TransformAnimationSystem::GetSingleton()
 TransformAnimationSystem::TransformAnimationSystem()
     : System("TransformationAnimationSystem", UpdateOrder::Update, true)
 {
+	declareWrite(TransformAnimationComponent::s_ID);
+	declareWrite(TransformComponent::s_ID);
+	setMainThreadOnly(false);
 }
 
 void TransformAnimationSystem::begin()
 {
-	TransformAnimationComponent* animation = nullptr;
-	for (auto& component : s_Components[TransformAnimationComponent::s_ID])
-	{
-		animation = (TransformAnimationComponent*)component;
-		
-		if (animation->isPlayOnStart())
+	TransformAnimationComponent::GetPool().forEach([](TransformAnimationComponent* animation) {
+		if (animation->isRegistered() && animation->isPlayOnStart())
 		{
 			animation->setPlaying(true);
 		}
-	}
+	});
 }
 
 void TransformAnimationSystem::update(float deltaMilliseconds)
 {
-	TransformAnimationComponent* animation = nullptr;
-	for (auto& component : s_Components[TransformAnimationComponent::s_ID])
-	{
-		animation = (TransformAnimationComponent*)component;
-
-		if (animation->isPlaying() && !animation->hasEnded())
+	// Walk the pool in memory order instead of the registered pointers
+	TransformAnimationComponent::GetPool().forEach([deltaMilliseconds](TransformAnimationComponent* animation) {
+		if (animation->isRegistered() && animation->isPlaying() && !animation->hasEnded())
 		{
 			animation->interpolate(deltaMilliseconds * MS_TO_S);
 		}
-	}
+	});
 }
@@ -43,6 +43,7 @@ UISystem::UISystem()
     : System("UISystem", UpdateOrder::UI, true)
 	, m_Context(nullptr)
 {
+	setLevelIndependent(true);
 	BIND_EVENT_MEMBER_FUNCTION("UISystemEnableDebugger", UISystem::enableDebugger);
 	BIND_EVENT_MEMBER_FUNCTION("UISystemDisableDebugger", UISystem::disableDebugger);
 }
@@ -124,9 +125,11 @@ bool UISystem::initialize(const JSON::json& systemData)
 void UISystem::update(float deltaMilliseconds)
 {
 	m_Context->Update();
+	m_RmlRenderInterface->beginFrame();
 	RenderingDevice::GetSingleton()->setAlphaBS();
 	RenderingDevice::GetSingleton()->setTemporaryUIRS();
 	m_Context->Render();
+	m_RmlRenderInterface->flush();
 }
 
 void UISystem::shutDown()
@@ -152,5 +155,13 @@ void UISystem::draw()
 	}
 
 	ImGui::Text("Press F8 in game");
+
+	const UITextureAtlas& atlas = m_RmlRenderInterface->getAtlas();
+	ImGui::Text("Textures: %d", m_RmlRenderInterface->getLiveTextureCount());
+	ImGui::Text("Draws: %d", m_RmlRenderInterface->getLastFrameDraws());
+	for (int i = 0; i < atlas.getPageCount(); i++)
+	{
+		ImGui::Text("Atlas page %d: %.1f%% used", i, atlas.getOccupancy(i) * 100.0f);
+	}
 }
 #endif
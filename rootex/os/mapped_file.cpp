@@ -0,0 +1,72 @@
+#include "mapped_file.h"
+
+#include "os.h"
+
+MappedFile::MappedFile()
+    : m_File(INVALID_HANDLE_VALUE)
+    , m_Mapping(nullptr)
+    , m_Data(nullptr)
+    , m_Size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const String& path)
+{
+	close();
+
+	// Other processes may still replace or delete the file, only writing into it in place fails while it is mapped
+	m_File = CreateFileW(OS::GetAbsolutePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_Mapping)
+	{
+		close();
+		return false;
+	}
+
+	m_Data = (const char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_Data)
+	{
+		close();
+		return false;
+	}
+
+	m_Size = size.QuadPart;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+		m_Data = nullptr;
+	}
+	if (m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+		m_Mapping = nullptr;
+	}
+	if (m_File != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_File);
+		m_File = INVALID_HANDLE_VALUE;
+	}
+	m_Size = 0;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "common/types.h"
+
+/// Read only view of a whole file mapped into memory.
+/// Pages are read from disk by the OS when they are first touched, so data can be handed to its consumer without copying it into a buffer first.
+class MappedFile
+{
+	HANDLE m_File;
+	HANDLE m_Mapping;
+	const char* m_Data;
+	size_t m_Size;
+
+public:
+	MappedFile();
+	MappedFile(MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&) = delete;
+	~MappedFile();
+
+	/// Map the file at a path relative to the Rootex root. Returns false if the file could not be mapped. Empty files cannot be mapped.
+	bool open(const String& path);
+	void close();
+
+	bool isOpen() const { return m_Data != nullptr; }
+	const char* getData() const { return m_Data; }
+	size_t getSize() const { return m_Size; }
+};
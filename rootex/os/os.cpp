@@ -6,6 +6,7 @@
 
 #include "common/common.h"
 #include "resource_data.h"
+#include "mapped_file.h"
 
 #ifdef ROOTEX_EDITOR
 #include "event_manager.h"
@@ -365,33 +366,34 @@ FileTimePoint OS::GetFileLastChangedTime(const String& filePath)
 
 FileBuffer OS::LoadFileContents(String stringPath)
 {
-	std::filesystem::path path = GetAbsolutePath(stringPath);
-
-	if (!IsExists(path.generic_string()))
+	if (!IsExists(stringPath))
 	{
-		ERR("OS: File IO error: " + path.generic_string() + " does not exist");
+		ERR("OS: File IO error: " + GetAbsolutePath(stringPath).generic_string() + " does not exist");
 		return FileBuffer();
 	}
 
-	std::ifstream stream;
-	try
+	Ref<MappedFile> mappedFile = MapFileContents(stringPath);
+	if (!mappedFile)
 	{
-		stream.open(path.generic_string(), std::ifstream::ate | std::ios::binary);
-	}
-	catch (std::exception e)
-	{
-		ERR(std::string("OS: File IO error: ") + std::string(e.what()));
+		// Empty files cannot be mapped, anything else could not be opened
+		std::error_code error;
+		if (std::filesystem::file_size(GetAbsolutePath(stringPath), error) != 0)
+		{
+			ERR("OS: File IO error: " + GetAbsolutePath(stringPath).generic_string() + " could not be read");
+		}
 		return FileBuffer();
 	}
+	return FileBuffer(mappedFile->getData(), mappedFile->getData() + mappedFile->getSize());
+}
 
-	std::ifstream::pos_type pos = stream.tellg();
-	std::vector<char> buffer(pos);
-
-	stream.seekg(0, std::ios_base::beg);
-	stream.read(buffer.data(), pos);
-
-	stream.close();
-	return FileBuffer(buffer);
+Ref<MappedFile> OS::MapFileContents(const String& stringPath)
+{
+	Ref<MappedFile> mappedFile(new MappedFile());
+	if (!mappedFile->open(stringPath))
+	{
+		return nullptr;
+	}
+	return mappedFile;
 }
 
 bool OS::IsExists(String relativePath)
@@ -462,8 +464,10 @@ bool OS::SaveFile(const FilePath& filePath, ResourceData* fileData)
 
 	try
 	{
+		// Copies mapped data before the file is truncated, files cannot be truncated while they are mapped
+		FileBuffer* data = fileData->getRawData();
 		outFile.open(GetAbsolutePath(filePath.generic_string()), std::ios::out | std::ios::binary);
-		outFile.write(fileData->getRawData()->data(), fileData->getRawDataByteSize());
+		outFile.write(data->data(), data->size());
 	}
 	catch (std::exception e)
 	{
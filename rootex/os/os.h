@@ -15,6 +15,7 @@ typedef Vector<char> FileBuffer;
 typedef std::chrono::time_point<std::filesystem::file_time_type::clock> FileTimePoint; 
 
 class ResourceData;
+class MappedFile;
 
 /// Provides features that are provided directly by the OS.
 class OS
@@ -47,7 +48,10 @@ public:
 	static FileTimePoint GetFileLastChangedTime(const String& filePath);
 
 	static bool IsExists(String relativePath);
+	/// Read a whole file into a buffer. The file is read through a mapping instead of a stream.
 	static FileBuffer LoadFileContents(String stringPath);
+	/// Map a whole file into memory, to be shared by everything that reads it. Returns nullptr if the file is missing or empty.
+	static Ref<MappedFile> MapFileContents(const String& stringPath);
 	static FilePath GetAbsolutePath(String stringPath);
 	static FilePath GetRootRelativePath(String stringPath);
 	static FilePath GetRelativePath(String stringPath, String base);
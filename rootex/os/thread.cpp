@@ -1,235 +1,417 @@
 #include "thread.h"
-#include <Windows.h>
 
-/// The main function which runs on every thread.
-DWORD WINAPI MainLoop(LPVOID voidParameters);
+#include <algorithm>
+#include <iostream>
 
-Task::Task(const Function<void()>& executionTask)
-    : m_ExecutionTask(executionTask)
+thread_local int ThreadPool::s_WorkerIndex = -1;
+
+TaskCounter::TaskCounter(int pending)
+    : m_Pending(pending)
 {
 }
 
-void Task::execute()
+TaskHandle::TaskHandle()
+    : m_Counter(nullptr)
+    , m_ThreadPool(nullptr)
 {
-	m_ExecutionTask();
 }
 
-void ThreadPool::initialize()
+TaskHandle::TaskHandle(const std::shared_ptr<TaskCounter>& counter, ThreadPool* threadPool)
+    : m_Counter(counter)
+    , m_ThreadPool(threadPool)
 {
-	SYSTEM_INFO sysInfo;
-	GetSystemInfo(&sysInfo);
-	m_Threads = sysInfo.dwNumberOfProcessors;
+}
 
-	m_IsRunning = true;
+bool TaskHandle::isReady() const
+{
+	return !m_Counter || m_Counter->isCompleted();
+}
+
+void TaskHandle::wait() const
+{
+	if (m_ThreadPool)
+	{
+		m_ThreadPool->wait(*this);
+	}
+}
 
-	InitializeConditionVariable(&m_ConsumerVariable);
-	InitializeConditionVariable(&m_ProducerVariable);
-	InitializeCriticalSection(&m_CriticalSection);
+Task::Task(const std::function<void()>& executionTask)
+    : m_Dependencies(0)
+    , m_ExecutionTask(executionTask)
+    , m_IsBackground(false)
+{
+}
 
-	m_DefaultWorkerParameter.m_Thread = 0;
-	m_DefaultWorkerParameter.m_ThreadPool = NULL;
+void Task::execute()
+{
+	m_ExecutionTask();
+}
 
+int TaskGraph::add(const std::function<void()>& job)
+{
+	m_Tasks.emplace_back(new Task(job));
+	return (int)m_Tasks.size() - 1;
+}
+
+void TaskGraph::precede(int predecessor, int successor)
+{
+	m_Tasks[predecessor]->m_Permissions.push_back(successor);
+}
+
+void TaskGraph::precede(const std::vector<int>& predecessors, int successor)
+{
+	for (int predecessor : predecessors)
 	{
-		m_TaskQueue.m_Read = 0;
-		m_TaskQueue.m_Write = 0;
-		m_TaskQueue.m_Jobs = 0;
-		m_TasksFinished = 0;
-		m_TasksComplete.m_Jobs = 0;
+		precede(predecessor, successor);
 	}
+}
 
-	for (__int32 iThread = 0; iThread < m_Threads; iThread++)
+void WorkQueue::push(const std::shared_ptr<Task>& task)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Tasks.push_back(task);
+}
+
+std::shared_ptr<Task> WorkQueue::pop()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Tasks.empty())
 	{
-		m_WorkerParameters.push_back(m_DefaultWorkerParameter);
-		m_Handles.push_back(m_DefaultHandle);
+		return nullptr;
 	}
+	std::shared_ptr<Task> task = m_Tasks.back();
+	m_Tasks.pop_back();
+	return task;
+}
 
-	for (__int32 iThread = 0; iThread < m_Threads; iThread++)
+std::shared_ptr<Task> WorkQueue::steal()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Tasks.empty())
 	{
-		m_WorkerParameters[iThread].m_Thread = iThread;
-		m_WorkerParameters[iThread].m_ThreadPool = this;
-		m_Handles[iThread] = CreateThread(NULL, 0, MainLoop, &m_WorkerParameters[iThread], 0, 0);
+		return nullptr;
 	}
+	std::shared_ptr<Task> task = m_Tasks.front();
+	m_Tasks.pop_front();
+	return task;
 }
 
-DWORD WINAPI MainLoop(LPVOID voidParameters)
+void ThreadPool::initialize(int threads)
 {
-	const struct WorkerParameters* parameters = (struct WorkerParameters*)voidParameters;
+	// The thread that waits on tasks helps in executing them, so leave a core for it
+	m_Threads = threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency() - 1);
 
-	const __int32 iThread = parameters->m_Thread;
-	ThreadPool& threadPool = *parameters->m_ThreadPool;
+	m_IsRunning = true;
+	m_NextQueue = 0;
+	m_QueuedTasks = 0;
+	m_QueuedBackgroundTasks = 0;
+	m_UnfinishedTasks = 0;
+	m_Waiters = 0;
 
-	__int32 taskId = -1;
-	__int32 increment = 0;
+	for (int iThread = 0; iThread < m_Threads; iThread++)
+	{
+		m_Queues.emplace_back(new WorkQueue());
+	}
 
-	while (true)
+	for (int iThread = 0; iThread < m_Threads; iThread++)
 	{
-		EnterCriticalSection(&threadPool.m_CriticalSection);
+		m_Workers.emplace_back(&ThreadPool::workerLoop, this, iThread);
+	}
+}
 
-		/*if (m_ThreadPool.m_TasksComplete.m_Jobs > 0)
-		{
-			m_ThreadPool.m_TasksComplete.ids.push_back(taskId);
-			m_ThreadPool.m_TasksComplete.m_Jobs += increment;
-			m_ThreadPool.m_TasksFinished += increment;
-			increment++;
-			std::cout << increment;
-		}*/
+void ThreadPool::reportError(const std::string& error)
+{
+	if (m_ErrorHandler)
+	{
+		m_ErrorHandler(error);
+	}
+	else
+	{
+		std::cerr << error << std::endl;
+	}
+}
 
-		WakeAllConditionVariable(&threadPool.m_ProducerVariable);
+void ThreadPool::workerLoop(int workerIndex)
+{
+	s_WorkerIndex = workerIndex;
 
-		while ((threadPool.m_TaskQueue.m_Jobs == 0) && threadPool.m_IsRunning)
+	while (m_IsRunning)
+	{
+		std::shared_ptr<Task> task = findTask(workerIndex);
+		if (task)
 		{
-			SleepConditionVariableCS(&threadPool.m_ConsumerVariable, &threadPool.m_CriticalSection, INFINITE);
+			run(task);
+			continue;
 		}
 
-		if (threadPool.m_IsRunning == false)
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_SleepVariable.wait(lock, [this]() { return m_QueuedTasks.load() > 0 || m_QueuedBackgroundTasks.load() > 0 || !m_IsRunning; });
+	}
+}
+
+void ThreadPool::enqueue(const std::shared_ptr<Task>& task)
+{
+	if (task->m_IsBackground)
+	{
+		m_BackgroundQueue.push(task);
+		m_QueuedBackgroundTasks++;
 		{
-			LeaveCriticalSection(&threadPool.m_CriticalSection);
-			return 0;
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
 		}
+		m_SleepVariable.notify_one();
+		return;
+	}
 
-		taskId = threadPool.m_TaskQueue.m_QueueJobs[threadPool.m_TaskQueue.m_Read]->m_ID;
-		__int32 readTemp = threadPool.m_TaskQueue.m_Read;
-		threadPool.m_TaskQueue.m_Jobs--;
-		threadPool.m_TaskQueue.m_Read++;
-
-		LeaveCriticalSection(&threadPool.m_CriticalSection);
+	int queueIndex = s_WorkerIndex;
+	if (queueIndex < 0 || queueIndex >= m_Threads)
+	{
+		queueIndex = m_NextQueue++ % m_Threads;
+	}
+	m_Queues[queueIndex]->push(task);
+	m_QueuedTasks++;
 
-		threadPool.m_TaskQueue.m_QueueJobs[readTemp]->execute();
-		threadPool.m_TasksComplete.m_Jobs++;
+	// Taking the lock makes sure a worker can't miss the wake up between testing the queue count and sleeping
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
 	}
-	return 0;
+	m_SleepVariable.notify_one();
+	notifyWaiters();
 }
 
-void ThreadPool::submit(Vector<Ref<Task>>& tasks)
+std::shared_ptr<Task> ThreadPool::findTask(int workerIndex)
 {
-	join();
+	bool isWorker = workerIndex >= 0 && workerIndex < m_Threads;
+	if (isWorker)
+	{
+		if (std::shared_ptr<Task> task = m_Queues[workerIndex]->pop())
+		{
+			m_QueuedTasks--;
+			return task;
+		}
+	}
+	else
+	{
+		workerIndex = m_NextQueue % m_Threads;
+	}
 
-	MasterThread masterThread;
-	masterThread.m_TasksComplete.m_Jobs = 0;
-	masterThread.m_TasksReady.m_Jobs = 0;
-	masterThread.m_TasksReady.m_Read = 0;
-	masterThread.m_TasksReady.m_Write = 0;
+	for (int offset = 1; offset <= m_Threads; offset++)
+	{
+		if (std::shared_ptr<Task> task = m_Queues[(workerIndex + offset) % m_Threads]->steal())
+		{
+			m_QueuedTasks--;
+			return task;
+		}
+	}
 
-	bool isTasksRemaining = true;
+	// Background tasks go last and in submission order, so per frame work on the workers is not held up behind them
+	if (isWorker)
+	{
+		if (std::shared_ptr<Task> task = m_BackgroundQueue.steal())
+		{
+			m_QueuedBackgroundTasks--;
+			return task;
+		}
+	}
 
-	m_TasksFinished = 0;
+	return nullptr;
+}
+
+void ThreadPool::run(const std::shared_ptr<Task>& task)
+{
+	try
+	{
+		task->execute();
+	}
+	catch (std::exception& e)
+	{
+		reportError("Task threw an exception: " + std::string(e.what()));
+	}
 
+	// Release successors before reporting completion so a ready handle never has tasks left to queue
+	for (auto& successor : task->m_Successors)
 	{
-		static __int32 idIndex = 0;
-		for (auto iJob : tasks)
+		if (successor->m_Dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
 		{
-			iJob->m_Dependencies = 0;
-			m_TaskQueue.m_QueueJobs.push_back(iJob);
-			m_TaskQueue.m_QueueJobs[idIndex]->m_ID = idIndex;
-			idIndex++;
+			enqueue(successor);
 		}
+	}
+	task->m_Successors.clear();
+
+	if (task->m_Counter)
+	{
+		task->m_Counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel);
+		task->m_Counter.reset();
+	}
+	m_UnfinishedTasks--;
+	notifyWaiters();
+}
+
+void ThreadPool::notifyWaiters()
+{
+	if (m_Waiters.load() == 0)
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_WaitMutex);
+	}
+	m_WaitVariable.notify_all();
+}
+
+void ThreadPool::sleepUntil(const std::function<bool()>& isDone)
+{
+	// Registering before testing the condition makes sure a task finishing in between notifies this thread
+	m_Waiters++;
+	{
+		std::unique_lock<std::mutex> lock(m_WaitMutex);
+		m_WaitVariable.wait(lock, [&]() { return isDone() || m_QueuedTasks.load() > 0; });
+	}
+	m_Waiters--;
+}
 
-		/*for (__int32 i_Job = 0; i_Job < tasks.size(); i_Job++)
+TaskHandle ThreadPool::submit(std::vector<std::shared_ptr<Task>>& tasks)
+{
+	std::vector<int> dependencies(tasks.size(), 0);
+	for (auto& task : tasks)
+	{
+		for (int permission : task->m_Permissions)
 		{
-			for (__int32 i_Permission = 0; i_Permission < tasks[i_Job]->m_Permisions; i_Permission++)
+			if (permission < 0 || permission >= (int)tasks.size())
 			{
-				tasks[tasks[i_Job]->i_Permissions[i_Permission]]->m_Dependencies++;
+				reportError("Task permits a task outside its submission: " + std::to_string(permission));
+				return TaskHandle();
 			}
-		}*/
+			dependencies[permission]++;
+		}
 	}
 
-	while (isTasksRemaining)
+	// Kahn's algorithm over a copy of the dependency counts to reject cycles before anything starts running
 	{
-
-		/*{
-			const __int32 nJobs = master_thread.m_TasksComplete.m_Jobs;
-			for (__int32 i_job = 0; i_job < nJobs; i_job++)
+		std::vector<int> remaining = dependencies;
+		std::vector<int> ready;
+		for (int i = 0; i < (int)tasks.size(); i++)
+		{
+			if (remaining[i] == 0)
 			{
-				__int32 taskId = master_thread.m_TasksComplete.ids[i_job];
-
-				for (__int32 i_Permission = 0; i_Permission < tasks[taskId]->m_Permisions; i_Permission++)
-				{
-					tasks[tasks[taskId]->i_Permissions[i_Permission]]->m_Dependencies--;
-				}
-				master_thread.m_TasksComplete.m_Jobs--;
+				ready.push_back(i);
 			}
-		}*/
+		}
+		int visited = 0;
+		while (!ready.empty())
 		{
-			__int32 iJob = 0;
-			while (iJob < tasks.size())
+			int current = ready.back();
+			ready.pop_back();
+			visited++;
+			for (int permission : tasks[current]->m_Permissions)
 			{
-				if (tasks[iJob]->m_Dependencies == 0)
+				if (--remaining[permission] == 0)
 				{
-					masterThread.m_TasksReady.m_IDs.push_back(tasks[iJob]->m_ID);
-					masterThread.m_TasksReady.m_Write++;
-					masterThread.m_TasksReady.m_Jobs++;
-					tasks[iJob]->m_Dependencies--;
+					ready.push_back(permission);
 				}
-				iJob++;
 			}
 		}
+		if (visited != (int)tasks.size())
+		{
+			reportError("Task dependencies contain a cycle, tasks were not submitted");
+			return TaskHandle();
+		}
+	}
 
-		EnterCriticalSection(&m_CriticalSection);
+	std::shared_ptr<TaskCounter> counter(new TaskCounter(tasks.size()));
+	m_UnfinishedTasks += tasks.size();
 
+	for (int i = 0; i < (int)tasks.size(); i++)
+	{
+		std::shared_ptr<Task>& task = tasks[i];
+		task->m_Counter = counter;
+		task->m_Dependencies = dependencies[i];
+		task->m_Successors.clear();
+		for (int permission : task->m_Permissions)
 		{
-			__int32 nJobs = masterThread.m_TasksReady.m_Jobs;
-			for (__int32 i_Job = 0; i_Job < nJobs; i_Job++)
-			{
-				m_TaskQueue.m_QueueJobs[m_TaskQueue.m_Write]->m_ID = masterThread.m_TasksReady.m_IDs[masterThread.m_TasksReady.m_Read];
-				m_TaskQueue.m_Write++;
-				m_TaskQueue.m_Jobs++;
-				m_TasksFinished++;
-				masterThread.m_TasksReady.m_Read++;
-				masterThread.m_TasksReady.m_Jobs--;
-			}
+			task->m_Successors.push_back(tasks[permission]);
 		}
+	}
 
-		WakeAllConditionVariable(&m_ConsumerVariable);
-
-		while ((m_TasksComplete.m_Jobs == 0) && m_IsRunning)
+	for (int i = 0; i < (int)tasks.size(); i++)
+	{
+		if (dependencies[i] == 0)
 		{
-			SleepConditionVariableCS(&m_ProducerVariable, &m_CriticalSection, INFINITE);
+			enqueue(tasks[i]);
 		}
+	}
 
-		/*{
-			const __int32 nJobs = m_TasksComplete.m_Jobs;
-			for (__int32 i_Job = 0; i_Job < nJobs; i_Job++)
-			{
+	return TaskHandle(counter, this);
+}
 
-				master_thread.m_TasksComplete.ids[i_Job] = m_TasksComplete.ids[i_Job];
-				master_thread.m_TasksComplete.m_Jobs++;
-				m_TasksComplete.m_Jobs--;
-			}
-		}*/
+TaskHandle ThreadPool::submit(TaskGraph& graph)
+{
+	return submit(graph.getTasks());
+}
+
+TaskHandle ThreadPool::submit(const std::function<void()>& job)
+{
+	std::vector<std::shared_ptr<Task>> tasks = { std::shared_ptr<Task>(new Task(job)) };
+	return submit(tasks);
+}
 
-		isTasksRemaining = m_TasksFinished < tasks.size();
+bool ThreadPool::help()
+{
+	std::shared_ptr<Task> task = findTask(s_WorkerIndex);
+	if (task)
+	{
+		run(task);
+		return true;
+	}
+	return false;
+}
 
-		LeaveCriticalSection(&m_CriticalSection);
+void ThreadPool::wait(const TaskHandle& handle)
+{
+	while (!handle.isReady())
+	{
+		if (!help())
+		{
+			// Remaining tasks are already running on other threads
+			sleepUntil([&]() { return handle.isReady(); });
+		}
 	}
 }
 
 bool ThreadPool::isCompleted() const
 {
-	return m_TaskQueue.m_QueueJobs.size() == m_TasksComplete.m_Jobs;
+	return m_UnfinishedTasks.load() == 0;
 }
 
-void ThreadPool::join() const
+void ThreadPool::join()
 {
 	while (!isCompleted())
 	{
-		;
+		if (!help())
+		{
+			sleepUntil([this]() { return isCompleted(); });
+		}
 	}
 }
 
 void ThreadPool::shutDown()
 {
-	EnterCriticalSection(&this->m_CriticalSection);
+	join();
+
 	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
 		m_IsRunning = false;
 	}
-	LeaveCriticalSection(&this->m_CriticalSection);
-	WakeAllConditionVariable(&this->m_ConsumerVariable);
-	WaitForMultipleObjects(m_Threads, m_Handles.data(), TRUE, INFINITE);
+	m_SleepVariable.notify_all();
+
+	for (auto& worker : m_Workers)
+	{
+		worker.join();
+	}
 }
 
-ThreadPool::ThreadPool()
+ThreadPool::ThreadPool(int threads)
 {
-	initialize();
+	initialize(threads);
 }
 
 ThreadPool::~ThreadPool()
@@ -1,98 +1,191 @@
 #pragma once
 
-#include "common/common.h"
-
-#include <Windows.h>
+// Only the standard library is used here so the job system can be built and tested without the rest of the engine
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 /// Interface for spawning and maintenance of threads.
 class ThreadPool;
 
-/// Defines jobs to be run on threads.
-class Task
+/// Shared completion state of a batch of submitted tasks.
+class TaskCounter
 {
-public:
-	__int32 m_ID;
-	__int32 m_Dependencies;
-	Vector<__int32> m_Permissions;
-	Function<void()> m_ExecutionTask;
+	std::atomic<int> m_Pending;
 
-	Task(const Function<void()>& executionTask);
-	Task(const Task&) = default;
-	~Task() = default;
+	friend class ThreadPool;
 
-	void execute();
+public:
+	TaskCounter(int pending);
+	TaskCounter(TaskCounter&) = delete;
+	~TaskCounter() = default;
+
+	bool isCompleted() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+	int getPending() const { return m_Pending.load(std::memory_order_acquire); }
 };
 
-/// Worker thread parameters.
-struct WorkerParameters
+/// Future-style handle to submitted tasks. Becomes ready when all tasks it tracks have executed.
+class TaskHandle
 {
-	__int32 m_Thread;
+	std::shared_ptr<TaskCounter> m_Counter;
 	ThreadPool* m_ThreadPool;
+
+public:
+	TaskHandle();
+	TaskHandle(const std::shared_ptr<TaskCounter>& counter, ThreadPool* threadPool);
+	TaskHandle(const TaskHandle&) = default;
+	~TaskHandle() = default;
+
+	/// Returns true if all tracked tasks have been completed. An empty handle is always ready.
+	bool isReady() const;
+	/// Returns when all tracked tasks have been completed. Executes pending tasks on the calling thread meanwhile.
+	void wait() const;
 };
 
-/// A queue of jobs.
-struct TaskQueue
+/// Defines jobs to be run on threads.
+/// Tasks submitted together may be ordered by listing the indices of the tasks they permit to run in m_Permissions.
+/// Background tasks are only run by worker threads, never by a thread helping out in ThreadPool::help() or ThreadPool::wait().
+class Task
 {
-	__int32 m_Jobs;
-	unsigned __int32 m_Write;
-	unsigned __int32 m_Read;
-	Vector<Ref<Task>> m_QueueJobs;
+	std::shared_ptr<TaskCounter> m_Counter;
+	/// Number of unfinished tasks that need to finish before this one can run.
+	std::atomic<int> m_Dependencies;
+	/// Tasks waiting on this task, resolved from m_Permissions on submission.
+	std::vector<std::shared_ptr<Task>> m_Successors;
+
+	friend class ThreadPool;
+
+public:
+	/// Indices of tasks, in the same submission, that can only run after this task has finished.
+	std::vector<int> m_Permissions;
+	std::function<void()> m_ExecutionTask;
+	/// Set for long jobs, like streaming in files, that must not stall a thread waiting on other work.
+	bool m_IsBackground;
+
+	Task(const std::function<void()>& executionTask);
+	Task(Task&) = delete;
+	~Task() = default;
+
+	void execute();
 };
 
-/// Contains the information of completed jobs.
-struct TaskComplete
+/// A set of tasks with ordering constraints, submitted to the ThreadPool in one go.
+/// Tasks run in parallel wherever the edges allow.
+class TaskGraph
 {
-	__int32 m_Jobs;
-	Vector<__int32> m_IDs;
-};
+	std::vector<std::shared_ptr<Task>> m_Tasks;
 
-/// Contains information of jobs ready for execution.
-struct TaskReady
-{	
-	__int32 m_Jobs;
-	unsigned __int32 m_Write;
-	unsigned __int32 m_Read;
-	Vector<__int32> m_IDs;
+public:
+	TaskGraph() = default;
+	TaskGraph(TaskGraph&) = delete;
+	~TaskGraph() = default;
+
+	/// Add a job to the graph. Returns the index of its task.
+	int add(const std::function<void()>& job);
+	/// Make the task at successor wait for the task at predecessor to finish.
+	void precede(int predecessor, int successor);
+	/// Make the task at successor wait for all the tasks at predecessors to finish.
+	void precede(const std::vector<int>& predecessors, int successor);
+
+	std::shared_ptr<Task> getTask(int index) { return m_Tasks[index]; }
+	std::vector<std::shared_ptr<Task>>& getTasks() { return m_Tasks; }
+	bool isEmpty() const { return m_Tasks.empty(); }
 };
 
-/// Master thread to communicate with and maintain worker threads.
-struct MasterThread
-{	
-	TaskComplete m_TasksComplete;
-	TaskReady m_TasksReady;
+/// A double ended queue of tasks owned by a worker thread.
+/// The owner pushes and pops from the back while other threads steal from the front.
+class WorkQueue
+{
+	std::mutex m_Mutex;
+	std::deque<std::shared_ptr<Task>> m_Tasks;
+
+public:
+	WorkQueue() = default;
+	WorkQueue(WorkQueue&) = delete;
+	~WorkQueue() = default;
+
+	void push(const std::shared_ptr<Task>& task);
+	/// Pop the most recently pushed task. Used by the owning worker.
+	std::shared_ptr<Task> pop();
+	/// Pop the least recently pushed task. Used by threads that have run out of work.
+	std::shared_ptr<Task> steal();
 };
 
+/// Work stealing scheduler. Each worker thread owns a WorkQueue and steals from other workers when it runs dry.
 class ThreadPool
 {
-	bool m_IsRunning;
-	__int32 m_Threads;
-	Vector<WorkerParameters> m_WorkerParameters;
-	WorkerParameters m_DefaultWorkerParameter;
-	Vector<HANDLE> m_Handles;
-	HANDLE m_DefaultHandle = 0;
-	CONDITION_VARIABLE m_ConsumerVariable;
-	CONDITION_VARIABLE m_ProducerVariable;
-	CRITICAL_SECTION m_CriticalSection;
-
-	__int32 m_TasksFinished;
-	TaskQueue m_TaskQueue;
-	TaskComplete m_TasksComplete;
-
-	friend DWORD WINAPI MainLoop(LPVOID voidParameters);
-
-	void initialize();
+	static thread_local int s_WorkerIndex;
+
+	std::atomic<bool> m_IsRunning;
+	int m_Threads;
+	std::vector<std::thread> m_Workers;
+	std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+	std::atomic<unsigned int> m_NextQueue;
+	/// Background tasks, shared by all workers and run once their own queues are empty.
+	WorkQueue m_BackgroundQueue;
+
+	/// Number of tasks sitting in worker queues, used to put idle workers and waiting threads to sleep.
+	std::atomic<int> m_QueuedTasks;
+	/// Number of tasks sitting in the background queue. Only wakes workers.
+	std::atomic<int> m_QueuedBackgroundTasks;
+	/// Number of tasks submitted but not yet executed.
+	std::atomic<int> m_UnfinishedTasks;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_SleepVariable;
+
+	/// Number of threads blocked in wait() or join(), so finishing tasks only notify when someone is waiting.
+	std::atomic<int> m_Waiters;
+	std::mutex m_WaitMutex;
+	std::condition_variable m_WaitVariable;
+
+	/// Receives errors of submissions and exceptions thrown by tasks.
+	std::function<void(const std::string&)> m_ErrorHandler;
+
+	void initialize(int threads);
+	void reportError(const std::string& error);
 	void shutDown();
 
+	void workerLoop(int workerIndex);
+	void enqueue(const std::shared_ptr<Task>& task);
+	std::shared_ptr<Task> findTask(int workerIndex);
+	void run(const std::shared_ptr<Task>& task);
+	void notifyWaiters();
+	/// Block until isDone returns true or a task is queued that the calling thread can help with.
+	void sleepUntil(const std::function<bool()>& isDone);
+
 public:
-	ThreadPool();
+	/// Spawns threads workers, or one less than the hardware threads if threads is 0.
+	ThreadPool(int threads = 0);
 	ThreadPool(ThreadPool&) = delete;
-	~ThreadPool();	
-
-	/// To submit a job to the jobs queue.
-	void submit(Vector<Ref<Task>>& tasks);
+	~ThreadPool();
+
+	/// Queue jobs for execution and return immediately. The handle becomes ready when all of them have run.
+	/// Tasks are released to workers as soon as all the tasks permitting them have finished.
+	TaskHandle submit(std::vector<std::shared_ptr<Task>>& tasks);
+	/// Queue all tasks in a graph for execution and return immediately.
+	TaskHandle submit(TaskGraph& graph);
+	/// Queue a single job for execution and return immediately.
+	TaskHandle submit(const std::function<void()>& job);
+
+	/// Execute one pending task on the calling thread, if there is one. Returns false if no task was found.
+	/// Background tasks are left to the workers unless the caller is a worker itself.
+	bool help();
+	/// Returns when the handle is ready. Executes pending tasks on the calling thread meanwhile.
+	void wait(const TaskHandle& handle);
 
 	/// Returns true if all tasks have been completed
 	bool isCompleted() const;
-	/// Returns when all the tasks have been completed
-	void join() const;
+	/// Returns when all the tasks have been completed. Executes pending tasks on the calling thread meanwhile.
+	void join();
+
+	/// Errors are written to the standard error stream until a handler is set. Set it before submitting tasks.
+	void setErrorHandler(const std::function<void(const std::string&)>& errorHandler) { m_ErrorHandler = errorHandler; }
+
+	int getThreadCount() const { return m_Threads; }
 };
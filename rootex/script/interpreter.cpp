@@ -11,6 +11,7 @@
 #include "components/physics/box_collider_component.h"
 #include "components/trigger_component.h"
 #include "entity_factory.h"
+#include "systems/spatial_system.h"
 #include "event_manager.h"
 #include "script/interpreter.h"
 #include "core/input/input_manager.h"
@@ -133,4 +134,5 @@ void LuaInterpreter::registerTypes()
 	RenderUIComponent::RegisterAPI(rootex);
 	TextUIComponent::RegisterAPI(rootex);
 	PhysicsColliderComponent::RegisterAPI(rootex);
+	SpatialSystem::RegisterAPI(rootex);
 }
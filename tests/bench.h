@@ -0,0 +1,22 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+/// Run a job repeatedly and print the average time of a run in milliseconds.
+template <class Job>
+void Benchmark(const std::string& name, int runs, const Job& job)
+{
+	job();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < runs; i++)
+	{
+		job();
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double milliseconds = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+	std::cout << name << ": " << milliseconds << " ms\n";
+}
@@ -0,0 +1,59 @@
+#include "bench.h"
+
+#include "framework/entity_factory.h"
+#include "framework/components/transform_component.h"
+
+#include <random>
+
+/// Number of components the benchmark works on.
+#define BENCH_TRANSFORM_COUNT 100000
+/// Bytes allocated next to every heap allocated component, standing in for the rest of its entity.
+#define BENCH_NEIGHBOUR_SIZE 192
+
+int main()
+{
+	// Before pooling every component was a heap allocation of its own, in between the other allocations of its entity
+	Vector<Ref<Component>> heapTransforms;
+	Vector<Ptr<char[]>> neighbours;
+	TransformComponent::GetPool().setBypassed(true);
+	Benchmark("Create 100k TransformComponents on the heap", 1, [&]() {
+		heapTransforms.clear();
+		neighbours.clear();
+		for (int i = 0; i < BENCH_TRANSFORM_COUNT; i++)
+		{
+			heapTransforms.push_back(EntityFactory::GetSingleton()->createDefaultComponent("TransformComponent"));
+			neighbours.emplace_back(new char[BENCH_NEIGHBOUR_SIZE]);
+		}
+	});
+	TransformComponent::GetPool().setBypassed(false);
+
+	Vector<Ref<Component>> pooledTransforms;
+	Benchmark("Create 100k TransformComponents in the pool", 1, [&]() {
+		pooledTransforms.clear();
+		for (int i = 0; i < BENCH_TRANSFORM_COUNT; i++)
+		{
+			pooledTransforms.push_back(EntityFactory::GetSingleton()->createDefaultComponent("TransformComponent"));
+		}
+	});
+
+	// Registration order drifts away from allocation order as entities come and go in a running game
+	std::mt19937 random(0);
+	std::shuffle(heapTransforms.begin(), heapTransforms.end(), random);
+
+	const Vector3 offset(1.0f, 0.0f, 0.0f);
+	Benchmark("Update heap components through pointers", 50, [&]() {
+		for (auto& component : heapTransforms)
+		{
+			TransformComponent* transform = (TransformComponent*)component.get();
+			transform->setPosition(transform->getPosition() + offset);
+		}
+	});
+
+	Benchmark("Update pooled components through the pool", 50, [&]() {
+		TransformComponent::GetPool().forEach([&](TransformComponent* transform) {
+			transform->setPosition(transform->getPosition() + offset);
+		});
+	});
+
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include "test.h"
+
+#include "core/renderer/frustum.h"
+
+#include <cmath>
+
+/// Frustum of a camera at the origin looking down +z with a 90 degree field of view, from z = 1 to z = 100.
+static Frustum MakeFrustum()
+{
+	DirectX::XMMATRIX view = DirectX::XMMatrixLookAtLH(DirectX::XMVectorZero(), DirectX::XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	DirectX::XMMATRIX projection = DirectX::XMMatrixPerspectiveFovLH(DirectX::XM_PIDIV2, 1.0f, 1.0f, 100.0f);
+	DirectX::XMFLOAT4X4 viewProjection;
+	DirectX::XMStoreFloat4x4(&viewProjection, DirectX::XMMatrixMultiply(view, projection));
+	return Frustum(viewProjection);
+}
+
+static bool IsNear(float a, float b)
+{
+	return std::fabs(a - b) < 1e-4f * std::fmax(1.0f, std::fabs(b));
+}
+
+static bool IsPlane(const DirectX::XMFLOAT4& plane, float a, float b, float c, float d)
+{
+	return IsNear(plane.x, a) && IsNear(plane.y, b) && IsNear(plane.z, c) && IsNear(plane.w, d);
+}
+
+static void TestPlaneExtraction()
+{
+	Frustum frustum = MakeFrustum();
+	const float diagonal = 1.0f / std::sqrt(2.0f);
+	CHECK(IsPlane(frustum.getPlane(0), diagonal, 0.0f, diagonal, 0.0f));
+	CHECK(IsPlane(frustum.getPlane(1), -diagonal, 0.0f, diagonal, 0.0f));
+	CHECK(IsPlane(frustum.getPlane(2), 0.0f, diagonal, diagonal, 0.0f));
+	CHECK(IsPlane(frustum.getPlane(3), 0.0f, -diagonal, diagonal, 0.0f));
+	CHECK(IsPlane(frustum.getPlane(4), 0.0f, 0.0f, 1.0f, -1.0f));
+	CHECK(IsPlane(frustum.getPlane(5), 0.0f, 0.0f, -1.0f, 100.0f));
+}
+
+static void TestBoxes()
+{
+	Frustum frustum = MakeFrustum();
+	const DirectX::XMFLOAT3 unit(1.0f, 1.0f, 1.0f);
+	CHECK(frustum.intersects(DirectX::BoundingBox({ 0.0f, 0.0f, 50.0f }, unit)));
+	CHECK(!frustum.intersects(DirectX::BoundingBox({ 0.0f, 0.0f, -10.0f }, unit)));
+	CHECK(!frustum.intersects(DirectX::BoundingBox({ 0.0f, 0.0f, 150.0f }, unit)));
+	CHECK(!frustum.intersects(DirectX::BoundingBox({ -100.0f, 0.0f, 50.0f }, unit)));
+	CHECK(!frustum.intersects(DirectX::BoundingBox({ 0.0f, 100.0f, 50.0f }, unit)));
+	// Boxes straddling the near plane and a side plane are kept
+	CHECK(frustum.intersects(DirectX::BoundingBox({ 0.0f, 0.0f, 0.5f }, unit)));
+	CHECK(frustum.intersects(DirectX::BoundingBox({ -51.0f, 0.0f, 50.0f }, { 1.5f, 1.5f, 1.5f })));
+	CHECK(frustum.intersects(DirectX::BoundingBox({ 0.0f, 0.0f, 99.5f }, unit)));
+}
+
+static void TestSpheres()
+{
+	Frustum frustum = MakeFrustum();
+	CHECK(frustum.intersects(DirectX::BoundingSphere({ 0.0f, 0.0f, 50.0f }, 1.0f)));
+	CHECK(frustum.intersects(DirectX::BoundingSphere({ 0.0f, 0.0f, 0.5f }, 1.0f)));
+	CHECK(!frustum.intersects(DirectX::BoundingSphere({ 0.0f, 0.0f, -1.0f }, 1.5f)));
+	CHECK(!frustum.intersects(DirectX::BoundingSphere({ 0.0f, 0.0f, 102.0f }, 1.5f)));
+	// The center is 1 / sqrt(2) behind the left plane
+	CHECK(frustum.intersects(DirectX::BoundingSphere({ -51.0f, 0.0f, 50.0f }, 1.0f)));
+	CHECK(!frustum.intersects(DirectX::BoundingSphere({ -51.0f, 0.0f, 50.0f }, 0.5f)));
+}
+
+static void TestBatchedCull()
+{
+	Frustum frustum = MakeFrustum();
+
+	// 4 boxes go through the batched path and the rest through the scalar one
+	std::vector<DirectX::BoundingBox> bounds;
+	for (int i = 0; i < 11; i++)
+	{
+		float offset = i * 15.0f - 60.0f;
+		bounds.push_back(DirectX::BoundingBox({ offset, 0.0f, 40.0f + offset }, { 2.0f, 2.0f, 2.0f }));
+	}
+
+	std::vector<char> isInside;
+	frustum.cull(bounds, isInside);
+	CHECK(isInside.size() == bounds.size());
+	int inside = 0;
+	for (size_t i = 0; i < bounds.size(); i++)
+	{
+		CHECK((isInside[i] != 0) == frustum.intersects(bounds[i]));
+		inside += isInside[i];
+	}
+	CHECK(inside > 0 && inside < (int)bounds.size());
+}
+
+static void TestTransformBounds()
+{
+	DirectX::XMFLOAT4X4 transform;
+	DirectX::XMStoreFloat4x4(&transform, DirectX::XMMatrixMultiply(DirectX::XMMatrixScaling(2.0f, 2.0f, 2.0f), DirectX::XMMatrixTranslation(5.0f, 0.0f, 0.0f)));
+	DirectX::BoundingBox bounds = Frustum::TransformBounds(DirectX::BoundingBox({ 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }), transform);
+	CHECK(IsNear(bounds.Center.x, 5.0f) && IsNear(bounds.Center.y, 0.0f) && IsNear(bounds.Center.z, 0.0f));
+	CHECK(IsNear(bounds.Extents.x, 2.0f) && IsNear(bounds.Extents.y, 2.0f) && IsNear(bounds.Extents.z, 2.0f));
+}
+
+int main()
+{
+	TestPlaneExtraction();
+	TestBoxes();
+	TestSpheres();
+	TestBatchedCull();
+	TestTransformBounds();
+	return TestResult();
+}
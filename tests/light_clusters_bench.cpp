@@ -0,0 +1,39 @@
+#include "bench.h"
+
+#include "core/renderer/light_clusters.h"
+
+#include <random>
+
+/// Lights scattered in front of a camera with a 90 degree field of view, from 0.1 to 100 units away.
+static std::vector<ClusteredLight> MakeLights(int count, float radius, unsigned int seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> side(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> depth(0.1f, 100.0f);
+	std::vector<ClusteredLight> lights;
+	for (int i = 0; i < count; i++)
+	{
+		lights.push_back({ { side(random), side(random), -depth(random) }, radius, (unsigned int)i });
+	}
+	return lights;
+}
+
+int main()
+{
+	LightClusters clusters;
+	DirectX::XMFLOAT4X4 projection;
+	DirectX::XMStoreFloat4x4(&projection, DirectX::XMMatrixPerspectiveFovRH(DirectX::XM_PIDIV2, 16.0f / 9.0f, 0.1f, 100.0f));
+	clusters.setProjection(projection, 0.1f, 100.0f);
+
+	for (int count : { 100, 1000, 10000 })
+	{
+		std::vector<ClusteredLight> pointLights = MakeLights(count, 5.0f, 0);
+		std::vector<ClusteredLight> spotLights = MakeLights(count / 4, 10.0f, 1);
+		Benchmark("Bin " + std::to_string(count) + " point and " + std::to_string(count / 4) + " spot lights", 20, [&]() {
+			clusters.bin(pointLights, spotLights);
+		});
+		std::cout << "  Light indices: " << clusters.getLightIndices().size() << "\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include "test.h"
+
+#include "core/lz4_block.h"
+
+#include <random>
+#include <vector>
+
+static std::vector<char> RandomBytes(size_t size, unsigned int seed)
+{
+	// Bytes are never 0, so they never continue a run of zeros
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> byte(1, 255);
+	std::vector<char> bytes(size);
+	for (auto& b : bytes)
+	{
+		b = (char)byte(random);
+	}
+	return bytes;
+}
+
+/// Compress and decompress source, returning whether the result is identical. compressed receives the compressed form.
+static bool IsRoundTrip(const std::vector<char>& source, std::vector<char>& compressed)
+{
+	compressed.clear();
+	LZ4Block::Compress(source.data(), source.size(), compressed);
+	std::vector<char> decompressed(source.size());
+	return LZ4Block::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()) && decompressed == source;
+}
+
+static bool IsRoundTrip(const std::vector<char>& source)
+{
+	std::vector<char> compressed;
+	return IsRoundTrip(source, compressed);
+}
+
+static void TestEmpty()
+{
+	std::vector<char> compressed;
+	CHECK(IsRoundTrip({}, compressed));
+	CHECK(compressed.size() == 1);
+}
+
+static void TestShortInputs()
+{
+	// Inputs up to 12 bytes are too short to hold a match and are stored as a single literal run
+	for (size_t size = 1; size <= 13; size++)
+	{
+		std::vector<char> compressed;
+		CHECK(IsRoundTrip(std::vector<char>(size, 'a'), compressed));
+		CHECK(IsRoundTrip(RandomBytes(size, (unsigned int)size)));
+		if (size <= 12)
+		{
+			CHECK(compressed.size() == size + 1);
+		}
+	}
+}
+
+static void TestLongLiterals()
+{
+	// Lengths of 15, 15 + 255 and longer need extra length bytes
+	for (size_t size : { 14, 15, 16, 269, 270, 271, 1000, 100000 })
+	{
+		std::vector<char> compressed;
+		CHECK(IsRoundTrip(RandomBytes(size, (unsigned int)size), compressed));
+		CHECK(compressed.size() > size);
+	}
+}
+
+static void TestOverlappingMatches()
+{
+	// A run of one byte is a match at offset 1 that overlaps the bytes it produces
+	std::vector<char> compressed;
+	std::vector<char> run(100000, 'x');
+	CHECK(IsRoundTrip(run, compressed));
+	CHECK(compressed.size() < 1000);
+
+	// Repeating patterns shorter than the minimum match also overlap
+	std::vector<char> pattern;
+	for (int i = 0; i < 10000; i++)
+	{
+		pattern.push_back("abc"[i % 3]);
+	}
+	CHECK(IsRoundTrip(pattern, compressed));
+	CHECK(compressed.size() < 200);
+
+	// Matches at the very end of a block have to leave the last bytes as literals
+	std::vector<char> tail = RandomBytes(100, 1);
+	tail.insert(tail.end(), tail.begin(), tail.end());
+	CHECK(IsRoundTrip(tail, compressed));
+	CHECK(compressed.size() < 150);
+}
+
+static void TestFarOffsets()
+{
+	// A random chunk repeated 65535 bytes later is the farthest match the format can encode, 65536 bytes is too far
+	const size_t chunkSize = 1000;
+	std::vector<char> chunk = RandomBytes(chunkSize, 2);
+	for (size_t distance : { 65535, 65536 })
+	{
+		std::vector<char> source(distance + chunkSize, 0);
+		std::copy(chunk.begin(), chunk.end(), source.begin());
+		std::copy(chunk.begin(), chunk.end(), source.begin() + distance);
+
+		std::vector<char> compressed;
+		CHECK(IsRoundTrip(source, compressed));
+		if (distance == 65535)
+		{
+			CHECK(compressed.size() < chunkSize + 400);
+		}
+		else
+		{
+			CHECK(compressed.size() > 2 * chunkSize);
+		}
+	}
+}
+
+static bool IsRejected(const std::vector<unsigned char>& compressed, size_t size)
+{
+	std::vector<char> destination(size);
+	return !LZ4Block::Decompress((const char*)compressed.data(), compressed.size(), destination.data(), size);
+}
+
+static void TestCorruptInput()
+{
+	std::vector<char> source = RandomBytes(1000, 3);
+	source.insert(source.end(), source.begin(), source.end());
+	std::vector<char> compressed;
+	LZ4Block::Compress(source.data(), source.size(), compressed);
+
+	std::vector<unsigned char> bytes(compressed.begin(), compressed.end());
+	// Cut anywhere, the data is too short
+	for (size_t cut : { (size_t)1, (size_t)10, bytes.size() / 2, bytes.size() - 1 })
+	{
+		CHECK(IsRejected(std::vector<unsigned char>(bytes.begin(), bytes.end() - cut), source.size()));
+	}
+	// The data decompresses to more or less than the expected size
+	CHECK(IsRejected(bytes, source.size() - 1));
+	CHECK(IsRejected(bytes, source.size() + 1));
+
+	// 1 literal followed by a match at offset 0, and at an offset before the start of the output
+	CHECK(IsRejected({ 0x10, 'a', 0x00, 0x00, 0x00 }, 5));
+	CHECK(IsRejected({ 0x10, 'a', 0x02, 0x00, 0x00 }, 5));
+	// Literal length past the end of the input, and a length continuation that never ends
+	CHECK(IsRejected({ 0x50, 'a', 'b' }, 5));
+	CHECK(IsRejected({ 0xF0, 0xFF, 0xFF }, 1000));
+	// An offset cut in half
+	CHECK(IsRejected({ 0x10, 'a', 0x01 }, 5));
+}
+
+int main()
+{
+	TestEmpty();
+	TestShortInputs();
+	TestLongLiterals();
+	TestOverlappingMatches();
+	TestFarOffsets();
+	TestCorruptInput();
+	return TestResult();
+}
@@ -0,0 +1,213 @@
+#include "test.h"
+
+#include "core/pak_archive.h"
+
+#include <cstring>
+#include <map>
+#include <random>
+#include <sstream>
+
+/// Archive bytes copied to 8 byte aligned memory, as a mapping would be.
+struct ArchiveBuffer
+{
+	std::vector<uint64_t> m_Words;
+	size_t m_Size = 0;
+
+	explicit ArchiveBuffer(const std::string& bytes)
+	    : m_Words((bytes.size() + 7) / 8)
+	    , m_Size(bytes.size())
+	{
+		memcpy(m_Words.data(), bytes.data(), bytes.size());
+	}
+
+	char* getData() { return (char*)m_Words.data(); }
+};
+
+static std::vector<char> Text(const std::string& text)
+{
+	return std::vector<char>(text.begin(), text.end());
+}
+
+/// Write the files added to writer, reading their contents from files by source path.
+static bool Write(const PakWriter& writer, const std::map<std::string, std::vector<char>>& files, std::string& archive)
+{
+	std::ostringstream stream;
+	bool isWritten = writer.write(stream, [&files](const std::string& sourcePath, std::vector<char>& contents) {
+		auto findIt = files.find(sourcePath);
+		if (findIt == files.end())
+		{
+			return false;
+		}
+		contents = findIt->second;
+		return true;
+	});
+	archive = stream.str();
+	return isWritten;
+}
+
+static bool IsContents(const PakArchive& archive, const std::string& path, const std::vector<char>& expected)
+{
+	const PakEntry* entry = archive.find(path);
+	std::vector<char> contents;
+	return entry && archive.read(*entry, contents) && contents == expected;
+}
+
+static void TestRoundTrip()
+{
+	std::vector<char> repetitive;
+	for (int i = 0; i < 10000; i++)
+	{
+		repetitive.push_back("rootex"[i % 6]);
+	}
+	std::vector<char> random(1000);
+	std::mt19937 generator(0);
+	for (auto& byte : random)
+	{
+		byte = (char)generator();
+	}
+	std::map<std::string, std::vector<char>> files = {
+		{ "disk/repetitive.txt", repetitive },
+		{ "disk/random.bin", random },
+		{ "disk/empty.txt", {} },
+		{ "disk/old.lua", Text("return 1") },
+		{ "disk/new.lua", Text("return 2") },
+		{ "disk/nested.txt", Text("nested") },
+	};
+
+	PakWriter writer;
+	writer.add("game/repetitive.txt", "disk/repetitive.txt", true);
+	writer.add("game/random.bin", "disk/random.bin", true);
+	writer.add("game/empty.txt", "disk/empty.txt", true);
+	writer.add("game/script.lua", "disk/old.lua", false);
+	writer.add("game/nested/file.txt", "disk/nested.txt", false);
+	// Adding a path again replaces the earlier file
+	writer.add("game/script.lua", "disk/new.lua", false);
+	CHECK(writer.getFileCount() == 6);
+
+	std::string bytes;
+	CHECK(Write(writer, files, bytes));
+	ArchiveBuffer buffer(bytes);
+	PakArchive archive;
+	CHECK(archive.open(buffer.getData(), buffer.m_Size));
+	CHECK(archive.getEntryCount() == 5);
+	CHECK(archive.getMappedFile() == nullptr);
+
+	CHECK(IsContents(archive, "game/repetitive.txt", repetitive));
+	CHECK(IsContents(archive, "game/random.bin", random));
+	CHECK(IsContents(archive, "game/empty.txt", {}));
+	CHECK(IsContents(archive, "game/script.lua", Text("return 2")));
+	CHECK(IsContents(archive, "game/nested/file.txt", Text("nested")));
+	CHECK(archive.find("game/missing.txt") == nullptr);
+	CHECK(archive.find("Game/script.lua") == nullptr);
+
+	// Only files that get smaller are compressed, and contents start at aligned offsets
+	const PakEntry* compressed = archive.find("game/repetitive.txt");
+	const PakEntry* stored = archive.find("game/random.bin");
+	CHECK(compressed && compressed->m_Compression == PakCompression::LZ4 && compressed->m_StoredSize < compressed->m_Size);
+	CHECK(stored && stored->m_Compression == PakCompression::None && stored->m_StoredSize == random.size());
+	CHECK(stored && memcmp(archive.getData(*stored), random.data(), random.size()) == 0);
+	for (const char* path : { "game/repetitive.txt", "game/random.bin", "game/script.lua" })
+	{
+		const PakEntry* entry = archive.find(path);
+		CHECK(entry && entry->m_Offset % PAK_ALIGNMENT == 0 && archive.getPath(*entry) == path);
+	}
+
+	std::vector<std::string> listed = archive.getFilesInDirectory("game");
+	CHECK(listed.size() == 4);
+	CHECK(archive.getFilesInDirectory("game/nested/") == std::vector<std::string> { "game/nested/file.txt" });
+}
+
+static void TestMissingSource()
+{
+	PakWriter writer;
+	writer.add("game/missing.txt", "disk/missing.txt", true);
+	std::string bytes;
+	CHECK(!Write(writer, {}, bytes));
+}
+
+static void TestCorruptArchives()
+{
+	std::vector<char> repetitive(5000, 'r');
+	PakWriter writer;
+	writer.add("game/file.txt", "disk/file.txt", true);
+	std::string bytes;
+	CHECK(Write(writer, { { "disk/file.txt", repetitive } }, bytes));
+
+	PakArchive archive;
+	{
+		ArchiveBuffer buffer(bytes);
+		CHECK(archive.open(buffer.getData(), buffer.m_Size));
+		// Too short for the header or the table
+		CHECK(!archive.open(buffer.getData(), sizeof(PakHeader) - 1));
+		CHECK(!archive.open(buffer.getData(), sizeof(PakHeader) + sizeof(PakEntry) - 1));
+		// Contents past the end of the archive
+		CHECK(!archive.open(buffer.getData(), buffer.m_Size - 1));
+	}
+	{
+		ArchiveBuffer buffer(bytes);
+		((PakHeader*)buffer.getData())->m_Magic++;
+		CHECK(!archive.open(buffer.getData(), buffer.m_Size));
+	}
+	{
+		ArchiveBuffer buffer(bytes);
+		((PakHeader*)buffer.getData())->m_Version++;
+		CHECK(!archive.open(buffer.getData(), buffer.m_Size));
+	}
+	{
+		ArchiveBuffer buffer(bytes);
+		((PakEntry*)(buffer.getData() + sizeof(PakHeader)))->m_Compression = (PakCompression)7;
+		CHECK(!archive.open(buffer.getData(), buffer.m_Size));
+	}
+	{
+		// A compressed file whose stored size was cut opens, but cannot be read
+		ArchiveBuffer buffer(bytes);
+		((PakEntry*)(buffer.getData() + sizeof(PakHeader)))->m_StoredSize -= 2;
+		CHECK(archive.open(buffer.getData(), buffer.m_Size));
+		const PakEntry* entry = archive.find("game/file.txt");
+		std::vector<char> contents;
+		CHECK(entry && !archive.read(*entry, contents) && contents.empty());
+	}
+}
+
+static void TestHashCollision()
+{
+	// Two paths sharing a hash, laid out by hand since real 64 bit collisions are hard to come by.
+	// The entry for "a" is stored under the hash of "b" and sorts before it, so looking up "b" has to step over it.
+	const std::string paths = "ab";
+	const std::string contents[] = { "first", "second" };
+	std::string bytes(sizeof(PakHeader) + 2 * sizeof(PakEntry), '\0');
+	PakHeader header = { PAK_MAGIC, PAK_VERSION, 2, 0 };
+	memcpy(&bytes[0], &header, sizeof(header));
+	size_t pathOffset = bytes.size();
+	bytes += paths;
+	for (int i = 0; i < 2; i++)
+	{
+		PakEntry entry = {};
+		entry.m_Hash = PakArchive::HashPath("b");
+		entry.m_PathOffset = pathOffset + i;
+		entry.m_PathLength = 1;
+		entry.m_Offset = bytes.size();
+		entry.m_StoredSize = contents[i].size();
+		entry.m_Size = contents[i].size();
+		entry.m_Compression = PakCompression::None;
+		memcpy(&bytes[sizeof(PakHeader) + i * sizeof(PakEntry)], &entry, sizeof(entry));
+		bytes += contents[i];
+	}
+
+	ArchiveBuffer buffer(bytes);
+	PakArchive archive;
+	CHECK(archive.open(buffer.getData(), buffer.m_Size));
+	CHECK(IsContents(archive, "b", Text("second")));
+	// "a" hashes elsewhere, so its misplaced entry is never found
+	CHECK(archive.find("a") == nullptr);
+	CHECK(archive.find("c") == nullptr);
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestMissingSource();
+	TestCorruptArchives();
+	TestHashCollision();
+	return TestResult();
+}
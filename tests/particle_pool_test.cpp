@@ -0,0 +1,130 @@
+#include "test.h"
+
+#include "framework/components/visual/particle_pool.h"
+
+#include <cmath>
+
+static bool IsNear(float a, float b)
+{
+	return std::fabs(a - b) < 1e-4f * std::fmax(1.0f, std::fabs(b));
+}
+
+/// Place a particle at x along the x axis, moving with velocity along x, with life seconds left out of lifeTime.
+static void SetParticle(ParticlePool& pool, size_t i, float x, float velocity, float life, float lifeTime)
+{
+	pool.m_PositionX[i] = x;
+	pool.m_VelocityX[i] = velocity;
+	pool.m_LifeRemaining[i] = life;
+	pool.m_LifeTime[i] = lifeTime;
+	pool.m_SizeBegin[i] = 1.0f;
+	pool.m_SizeEnd[i] = 0.0f;
+	pool.m_ColorBegin[i] = { 1.0f, 0.0f, 0.0f, 1.0f };
+	pool.m_ColorEnd[i] = { 0.0f, 0.0f, 1.0f, 0.0f };
+}
+
+static void TestResize()
+{
+	ParticlePool pool;
+	pool.resize(5);
+	CHECK(pool.m_Capacity == 5);
+	CHECK(pool.m_PositionX.size() == 8);
+	CHECK(pool.m_ColorBegin.size() == 5);
+
+	pool.m_LiveCount = 5;
+	pool.resize(3);
+	CHECK(pool.m_LiveCount == 3);
+}
+
+static void TestIntegrate()
+{
+	ParticlePool pool;
+	pool.resize(7);
+	for (size_t i = 0; i < 7; i++)
+	{
+		SetParticle(pool, i, (float)i, 2.0f, 1.0f, 1.0f);
+		pool.m_YawVelocity[i] = 1.0f;
+	}
+	pool.m_LiveCount = 7;
+
+	// Two ranges, the second one ending in the middle of a group of 4
+	pool.integrate(0, 4, 0.25f);
+	pool.integrate(4, 7, 0.25f);
+	for (size_t i = 0; i < 7; i++)
+	{
+		CHECK(IsNear(pool.m_PositionX[i], i + 0.5f));
+		CHECK(IsNear(pool.m_Yaw[i], 0.25f));
+		CHECK(IsNear(pool.m_LifeRemaining[i], 0.75f));
+		CHECK(pool.m_PositionY[i] == 0.0f);
+	}
+}
+
+static void TestCompact()
+{
+	ParticlePool pool;
+	pool.resize(6);
+	// Particles 0, 2 and 5 are dead, 5 being the last live slot that would be moved into the others
+	const float lives[] = { 0.0f, 1.0f, -0.5f, 1.0f, 1.0f, 0.0f };
+	for (size_t i = 0; i < 6; i++)
+	{
+		SetParticle(pool, i, (float)i, 0.0f, lives[i], 1.0f);
+	}
+	pool.m_LiveCount = 6;
+
+	pool.compact();
+	CHECK(pool.m_LiveCount == 3);
+	float positionSum = 0.0f;
+	for (size_t i = 0; i < pool.m_LiveCount; i++)
+	{
+		CHECK(pool.m_LifeRemaining[i] > 0.0f);
+		positionSum += pool.m_PositionX[i];
+	}
+	CHECK(positionSum == 1.0f + 3.0f + 4.0f);
+
+	pool.m_LifeRemaining[0] = 0.0f;
+	pool.m_LifeRemaining[1] = 0.0f;
+	pool.m_LifeRemaining[2] = 0.0f;
+	pool.compact();
+	CHECK(pool.m_LiveCount == 0);
+}
+
+static void TestPack()
+{
+	ParticlePool pool;
+	pool.resize(3);
+	SetParticle(pool, 0, 1.0f, 0.0f, 1.0f, 1.0f);
+	SetParticle(pool, 1, 2.0f, 0.0f, 0.5f, 1.0f);
+	pool.m_PositionY[1] = 3.0f;
+	pool.m_PositionZ[1] = 4.0f;
+	SetParticle(pool, 2, 0.0f, 0.0f, 0.25f, 1.0f);
+	pool.m_Yaw[2] = DirectX::XM_PIDIV2;
+	pool.m_LiveCount = 3;
+
+	std::vector<ParticleInstanceData> instances(3);
+	pool.pack(instances, 1, 3);
+
+	// Only the requested range is written
+	CHECK(instances[0].m_TransformRows[0].w == 0.0f);
+
+	// Halfway through its life the particle is half sized, halfway between both colors, and translated by its position
+	const ParticleInstanceData& half = instances[1];
+	CHECK(IsNear(half.m_TransformRows[0].x, 0.5f) && IsNear(half.m_TransformRows[1].y, 0.5f) && IsNear(half.m_TransformRows[2].z, 0.5f));
+	CHECK(IsNear(half.m_TransformRows[0].y, 0.0f) && IsNear(half.m_TransformRows[1].x, 0.0f));
+	CHECK(IsNear(half.m_TransformRows[0].w, 2.0f) && IsNear(half.m_TransformRows[1].w, 3.0f) && IsNear(half.m_TransformRows[2].w, 4.0f));
+	CHECK(IsNear(half.m_Color.x, 0.5f) && IsNear(half.m_Color.y, 0.0f) && IsNear(half.m_Color.z, 0.5f) && IsNear(half.m_Color.w, 0.5f));
+
+	// A quarter turn of yaw maps x to -z and z to x, scaled by the remaining size
+	const ParticleInstanceData& turned = instances[2];
+	CHECK(IsNear(turned.m_TransformRows[0].x, 0.0f) && IsNear(turned.m_TransformRows[0].z, -0.25f));
+	CHECK(IsNear(turned.m_TransformRows[2].x, 0.25f) && IsNear(turned.m_TransformRows[2].z, 0.0f));
+	CHECK(IsNear(turned.m_TransformRows[1].y, 0.25f));
+	CHECK(IsNear(turned.m_Color.x, 0.25f) && IsNear(turned.m_Color.z, 0.75f));
+}
+
+int main()
+{
+	TestResize();
+	TestIntegrate();
+	TestCompact();
+	TestPack();
+	return TestResult();
+}
@@ -0,0 +1,100 @@
+#include "test.h"
+
+#include "core/ui/rectangle_packer.h"
+
+#include <random>
+#include <vector>
+
+struct Rectangle
+{
+	int m_X;
+	int m_Y;
+	int m_Width;
+	int m_Height;
+};
+
+static bool Overlaps(const Rectangle& a, const Rectangle& b)
+{
+	return a.m_X < b.m_X + b.m_Width && b.m_X < a.m_X + a.m_Width && a.m_Y < b.m_Y + b.m_Height && b.m_Y < a.m_Y + a.m_Height;
+}
+
+static void TestExactFit()
+{
+	RectanglePacker packer(100, 100);
+	int x;
+	int y;
+	for (int i = 0; i < 4; i++)
+	{
+		CHECK(packer.insert(50, 50, x, y));
+	}
+	CHECK(packer.getOccupancy() == 1.0f);
+	CHECK(!packer.insert(1, 1, x, y));
+
+	packer.clear();
+	CHECK(packer.getOccupancy() == 0.0f);
+	CHECK(packer.insert(100, 100, x, y));
+	CHECK(x == 0 && y == 0);
+}
+
+static void TestRejects()
+{
+	RectanglePacker packer(64, 64);
+	int x;
+	int y;
+	CHECK(!packer.insert(0, 10, x, y));
+	CHECK(!packer.insert(10, -1, x, y));
+	CHECK(!packer.insert(65, 1, x, y));
+	CHECK(!packer.insert(1, 65, x, y));
+	CHECK(packer.getOccupancy() == 0.0f);
+}
+
+static void TestBottomLeft()
+{
+	// A short rectangle goes next to a tall one instead of on top of it
+	RectanglePacker packer(100, 100);
+	int x;
+	int y;
+	CHECK(packer.insert(40, 80, x, y));
+	CHECK(x == 0 && y == 0);
+	CHECK(packer.insert(40, 20, x, y));
+	CHECK(x == 40 && y == 0);
+	CHECK(packer.insert(40, 20, x, y));
+	CHECK(x == 40 && y == 20);
+}
+
+static void TestRandomNoOverlaps()
+{
+	std::mt19937 random(0);
+	std::uniform_int_distribution<int> size(1, 64);
+	RectanglePacker packer(512, 512);
+	std::vector<Rectangle> placed;
+	int area = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		Rectangle rectangle = { 0, 0, size(random), size(random) };
+		if (!packer.insert(rectangle.m_Width, rectangle.m_Height, rectangle.m_X, rectangle.m_Y))
+		{
+			continue;
+		}
+		CHECK(rectangle.m_X >= 0 && rectangle.m_Y >= 0);
+		CHECK(rectangle.m_X + rectangle.m_Width <= 512 && rectangle.m_Y + rectangle.m_Height <= 512);
+		for (auto& other : placed)
+		{
+			CHECK(!Overlaps(rectangle, other));
+		}
+		placed.push_back(rectangle);
+		area += rectangle.m_Width * rectangle.m_Height;
+	}
+	CHECK(packer.getOccupancy() == (float)area / (512 * 512));
+	// Small rectangles should fill most of the area before the packer runs out of room
+	CHECK(packer.getOccupancy() > 0.7f);
+}
+
+int main()
+{
+	TestExactFit();
+	TestRejects();
+	TestBottomLeft();
+	TestRandomNoOverlaps();
+	return TestResult();
+}
@@ -0,0 +1,87 @@
+#include "test.h"
+
+#include "core/renderer/ring_allocator.h"
+
+static void TestAlignment()
+{
+	RingAllocator ring(1000, 256);
+	CHECK(ring.getCapacity() == 1024);
+	CHECK(ring.allocate(1) == 0);
+	CHECK(ring.allocate(256) == 256);
+	CHECK(ring.allocate(257) == 512);
+	CHECK(ring.getFrameBytes() == 1024);
+}
+
+static void TestWrapAtFrameStart()
+{
+	RingAllocator ring(4096, 256);
+
+	// An empty ring never wraps
+	CHECK(!ring.beginFrame());
+	CHECK(ring.allocate(1024) == 0);
+
+	// The next frame is predicted to need 1024 bytes, which still fit after the head
+	CHECK(!ring.beginFrame());
+	CHECK(ring.getLastFrameBytes() == 1024);
+	CHECK(ring.allocate(1024) == 1024);
+	CHECK(!ring.beginFrame());
+	CHECK(ring.allocate(1024) == 2048);
+	CHECK(!ring.beginFrame());
+	CHECK(ring.allocate(1024) == 3072);
+
+	// Another 1024 bytes would not fit after 4096, so the frame starts over at the beginning
+	CHECK(ring.beginFrame());
+	CHECK(ring.getFrameBytes() == 0);
+	CHECK(ring.allocate(1024) == 0);
+}
+
+static void TestNoWrapMidFrame()
+{
+	RingAllocator ring(1024, 256);
+	CHECK(ring.allocate(512) == 0);
+	CHECK(!ring.beginFrame());
+	CHECK(ring.allocate(256) == 512);
+	CHECK(ring.allocate(256) == 768);
+
+	// The start of the ring is free, but it belongs to an earlier frame that may still be in use
+	CHECK(ring.allocate(256) == RingAllocator::InvalidOffset);
+}
+
+static void TestOverflowAccounting()
+{
+	RingAllocator ring(1024, 256);
+	CHECK(ring.allocate(1024) == 0);
+	CHECK(ring.allocate(1) == RingAllocator::InvalidOffset);
+	CHECK(ring.allocate(300) == RingAllocator::InvalidOffset);
+	CHECK(ring.getOverflowBytes() == 768);
+	CHECK(ring.getFrameBytes() == 1024);
+
+	// Overflowed bytes count towards the prediction of the next frame, and are reset with it
+	CHECK(ring.beginFrame());
+	CHECK(ring.getLastFrameBytes() == 1792);
+	CHECK(ring.getOverflowBytes() == 0);
+}
+
+static void TestResize()
+{
+	RingAllocator ring(1024, 256);
+	CHECK(ring.allocate(1024) == 0);
+	CHECK(ring.allocate(256) == RingAllocator::InvalidOffset);
+
+	ring.resize(2000);
+	CHECK(ring.getCapacity() == 2048);
+	CHECK(ring.getOverflowBytes() == 0);
+	CHECK(ring.getFrameBytes() == 0);
+	CHECK(ring.allocate(2048) == 0);
+	CHECK(ring.allocate(1) == RingAllocator::InvalidOffset);
+}
+
+int main()
+{
+	TestAlignment();
+	TestWrapAtFrameStart();
+	TestNoWrapMidFrame();
+	TestOverflowAccounting();
+	TestResize();
+	return TestResult();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+
+/// Number of failed checks in the running test executable.
+inline int& FailedChecks()
+{
+	static int failedChecks = 0;
+	return failedChecks;
+}
+
+/// Report a failure and carry on if the condition does not hold.
+#define CHECK(m_Condition)                                                                 \
+	if (!(m_Condition))                                                                    \
+	{                                                                                      \
+		std::cerr << __FILE__ << ":" << __LINE__ << ": Check failed: " #m_Condition "\n"; \
+		FailedChecks()++;                                                                  \
+	}
+
+/// Exit code of a test executable.
+inline int TestResult()
+{
+	if (FailedChecks() == 0)
+	{
+		std::cout << "All checks passed\n";
+		return 0;
+	}
+	std::cerr << FailedChecks() << " checks failed\n";
+	return 1;
+}
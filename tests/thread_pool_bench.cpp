@@ -0,0 +1,72 @@
+#include "bench.h"
+
+#include "os/thread.h"
+
+#include <cmath>
+#include <vector>
+
+/// Work large enough to not be optimized away and small enough to stress scheduling.
+static float Work(int seed)
+{
+	float value = seed;
+	for (int i = 0; i < 200; i++)
+	{
+		value = std::sqrt(value + i);
+	}
+	return value;
+}
+
+int main()
+{
+	ThreadPool threadPool;
+	std::cout << "Workers: " << threadPool.getThreadCount() << "\n";
+
+	const int jobs = 10000;
+	std::vector<float> results(jobs);
+
+	Benchmark("Serial", 20, [&]() {
+		for (int i = 0; i < jobs; i++)
+		{
+			results[i] = Work(i);
+		}
+	});
+
+	Benchmark("Single submissions", 20, [&]() {
+		std::vector<TaskHandle> handles;
+		handles.reserve(jobs);
+		for (int i = 0; i < jobs; i++)
+		{
+			handles.push_back(threadPool.submit([&results, i]() { results[i] = Work(i); }));
+		}
+		for (auto& handle : handles)
+		{
+			handle.wait();
+		}
+	});
+
+	Benchmark("One graph", 20, [&]() {
+		TaskGraph graph;
+		for (int i = 0; i < jobs; i++)
+		{
+			graph.add([&results, i]() { results[i] = Work(i); });
+		}
+		threadPool.submit(graph).wait();
+	});
+
+	Benchmark("Chained graph", 20, [&]() {
+		// Every 64 jobs wait on the previous 64
+		const int width = 64;
+		TaskGraph graph;
+		for (int i = 0; i < jobs; i++)
+		{
+			graph.add([&results, i]() { results[i] = Work(i); });
+			if (i >= width)
+			{
+				graph.precede(i - width, i);
+			}
+		}
+		threadPool.submit(graph).wait();
+	});
+
+	return 0;
+}
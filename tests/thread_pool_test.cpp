@@ -0,0 +1,193 @@
+#include "test.h"
+
+#include "os/thread.h"
+
+#include <chrono>
+#include <ctime>
+#include <string>
+
+static void TestSingleJobs(ThreadPool& threadPool)
+{
+	std::atomic<int> sum(0);
+	std::vector<TaskHandle> handles;
+	for (int i = 1; i <= 1000; i++)
+	{
+		handles.push_back(threadPool.submit([&sum, i]() { sum += i; }));
+	}
+	for (auto& handle : handles)
+	{
+		handle.wait();
+	}
+	CHECK(sum == 500500);
+	CHECK(threadPool.isCompleted());
+}
+
+static void TestGraphOrder(ThreadPool& threadPool)
+{
+	// A diamond repeated in a chain, each task checks that its predecessors have run
+	std::vector<std::atomic<int>> finished(400);
+	std::atomic<int> violations(0);
+	TaskGraph graph;
+	for (int i = 0; i < 400; i++)
+	{
+		graph.add([&, i]() {
+			if (i > 0 && i % 4 == 0 && (finished[i - 3] == 0 || finished[i - 2] == 0))
+			{
+				violations++;
+			}
+			if (i % 4 != 0 && finished[i - i % 4] == 0)
+			{
+				violations++;
+			}
+			finished[i] = 1;
+		});
+	}
+	for (int i = 0; i < 400; i += 4)
+	{
+		graph.precede(i, i + 1);
+		graph.precede(i, i + 2);
+		graph.precede(i, i + 3);
+		if (i + 4 < 400)
+		{
+			graph.precede({ i + 1, i + 2 }, i + 4);
+		}
+	}
+	threadPool.submit(graph).wait();
+	CHECK(violations == 0);
+	for (auto& flag : finished)
+	{
+		CHECK(flag == 1);
+	}
+}
+
+static void TestNestedSubmission(ThreadPool& threadPool)
+{
+	// Tasks that wait on tasks they submit must not deadlock, waiting threads help out
+	std::atomic<int> leaves(0);
+	std::vector<TaskHandle> handles;
+	for (int i = 0; i < 16; i++)
+	{
+		handles.push_back(threadPool.submit([&]() {
+			std::vector<TaskHandle> children;
+			for (int j = 0; j < 16; j++)
+			{
+				children.push_back(threadPool.submit([&]() { leaves++; }));
+			}
+			for (auto& child : children)
+			{
+				child.wait();
+			}
+		}));
+	}
+	for (auto& handle : handles)
+	{
+		handle.wait();
+	}
+	CHECK(leaves == 256);
+}
+
+static void TestErrors(ThreadPool& threadPool)
+{
+	std::vector<std::string> errors;
+	threadPool.setErrorHandler([&errors](const std::string& error) { errors.push_back(error); });
+
+	TaskGraph cycle;
+	cycle.add([]() {});
+	cycle.add([]() {});
+	cycle.precede(0, 1);
+	cycle.precede(1, 0);
+	CHECK(threadPool.submit(cycle).isReady());
+	CHECK(errors.size() == 1);
+
+	TaskGraph outside;
+	outside.add([]() {});
+	outside.precede(0, 5);
+	CHECK(threadPool.submit(outside).isReady());
+	CHECK(errors.size() == 2);
+
+	// A throwing task still completes its handle
+	threadPool.submit([]() { throw std::runtime_error("Expected"); }).wait();
+	threadPool.join();
+	CHECK(errors.size() == 3);
+	CHECK(threadPool.isCompleted());
+
+	threadPool.setErrorHandler(nullptr);
+}
+
+static void TestBlockingWait(ThreadPool& threadPool)
+{
+	// Waiting on tasks that run elsewhere should sleep, so the process barely uses any processor time meanwhile
+	std::clock_t start = std::clock();
+	TaskHandle handle = threadPool.submit([]() { std::this_thread::sleep_for(std::chrono::milliseconds(200)); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	handle.wait();
+	threadPool.submit([]() { std::this_thread::sleep_for(std::chrono::milliseconds(200)); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	threadPool.join();
+	double seconds = double(std::clock() - start) / CLOCKS_PER_SEC;
+	CHECK(handle.isReady());
+	CHECK(threadPool.isCompleted());
+	CHECK(seconds < 0.2);
+}
+
+static void TestBackgroundTasks(ThreadPool& threadPool)
+{
+	// Background tasks are left to the workers, however long this thread keeps helping
+	const std::thread::id mainThread = std::this_thread::get_id();
+	std::atomic<int> onMainThread(0);
+	std::vector<std::shared_ptr<Task>> tasks;
+	for (int i = 0; i < 100; i++)
+	{
+		tasks.emplace_back(new Task([&]() {
+			if (std::this_thread::get_id() == mainThread)
+			{
+				onMainThread++;
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}));
+		tasks.back()->m_IsBackground = true;
+	}
+	TaskHandle handle = threadPool.submit(tasks);
+	int helped = 0;
+	while (threadPool.help())
+	{
+		helped++;
+	}
+	handle.wait();
+	CHECK(helped == 0);
+	CHECK(onMainThread == 0);
+
+	// Foreground tasks submitted meanwhile are still run by whoever is free
+	std::atomic<int> sum(0);
+	std::vector<std::shared_ptr<Task>> background = { std::shared_ptr<Task>(new Task([]() { std::this_thread::sleep_for(std::chrono::milliseconds(50)); })) };
+	background[0]->m_IsBackground = true;
+	TaskHandle backgroundHandle = threadPool.submit(background);
+	std::vector<TaskHandle> handles;
+	for (int i = 1; i <= 100; i++)
+	{
+		handles.push_back(threadPool.submit([&sum, i]() { sum += i; }));
+	}
+	for (auto& foregroundHandle : handles)
+	{
+		foregroundHandle.wait();
+	}
+	CHECK(sum == 5050);
+	backgroundHandle.wait();
+	CHECK(threadPool.isCompleted());
+}
+
+int main()
+{
+	for (int threads : { 1, 2, 4 })
+	{
+		ThreadPool threadPool(threads);
+		CHECK(threadPool.getThreadCount() == threads);
+		TestSingleJobs(threadPool);
+		TestGraphOrder(threadPool);
+		TestNestedSubmission(threadPool);
+		TestErrors(threadPool);
+		TestBlockingWait(threadPool);
+		TestBackgroundTasks(threadPool);
+	}
+	return TestResult();
+}